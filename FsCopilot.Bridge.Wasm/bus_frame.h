@@ -0,0 +1,275 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+namespace fsc::protocol
+{
+// FIFO of length-prefixed messages in a fixed buffer. Entries are [u16 size][bytes][0], the
+// terminator lets a consumer use the bytes as a C string. Space freed at the front is reclaimed
+// by moving the rest down when the back runs out.
+template <size_t Capacity> class message_queue
+{
+  public:
+    static constexpr size_t k_entry_overhead = sizeof(uint16_t) + 1;
+
+    bool push(const void* data, const size_t size)
+    {
+        if (size > UINT16_MAX || !reserve(k_entry_overhead + size))
+            return false;
+
+        const auto n = static_cast<uint16_t>(size);
+        std::memcpy(buf_ + tail_, &n, sizeof(n));
+        std::memcpy(buf_ + tail_ + sizeof(n), data, size);
+        buf_[tail_ + sizeof(n) + size] = 0;
+        tail_ += k_entry_overhead + size;
+        ++count_;
+        return true;
+    }
+
+    bool empty() const
+    {
+        return head_ == tail_;
+    }
+
+    // messages queued
+    size_t size() const
+    {
+        return count_;
+    }
+
+    // front message, valid until the next push or pop
+    const char* front(size_t& size) const
+    {
+        uint16_t n = 0;
+        std::memcpy(&n, buf_ + head_, sizeof(n));
+        size = n;
+        return reinterpret_cast<const char*>(buf_ + head_ + sizeof(n));
+    }
+
+    void pop()
+    {
+        size_t size = 0;
+        (void)front(size);
+        head_ += k_entry_overhead + size;
+        --count_;
+        if (head_ == tail_)
+            head_ = tail_ = 0;
+    }
+
+  private:
+    uint8_t buf_[Capacity]{};
+    size_t  head_  = 0;
+    size_t  tail_  = 0;
+    size_t  count_ = 0;
+
+    bool reserve(const size_t size)
+    {
+        if (Capacity - tail_ >= size)
+            return true;
+        if (Capacity - (tail_ - head_) < size)
+            return false;
+
+        std::memmove(buf_, buf_ + head_, tail_ - head_);
+        tail_ -= head_;
+        head_ = 0;
+        return true;
+    }
+};
+
+// Comm bus messages carried in bus_frame transfers.
+//
+//   record: u16 size, u8 flags, size bytes
+//
+// Everything queued between two frames goes out in one transfer. A message that does not fit in
+// the room left is split into chunks, bus_first marks the first and bus_last the last, a message
+// that fits whole has both. Frames are numbered, a gap drops the message being reassembled.
+enum bus_flags : uint8_t
+{
+    bus_first = 1,
+    bus_last  = 2
+};
+
+constexpr size_t k_bus_record_header = 3;
+constexpr size_t k_bus_max_message   = 8 * 1024;
+
+class bus_writer
+{
+  public:
+    // false when the queue is full, the message is dropped
+    bool push(const char* msg, const size_t size)
+    {
+        if (size <= k_bus_max_message && queue_.push(msg, size))
+            return true;
+        ++dropped_;
+        return false;
+    }
+
+    bool empty() const
+    {
+        return queue_.empty();
+    }
+
+    // Fills one frame from the queue. Returns nullptr when nothing is queued.
+    const bus_frame* next()
+    {
+        if (queue_.empty())
+            return nullptr;
+
+        size_t used = 0;
+        while (!queue_.empty() && sizeof(frame_.data) - used > k_bus_record_header)
+        {
+            size_t      size = 0;
+            const char* msg  = queue_.front(size);
+
+            const size_t room  = sizeof(frame_.data) - used - k_bus_record_header;
+            const size_t left  = size - sent_;
+            const size_t chunk = left < room ? left : room;
+
+            uint8_t flags = 0;
+            if (sent_ == 0)
+                flags |= bus_first;
+            if (chunk == left)
+                flags |= bus_last;
+
+            const auto n = static_cast<uint16_t>(chunk);
+            std::memcpy(frame_.data + used, &n, sizeof(n));
+            frame_.data[used + sizeof(n)] = flags;
+            std::memcpy(frame_.data + used + k_bus_record_header, msg + sent_, chunk);
+            used += k_bus_record_header + chunk;
+
+            if (chunk == left)
+            {
+                queue_.pop();
+                sent_ = 0;
+            }
+            else
+                sent_ += chunk;
+        }
+
+        frame_.seq  = ++seq_;
+        frame_.size = static_cast<uint16_t>(used);
+        return &frame_;
+    }
+
+    uint32_t dropped() const
+    {
+        return dropped_;
+    }
+
+  private:
+    message_queue<16 * 1024> queue_;
+    bus_frame                frame_{};
+    size_t                   sent_    = 0; // bytes of the front message already in a frame
+    uint32_t                 seq_     = 0;
+    uint32_t                 dropped_ = 0;
+};
+
+// Reassembles messages and keeps them until drain(), so a burst is never overwritten before
+// it is consumed.
+class bus_reader
+{
+  public:
+    struct counters
+    {
+        uint32_t messages;
+        uint32_t lost;    // frame sequence gaps
+        uint32_t dropped; // malformed, too large or no room in the queue
+    };
+
+    void read(const bus_frame& frame)
+    {
+        if (has_seq_ && frame.seq != seq_ + 1)
+        {
+            stats_.lost += frame.seq - seq_ - 1;
+            size_ = 0;
+            open_ = false;
+        }
+        seq_     = frame.seq;
+        has_seq_ = true;
+
+        const size_t end = frame.size < sizeof(frame.data) ? frame.size : sizeof(frame.data);
+        for (size_t pos = 0; pos + k_bus_record_header <= end;)
+        {
+            uint16_t n = 0;
+            std::memcpy(&n, frame.data + pos, sizeof(n));
+            const uint8_t flags = frame.data[pos + sizeof(n)];
+            pos += k_bus_record_header;
+            if (n > end - pos)
+            {
+                ++stats_.dropped;
+                break;
+            }
+
+            if (flags & bus_first)
+            {
+                size_ = 0;
+                open_ = true;
+            }
+            if (open_ && size_ + n <= sizeof(message_))
+            {
+                std::memcpy(message_ + size_, frame.data + pos, n);
+                size_ += n;
+            }
+            else if (open_)
+            {
+                open_ = false;
+                ++stats_.dropped;
+            }
+            pos += n;
+
+            if ((flags & bus_last) && open_)
+            {
+                open_ = false;
+                if (queue_.push(message_, size_))
+                    ++stats_.messages;
+                else
+                    ++stats_.dropped;
+            }
+        }
+    }
+
+    // Calls fn(msg, size) for every complete message in arrival order, msg is NUL terminated.
+    template <typename Fn> void drain(Fn fn)
+    {
+        drain(fn, [] { return true; });
+    }
+
+    // Same, but stops when more() is false after a message. The rest waits for the next drain.
+    template <typename Fn, typename More> void drain(Fn fn, More more)
+    {
+        while (!queue_.empty())
+        {
+            size_t      size = 0;
+            const char* msg  = queue_.front(size);
+            fn(msg, size);
+            queue_.pop();
+            if (!more())
+                break;
+        }
+    }
+
+    // complete messages not drained yet
+    size_t pending() const
+    {
+        return queue_.size();
+    }
+
+    const counters& stats() const
+    {
+        return stats_;
+    }
+
+  private:
+    message_queue<16 * 1024> queue_;
+    char                     message_[k_bus_max_message]{};
+    size_t                   size_    = 0;
+    bool                     open_    = false;
+    bool                     has_seq_ = false;
+    uint32_t                 seq_     = 0;
+    counters                 stats_{};
+};
+} // namespace fsc::protocol
@@ -0,0 +1,159 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <MSFS/Legacy/gauges.h> // execute_calculator_code, gauge_calculator_code_precompile
+
+namespace fsc::calc
+{
+// Read expression compiled once at watch time. L: and A: variables are resolved to their
+// gauge API handles so a read is a plain function call; anything else (B:, Z:, E:, ...)
+// is precompiled by the calculator and executed from the compiled buffer.
+struct compiled_expr
+{
+    enum kind_t : uint8_t
+    {
+        none,
+        lvar,
+        avar,
+        code
+    };
+
+    kind_t      kind  = none;
+    ID          id    = -1; // named variable id (L:) or aircraft var enum (A:)
+    ENUM        units = -1;
+    SINT32      index = 0;
+    std::string bytes; // precompiled calculator code, a C string like the source it came from
+};
+
+inline bool is_empty_cstr(const char* s)
+{
+    return (s == nullptr) || (s[0] == '\0');
+}
+
+inline std::string wrap_expression(const char* name, const char* units)
+{
+    std::string wrapped;
+    wrapped.push_back('(');
+    wrapped.append(name);
+
+    if (!is_empty_cstr(units))
+    {
+        wrapped.append(", ");
+        wrapped.append(units);
+    }
+
+    wrapped.push_back(')');
+    return wrapped;
+}
+
+inline bool compile_lvar(const char* name, const char* units, compiled_expr& out)
+{
+    // only resolve variables that already exist, reading an unknown L: through
+    // the calculator keeps the old "reads as 0 until created" behaviour.
+    const ID id = check_named_variable(name + 2);
+    if (id < 0)
+        return false;
+
+    ENUM u = -1;
+    if (!is_empty_cstr(units))
+    {
+        u = get_units_enum(units);
+        if (u < 0)
+            return false;
+    }
+
+    out.kind  = compiled_expr::lvar;
+    out.id    = id;
+    out.units = u;
+    return true;
+}
+
+inline bool compile_avar(const char* name, const char* units, compiled_expr& out)
+{
+    if (is_empty_cstr(units))
+        return false;
+
+    // "A:NAME:index"
+    std::string simvar(name + 2);
+    SINT32      index = 0;
+    const auto  colon = simvar.rfind(':');
+    if (colon != std::string::npos)
+    {
+        index = static_cast<SINT32>(std::strtol(simvar.c_str() + colon + 1, nullptr, 10));
+        simvar.resize(colon);
+    }
+
+    const ENUM var = get_aircraft_var_enum(simvar.c_str());
+    const ENUM u   = get_units_enum(units);
+    if (var < 0 || u < 0)
+        return false;
+
+    out.kind  = compiled_expr::avar;
+    out.id    = var;
+    out.units = u;
+    out.index = index;
+    return true;
+}
+
+inline bool compile_code(const char* name, const char* units, compiled_expr& out)
+{
+    const std::string source   = wrap_expression(name, units);
+    PCSTRINGZ         compiled = nullptr;
+    UINT32            size     = 0;
+
+    // The compiled buffer is owned by the sim and reused, keep our own copy. It is run through
+    // execute_calculator_code, which only takes a C string, so `size` (with or without the
+    // terminator) has to match its length. A buffer with a '\0' inside would be cut short there,
+    // the source text is run instead.
+    if (gauge_calculator_code_precompile(&compiled, &size, source.c_str()) && compiled != nullptr && size > 0)
+    {
+        const size_t len = strnlen(compiled, size);
+        if (len + 1 >= size)
+            out.bytes.assign(compiled, len);
+    }
+    if (out.bytes.empty())
+        out.bytes = source;
+
+    out.kind = compiled_expr::code;
+    return true;
+}
+
+inline bool compile(const char* name, const char* units, compiled_expr& out)
+{
+    out = compiled_expr();
+
+    if (is_empty_cstr(name))
+        return false;
+
+    if (std::strncmp(name, "L:", 2) == 0 && compile_lvar(name, units, out))
+        return true;
+
+    if (std::strncmp(name, "A:", 2) == 0 && compile_avar(name, units, out))
+        return true;
+
+    return compile_code(name, units, out);
+}
+
+inline double evaluate(const compiled_expr& e)
+{
+    switch (e.kind)
+    {
+    case compiled_expr::lvar:
+        return e.units < 0 ? get_named_variable_value(e.id) : get_named_variable_typed_value(e.id, e.units);
+    case compiled_expr::avar:
+        return aircraft_varget(e.id, e.units, e.index);
+    case compiled_expr::code:
+    {
+        double result = 0.0;
+        execute_calculator_code(e.bytes.c_str(), &result, nullptr, nullptr);
+        return result;
+    }
+    default:
+        return 0.0;
+    }
+}
+} // namespace fsc::calc
@@ -0,0 +1,189 @@
+﻿#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+namespace fsc::interp
+{
+enum class channel_kind : uint8_t
+{
+    linear,
+    wrap_180, // degrees in [-180, 180)
+    wrap_360, // degrees in [0, 360)
+    step      // holds the earlier sample until the next one is due
+};
+
+// A double field of a protocol struct, how it is interpolated and, for streamed channels, the sim
+// variable it is written to.
+struct channel
+{
+    size_t       offset;
+    channel_kind kind;
+    const char*  simvar = nullptr;
+    const char*  units  = nullptr;
+};
+
+// channels<T>::table lists the interpolated fields of T. Fields that are not listed are left
+// alone by lerp_channels(). A struct streamed on its own client data area also names the area,
+// the bridge registers it, buffers it per session and writes every channel to its simvar.
+template <typename T> struct channels;
+
+template <> struct channels<protocol::physics>
+{
+    static constexpr channel table[] = {
+        {offsetof(protocol::physics, lat), channel_kind::linear},
+        {offsetof(protocol::physics, lon), channel_kind::linear},
+        {offsetof(protocol::physics, alt_feet), channel_kind::linear},
+        {offsetof(protocol::physics, pitch), channel_kind::wrap_180},
+        {offsetof(protocol::physics, bank), channel_kind::wrap_180},
+        {offsetof(protocol::physics, hdg_deg_gyro), channel_kind::wrap_360},
+        {offsetof(protocol::physics, hdg_deg_true), channel_kind::wrap_360},
+        {offsetof(protocol::physics, vertical_speed), channel_kind::linear},
+        {offsetof(protocol::physics, g_force), channel_kind::linear},
+        {offsetof(protocol::physics, v_body_y), channel_kind::linear},
+        {offsetof(protocol::physics, v_body_z), channel_kind::linear},
+        {offsetof(protocol::physics, vx), channel_kind::linear},
+        {offsetof(protocol::physics, vz), channel_kind::linear},
+    };
+};
+
+template <> struct channels<protocol::levers>
+{
+    static constexpr auto area = "FSC_LEVERS";
+
+    static constexpr size_t k_d = sizeof(double);
+
+    static constexpr channel table[] = {
+        {offsetof(protocol::levers, throttle) + 0 * k_d, channel_kind::linear, "GENERAL ENG THROTTLE LEVER POSITION:1", "Percent"},
+        {offsetof(protocol::levers, throttle) + 1 * k_d, channel_kind::linear, "GENERAL ENG THROTTLE LEVER POSITION:2", "Percent"},
+        {offsetof(protocol::levers, throttle) + 2 * k_d, channel_kind::linear, "GENERAL ENG THROTTLE LEVER POSITION:3", "Percent"},
+        {offsetof(protocol::levers, throttle) + 3 * k_d, channel_kind::linear, "GENERAL ENG THROTTLE LEVER POSITION:4", "Percent"},
+        {offsetof(protocol::levers, mixture) + 0 * k_d, channel_kind::linear, "GENERAL ENG MIXTURE LEVER POSITION:1", "Percent"},
+        {offsetof(protocol::levers, mixture) + 1 * k_d, channel_kind::linear, "GENERAL ENG MIXTURE LEVER POSITION:2", "Percent"},
+        {offsetof(protocol::levers, mixture) + 2 * k_d, channel_kind::linear, "GENERAL ENG MIXTURE LEVER POSITION:3", "Percent"},
+        {offsetof(protocol::levers, mixture) + 3 * k_d, channel_kind::linear, "GENERAL ENG MIXTURE LEVER POSITION:4", "Percent"},
+        {offsetof(protocol::levers, propeller) + 0 * k_d, channel_kind::linear, "GENERAL ENG PROPELLER LEVER POSITION:1", "Percent"},
+        {offsetof(protocol::levers, propeller) + 1 * k_d, channel_kind::linear, "GENERAL ENG PROPELLER LEVER POSITION:2", "Percent"},
+        {offsetof(protocol::levers, propeller) + 2 * k_d, channel_kind::linear, "GENERAL ENG PROPELLER LEVER POSITION:3", "Percent"},
+        {offsetof(protocol::levers, propeller) + 3 * k_d, channel_kind::linear, "GENERAL ENG PROPELLER LEVER POSITION:4", "Percent"},
+        {offsetof(protocol::levers, spoilers), channel_kind::linear, "SPOILERS HANDLE POSITION", "Percent"},
+        {offsetof(protocol::levers, elevator_trim), channel_kind::linear, "ELEVATOR TRIM POSITION", "Radians"},
+        {offsetof(protocol::levers, flaps_index), channel_kind::step, "FLAPS HANDLE INDEX", "Number"},
+        {offsetof(protocol::levers, gear_handle), channel_kind::step, "GEAR HANDLE POSITION", "Bool"},
+    };
+};
+
+// The table split into lanes for the kernel: the linear and step channels, and the wrapped ones
+// with the value a normalized channel must stay below.
+template <typename T> struct channel_lanes
+{
+    static constexpr size_t count = sizeof(channels<T>::table) / sizeof(channel);
+
+    static constexpr size_t count_wrapped()
+    {
+        size_t n = 0;
+        for (const auto& c : channels<T>::table)
+            n += c.kind == channel_kind::wrap_180 || c.kind == channel_kind::wrap_360;
+        return n;
+    }
+
+    static constexpr size_t wrapped = count_wrapped();
+    static constexpr size_t linear  = count - wrapped;
+
+    struct layout
+    {
+        size_t linear_offset[linear > 0 ? linear : 1];
+        double weight[linear > 0 ? linear : 1]; // 1 for linear, 0 for step
+        size_t wrapped_offset[wrapped > 0 ? wrapped : 1];
+        double limit[wrapped > 0 ? wrapped : 1]; // 180, or infinity when floor alone normalizes
+    };
+
+    static constexpr layout make()
+    {
+        layout l{};
+        size_t li = 0, wi = 0;
+        for (const auto& c : channels<T>::table)
+        {
+            if (c.kind == channel_kind::linear || c.kind == channel_kind::step)
+            {
+                l.linear_offset[li] = c.offset;
+                l.weight[li++]      = c.kind == channel_kind::linear ? 1.0 : 0.0;
+            }
+            else
+            {
+                l.wrapped_offset[wi] = c.offset;
+                l.limit[wi++]        = c.kind == channel_kind::wrap_180 ? 180.0 : HUGE_VAL;
+            }
+        }
+        return l;
+    }
+
+    static constexpr layout k = make();
+};
+
+// Interpolates every channel of T, each group of lanes in one branch-free loop. Wrapped lanes
+// take the steps of norm360/norm180 and lerp_360_deg/lerp_180_deg with floor and compares in
+// place of fmod and branches:
+//
+//   norm(x) = x - 360 * floor(x / 360), minus 360 once more if at or above 180 for wrap_180
+//   d       = norm(b) - norm(a), moved by 360 when it is more than half a turn
+//   out     = norm(norm(a) + d * t)
+//
+// For values within one turn of the normalized range the result is bit-identical to the scalar
+// functions, except that -360 normalizes to +0 rather than -0. Further out floor(x / 360) can
+// round differently than fmod, the error is at most one ulp of x. `out` may be `a` or `b`.
+template <typename T> void lerp_channels(const T& a, const T& b, const double t, T& out)
+{
+    using lanes       = channel_lanes<T>;
+    constexpr auto& k = lanes::k;
+
+    const auto* pa = reinterpret_cast<const char*>(&a);
+    const auto* pb = reinterpret_cast<const char*>(&b);
+    auto*       po = reinterpret_cast<char*>(&out);
+
+    double la[lanes::linear > 0 ? lanes::linear : 1], lb[lanes::linear > 0 ? lanes::linear : 1];
+    double wa[lanes::wrapped > 0 ? lanes::wrapped : 1], wb[lanes::wrapped > 0 ? lanes::wrapped : 1];
+    for (size_t i = 0; i < lanes::linear; ++i)
+    {
+        std::memcpy(&la[i], pa + k.linear_offset[i], sizeof(double));
+        std::memcpy(&lb[i], pb + k.linear_offset[i], sizeof(double));
+    }
+    for (size_t i = 0; i < lanes::wrapped; ++i)
+    {
+        std::memcpy(&wa[i], pa + k.wrapped_offset[i], sizeof(double));
+        std::memcpy(&wb[i], pb + k.wrapped_offset[i], sizeof(double));
+    }
+
+    for (size_t i = 0; i < lanes::linear; ++i)
+        la[i] += (lb[i] - la[i]) * (t * k.weight[i]);
+
+    constexpr double p   = 360.0;
+    constexpr double inv = 1.0 / 360.0;
+    for (size_t i = 0; i < lanes::wrapped; ++i)
+    {
+        const double limit = k.limit[i];
+
+        double x = wa[i] - p * std::floor(wa[i] * inv);
+        double y = wb[i] - p * std::floor(wb[i] * inv);
+        x -= p * (x >= limit);
+        y -= p * (y >= limit);
+
+        double d = y - x;
+        d -= p * (d > 180.0);
+        d += p * (d < -180.0);
+
+        double o = x + d * t;
+        o -= p * std::floor(o * inv);
+        o -= p * (o >= limit);
+        wa[i] = o;
+    }
+
+    for (size_t i = 0; i < lanes::linear; ++i)
+        std::memcpy(po + k.linear_offset[i], &la[i], sizeof(double));
+    for (size_t i = 0; i < lanes::wrapped; ++i)
+        std::memcpy(po + k.wrapped_offset[i], &wa[i], sizeof(double));
+}
+} // namespace fsc::interp
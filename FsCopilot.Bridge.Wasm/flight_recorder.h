@@ -0,0 +1,203 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Append-only log of what the bridge received, for reproducing a flight outside of it.
+//
+//   file:    "FSCR", u32 version
+//   record:  u32 id (client data area), f64 local receive time in seconds, u16 size, payload
+//
+// Trailing zero bytes of a payload are not written, they are mostly the unused tail of a
+// fixed-size message. The replayer zero-fills them back.
+namespace flight_log
+{
+constexpr char     k_magic[4]    = {'F', 'S', 'C', 'R'};
+constexpr uint32_t k_version     = 1;
+constexpr size_t   k_header_size = sizeof(uint32_t) + sizeof(double) + sizeof(uint16_t);
+constexpr size_t   k_max_payload = 4096;
+} // namespace flight_log
+
+// Records go to a preallocated buffer that is written out every k_flush_sec from flush(), or
+// when the next record would not fit. The frame never waits for the file otherwise.
+class flight_recorder
+{
+  public:
+    static constexpr size_t k_buffer_size = 64 * 1024;
+    static constexpr double k_flush_sec   = 1.0;
+
+    flight_recorder()                                  = default;
+    flight_recorder(const flight_recorder&)            = delete;
+    flight_recorder& operator=(const flight_recorder&) = delete;
+
+    ~flight_recorder()
+    {
+        close();
+    }
+
+    bool open(const char* path)
+    {
+        close();
+        file_ = fopen(path, "wb");
+        if (file_ == nullptr)
+            return false;
+
+        put(flight_log::k_magic, sizeof(flight_log::k_magic));
+        put(&flight_log::k_version, sizeof(flight_log::k_version));
+        return true;
+    }
+
+    void close()
+    {
+        if (file_ == nullptr)
+            return;
+        write_out();
+        (void)fclose(file_);
+        file_ = nullptr;
+    }
+
+    bool active() const
+    {
+        return file_ != nullptr;
+    }
+
+    void record(const uint32_t id, const double t, const void* data, size_t size)
+    {
+        if (file_ == nullptr)
+            return;
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0 && bytes[size - 1] == 0)
+            --size;
+        if (size > flight_log::k_max_payload)
+            return;
+
+        if (used_ + flight_log::k_header_size + size > k_buffer_size)
+            write_out();
+
+        const auto n = static_cast<uint16_t>(size);
+        put(&id, sizeof(id));
+        put(&t, sizeof(t));
+        put(&n, sizeof(n));
+        put(bytes, size);
+        ++records_;
+    }
+
+    void flush(const double now)
+    {
+        if (file_ == nullptr || now - last_flush_ < k_flush_sec)
+            return;
+        last_flush_ = now;
+        write_out();
+        (void)fflush(file_);
+    }
+
+    uint32_t records() const
+    {
+        return records_;
+    }
+
+  private:
+    FILE*    file_       = nullptr;
+    size_t   used_       = 0;
+    double   last_flush_ = 0;
+    uint32_t records_    = 0;
+    uint8_t  buffer_[k_buffer_size]{};
+
+    void put(const void* src, const size_t size)
+    {
+        std::memcpy(buffer_ + used_, src, size);
+        used_ += size;
+    }
+
+    void write_out()
+    {
+        if (used_ > 0)
+            (void)fwrite(buffer_, 1, used_, file_);
+        used_ = 0;
+    }
+};
+
+// Reads a flight_recorder log back in order. Time is the recording's own, so a replay sees the
+// same timestamps on every run whatever speed it is played at.
+class flight_replay
+{
+  public:
+    flight_replay()                                = default;
+    flight_replay(const flight_replay&)            = delete;
+    flight_replay& operator=(const flight_replay&) = delete;
+
+    ~flight_replay()
+    {
+        close();
+    }
+
+    bool open(const char* path)
+    {
+        close();
+        file_ = fopen(path, "rb");
+        if (file_ == nullptr)
+            return false;
+
+        char     magic[sizeof(flight_log::k_magic)];
+        uint32_t version = 0;
+        if (fread(magic, sizeof(magic), 1, file_) != 1 || std::memcmp(magic, flight_log::k_magic, sizeof(magic)) != 0 ||
+            fread(&version, sizeof(version), 1, file_) != 1 || version != flight_log::k_version || !next())
+        {
+            close();
+            return false;
+        }
+        start_ = t_;
+        return true;
+    }
+
+    void close()
+    {
+        if (file_ != nullptr)
+            (void)fclose(file_);
+        file_ = nullptr;
+    }
+
+    // false once the last record was played
+    bool active() const
+    {
+        return file_ != nullptr;
+    }
+
+    // time of the first record
+    double start() const
+    {
+        return start_;
+    }
+
+    // Calls fn(id, t, data, size) for every record up to `until`, recording time. The payload is
+    // zero-filled to k_max_payload.
+    template <typename Fn> void play(const double until, Fn fn)
+    {
+        while (file_ != nullptr && t_ <= until)
+        {
+            fn(id_, t_, payload_, size_);
+            if (!next())
+                close();
+        }
+    }
+
+  private:
+    FILE*    file_  = nullptr;
+    double   start_ = 0;
+    uint32_t id_    = 0;
+    double   t_     = 0;
+    uint16_t size_  = 0;
+    uint8_t  payload_[flight_log::k_max_payload]{};
+
+    bool next()
+    {
+        if (fread(&id_, sizeof(id_), 1, file_) != 1 || fread(&t_, sizeof(t_), 1, file_) != 1 || fread(&size_, sizeof(size_), 1, file_) != 1 ||
+            size_ > sizeof(payload_))
+            return false;
+
+        std::memset(payload_ + size_, 0, sizeof(payload_) - size_);
+        return size_ == 0 || fread(payload_, size_, 1, file_) == 1;
+    }
+};
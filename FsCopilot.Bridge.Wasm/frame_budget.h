@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Time the bridge may spend in one tick. begin() starts the frame, the work that must run every
+// frame goes first, then each deferred queue takes items while left() holds and keeps the rest for
+// the next frame. A queue always takes at least one item, so a frame that is over budget before
+// the queues start still makes progress.
+//
+//     budget.begin();
+//     interpolate(now);
+//     do run_one(); while (more() && budget.left());
+//     budget.end(carried);
+class frame_budget
+{
+    using clock = std::chrono::steady_clock;
+
+  public:
+    struct counters
+    {
+        uint32_t frames;
+        uint32_t overruns; // frames that ended with deferred work left
+        uint32_t carried;  // deferred items left at the end of the last frame
+    };
+
+    explicit frame_budget(const double budget_us)
+        : budget_(std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::micro>(budget_us)))
+    {
+    }
+
+    void begin()
+    {
+        start_ = clock::now();
+    }
+
+    bool left() const
+    {
+        return clock::now() - start_ < budget_;
+    }
+
+    // carried: deferred items the frame did not get to
+    void end(const uint32_t carried)
+    {
+        ++stats_.frames;
+        stats_.overruns += carried > 0;
+        stats_.carried = carried;
+    }
+
+    const counters& stats() const
+    {
+        return stats_;
+    }
+
+  private:
+    clock::duration   budget_;
+    clock::time_point start_{};
+    counters          stats_{};
+};
@@ -0,0 +1,122 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+// Hot path timings and counters, published as protocol::bridge_stats every k_publish_sec.
+//
+//     const auto timed = stats.time(fsc::protocol::timer_interpolate);
+//
+// times the rest of the enclosing scope. frame_stats<false> keeps the same interface with
+// empty bodies, so a build without stats has no clock reads and no state.
+template <bool Enabled> class frame_stats;
+
+template <> class frame_stats<false>
+{
+  public:
+    struct scope
+    {
+        ~scope() {} // not trivial, so an unused scope doesn't warn
+    };
+
+    scope time(fsc::protocol::stats_timer)
+    {
+        return {};
+    }
+
+    void count(fsc::protocol::stats_counter, uint32_t = 1)
+    {
+    }
+
+    void offset(double)
+    {
+    }
+
+    template <typename Fn> void publish(double, Fn)
+    {
+    }
+};
+
+template <> class frame_stats<true>
+{
+    using clock = std::chrono::steady_clock;
+
+  public:
+    static constexpr double k_publish_sec = 1.0;
+
+    class scope
+    {
+      public:
+        scope(frame_stats& stats, const fsc::protocol::stats_timer timer)
+            : stats_(stats), timer_(timer), start_(clock::now())
+        {
+        }
+
+        scope(const scope&)            = delete;
+        scope& operator=(const scope&) = delete;
+
+        ~scope()
+        {
+            stats_.add(timer_, std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count());
+        }
+
+      private:
+        frame_stats&               stats_;
+        fsc::protocol::stats_timer timer_;
+        clock::time_point          start_;
+    };
+
+    scope time(const fsc::protocol::stats_timer timer)
+    {
+        return {*this, timer};
+    }
+
+    void count(const fsc::protocol::stats_counter counter, const uint32_t n = 1)
+    {
+        frame_.counters[counter] += n;
+    }
+
+    void offset(const double offset_sec)
+    {
+        frame_.offset_sec = offset_sec;
+    }
+
+    // Calls fn(const protocol::bridge_stats&) once per interval and starts the next one.
+    template <typename Fn> void publish(const double now, Fn fn)
+    {
+        if (now - last_publish_ < k_publish_sec)
+            return;
+
+        frame_.seq         = ++seq_;
+        frame_.interval_ms = static_cast<uint32_t>((now - last_publish_) * 1000.0);
+        last_publish_      = now;
+        fn(frame_);
+
+        const double offset_sec = frame_.offset_sec;
+        std::memset(&frame_, 0, sizeof(frame_));
+        frame_.offset_sec = offset_sec;
+    }
+
+  private:
+    fsc::protocol::bridge_stats frame_{};
+    uint32_t                    seq_          = 0;
+    double                      last_publish_ = 0;
+
+    void add(const fsc::protocol::stats_timer timer, const int64_t ns)
+    {
+        auto&          h = frame_.timers[timer];
+        const uint32_t t = ns < 0 ? 0 : ns > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ns);
+
+        h.total_ns += t;
+        ++h.count;
+        if (t > h.max_ns)
+            h.max_ns = t;
+
+        // floor(log2(t / 512)) + 1, capped at the last bucket
+        const uint32_t scaled = t >> 9;
+        const int      bucket = scaled == 0 ? 0 : 32 - __builtin_clz(scaled);
+        ++h.buckets[bucket < fsc::protocol::k_stats_buckets ? bucket : fsc::protocol::k_stats_buckets - 1];
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+// Timing for the host benchmarks. measure() runs fn until min_sec has passed and prints the time
+// and the heap allocations per call. The numbers only compare changes on one machine, the sim's
+// wasm runtime is slower across the board.
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace fsc::bench
+{
+// operator new calls, counted by bridge_bench.cpp
+size_t allocations();
+
+// short runs for ctest, set by --smoke
+inline bool& smoke()
+{
+    static bool on = false;
+    return on;
+}
+
+struct result
+{
+    double ns_per_call;
+    double allocs_per_call;
+};
+
+template <typename Fn> result measure(const char* name, Fn fn, const double min_sec = 0.5)
+{
+    using clock = std::chrono::steady_clock;
+
+    const double limit  = smoke() ? 0.0 : min_sec;
+    size_t       calls  = 0;
+    const size_t allocs = allocations();
+    const auto   start  = clock::now();
+    double       sec    = 0;
+    do
+    {
+        fn();
+        ++calls;
+        sec = std::chrono::duration<double>(clock::now() - start).count();
+    } while (sec < limit);
+
+    const result r{sec * 1e9 / static_cast<double>(calls), static_cast<double>(allocations() - allocs) / static_cast<double>(calls)};
+    std::printf("%-56s %12.1f ns %8.2f allocs\n", name, r.ns_per_call, r.allocs_per_call);
+    return r;
+}
+} // namespace fsc::bench
@@ -0,0 +1,431 @@
+// Host benchmarks of the bridge hot paths, run against the stub SDK. `bridge_bench --smoke` runs
+// each case once, ctest uses it to keep them building and running.
+#include "bench.h"
+#include "bridge_io.h"
+#include "interpolators.h"
+#include "motion_encoder.h"
+#include "scalar_physics.h"
+#include "var_watcher.h"
+
+#include <fsc_host.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace host = fsc::host;
+using fsc::bench::measure;
+
+namespace
+{
+size_t g_allocations = 0;
+
+void tick(const double dt = 1.0 / 60.0)
+{
+    host::advance(dt);
+    Update_StandAlone(static_cast<float>(dt));
+}
+
+// var_watcher as it was before the slot arrays: a hash node per watch, compared one by one
+class map_watcher
+{
+  public:
+    void watch(const char* name, const char* units)
+    {
+        entry e;
+        (void)fsc::calc::compile(name, units, e.expr);
+        vars_.emplace(name, std::move(e));
+    }
+
+    void poll(var_update_callback cb, void* user_data)
+    {
+        for (auto& it : vars_)
+        {
+            entry&       e = it.second;
+            const double v = fsc::calc::evaluate(e.expr);
+            if (e.has_last && (std::fabs(v - e.last) <= 1e-6 || (v != v && e.last != e.last)))
+                continue;
+            e.last     = v;
+            e.has_last = true;
+            cb(0, it.first.c_str(), v, user_data);
+        }
+    }
+
+  private:
+    struct entry
+    {
+        fsc::calc::compiled_expr expr;
+        double                   last     = 0;
+        bool                     has_last = false;
+    };
+
+    std::unordered_map<std::string, entry> vars_;
+};
+
+bool count_change(uint32_t /*handle*/, const char* /*name*/, const double /*value*/, void* user)
+{
+    ++*static_cast<size_t*>(user);
+    return true;
+}
+
+// one poll over n watched L: variables with 1% of them changing, slot arrays against hash nodes
+void watcher_poll(const size_t n)
+{
+    host::reset();
+    std::vector<double*> values;
+    var_watcher          slots;
+    map_watcher          nodes;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const std::string name = "L:FSC_W" + std::to_string(i);
+        values.push_back(&host::vars()[name]);
+        (void)slots.watch(name.c_str(), "");
+        nodes.watch(name.c_str(), "");
+    }
+
+    size_t changes = 0;
+    size_t frame   = 0;
+    auto   change  = [&] {
+        ++frame;
+        for (size_t i = 0; i < n / 100; ++i)
+            *values[(frame * 7919 + i * 100) % n] = static_cast<double>(frame);
+    };
+    slots.poll(0, &count_change, &changes);
+    nodes.poll(&count_change, &changes);
+
+    const std::string count = std::to_string(n);
+    measure(("var_watcher poll, " + count + " watches, 1% change").c_str(), [&] {
+        change();
+        slots.poll(0, &count_change, &changes);
+    });
+    measure(("  hash node layout, " + count + " watches").c_str(), [&] {
+        change();
+        nodes.poll(&count_change, &changes);
+    });
+}
+
+// stream_buffer as it was before the ring: a deque and a linear scan from the oldest sample
+template <typename T> class deque_buffer
+{
+  public:
+    void push(double t_local, const T& v)
+    {
+        if (t_local - last_time_ < 0.2)
+        {
+            pending_     = {t_local, v};
+            has_pending_ = true;
+            return;
+        }
+        last_time_ = t_local;
+        while (!buf_.empty() && buf_.front().t_local < t_local - 3.0)
+            buf_.pop_front();
+        buf_.push_back({t_local, v});
+    }
+
+    template <typename LerpFn> bool interpolate(double t_render, T& out, LerpFn lerp_fn)
+    {
+        const auto n = buf_.size();
+        if (n == 0) return false;
+
+        if (has_pending_ && t_render >= buf_[n - 1].t_local)
+        {
+            if (pending_.t_local >= buf_[n - 1].t_local)
+            {
+                buf_.push_back(pending_);
+                return false;
+            }
+            has_pending_ = false;
+        }
+
+        if (n == 1) { out = buf_[0].value; return true; }
+        if (t_render >= buf_[n - 1].t_local) { out = buf_[n - 1].value; return true; }
+        if (t_render <= buf_[0].t_local) { out = buf_[0].value; return true; }
+
+        uint32_t i = 0;
+        while (i + 1 < n && buf_[i + 1].t_local < t_render)
+            ++i;
+
+        const auto&  a     = buf_[i];
+        const auto&  b     = buf_[i + 1];
+        const double dt    = b.t_local - a.t_local;
+        const double alpha = dt <= 1e-9 ? 0.0 : (t_render - a.t_local) / dt;
+        lerp_fn(a.value, b.value, alpha, out);
+        return true;
+    }
+
+  private:
+    std::deque<timed_sample<T>> buf_;
+    double                      last_time_ = 0;
+    timed_sample<T>             pending_{};
+    bool                        has_pending_ = false;
+};
+
+// one 60 fps frame of a 4 Hz physics stream played 0.35 s behind: a push every 15th frame, an
+// interpolation every frame, ring and cursor against the deque
+void stream_frame()
+{
+    stream_buffer<fsc::protocol::physics, fsc::interp::linear> ring;
+    deque_buffer<fsc::protocol::physics>                       deque;
+    fsc::protocol::physics                                     out{};
+    const auto                                                 lerp = [](const auto& a, const auto& b, const double t, auto& o) { fsc::interp::physics(a, b, t, o); };
+
+    auto sample = [](const size_t frame) {
+        fsc::protocol::physics p{};
+        p.lat          = 47.0 + frame * 1e-6;
+        p.lon          = 8.0 + frame * 1e-6;
+        p.alt_feet     = 3000 + frame * 0.1;
+        p.hdg_deg_true = std::fmod(frame * 0.05, 360.0);
+        return p;
+    };
+
+    size_t ring_frame  = 0;
+    size_t deque_frame = 0;
+    measure("stream_buffer frame, ring, 4 Hz in, 60 fps out", [&] {
+        const double now = 1.0 + ring_frame / 60.0;
+        if (ring_frame % 15 == 0)
+            ring.push(now, sample(ring_frame));
+        (void)ring.interpolate(now - 0.35, out);
+        ++ring_frame;
+    });
+    measure("  deque and linear scan", [&] {
+        const double now = 1.0 + deque_frame / 60.0;
+        if (deque_frame % 15 == 0)
+            deque.push(now, sample(deque_frame));
+        (void)deque.interpolate(now - 0.35, out, lerp);
+        ++deque_frame;
+    });
+}
+
+// one physics lerp through the channel kernel and through the scalar functions it replaced, over a
+// table of random samples so the angles cross their seams
+void channel_lerp()
+{
+    std::vector<fsc::protocol::physics> samples(1024);
+    uint32_t                            seed = 1;
+    auto                                next = [&] {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<double>(seed) / 4294967296.0;
+    };
+    for (auto& p : samples)
+    {
+        double v[13];
+        for (auto& x : v)
+            x = next() * 720.0 - 360.0;
+        std::memcpy(&p, v, sizeof(v));
+    }
+
+    fsc::protocol::physics out{};
+    size_t                 i = 0;
+    measure("physics lerp, channel kernel", [&] {
+        fsc::interp::physics(samples[i], samples[i + 1], 0.37, out);
+        i = (i + 1) % (samples.size() - 1);
+    });
+    i = 0;
+    measure("  scalar lerp, lerp_180_deg, lerp_360_deg", [&] {
+        fsc::test::scalar_physics(samples[i], samples[i + 1], 0.37, out);
+        i = (i + 1) % (samples.size() - 1);
+    });
+}
+
+// 60 s of a 30 Hz physics stream through the app's encoder and the bridge's decoder
+void motion_codec()
+{
+    std::vector<fsc::protocol::physics> frames(60 * 30);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        const double t   = static_cast<double>(i) / 30.0;
+        auto&        p   = frames[i];
+        p.lat            = 0.8203 + 2e-6 * std::sin(0.05 * t);
+        p.lon            = 0.1396 + 3e-6 * (1 - std::cos(0.05 * t));
+        p.alt_feet       = 3000 + 12.5 * t;
+        p.pitch          = 4 + 0.8 * std::sin(1.3 * t);
+        p.bank           = -25 + 1.5 * std::sin(2.1 * t);
+        p.hdg_deg_true   = std::fmod(352 + 3 * t, 360.0);
+        p.hdg_deg_gyro   = p.hdg_deg_true;
+        p.vertical_speed = 12.5;
+        p.g_force        = 1.1 + 0.05 * std::sin(5.0 * t);
+        p.v_body_z       = 200;
+        p.vx             = 200 * std::sin(0.05 * t);
+        p.vz             = 200 * std::cos(0.05 * t);
+        p.session_id     = 1;
+        p.time_ms        = static_cast<uint32_t>(t * 1000);
+    }
+
+    fsc::test::motion_encoder            enc;
+    std::vector<fsc::test::motion_frame> encoded;
+    size_t                               bytes = 0;
+    for (const auto& p : frames)
+    {
+        encoded.push_back(enc.encode(p));
+        bytes += encoded.back().size;
+    }
+    std::printf("%-56s %8.1f B per frame %6.0f B/s, raw %zu B\n", "motion frames, 30 Hz", static_cast<double>(bytes) / frames.size(),
+                static_cast<double>(bytes) / 60.0, sizeof(fsc::protocol::physics));
+
+    size_t                        next = 0;
+    fsc::protocol::motion_decoder dec;
+    fsc::protocol::physics        p{};
+    fsc::protocol::surfaces       s{};
+    const auto                    r = measure("motion_decoder, physics frame", [&] {
+        const auto& f = encoded[next];
+        (void)dec.decode(f.data, f.size, p, s);
+        next = (next + 1) % encoded.size();
+    });
+    std::printf("%-56s %12.1f MB/s\n", "  decoded", static_cast<double>(bytes) / encoded.size() / r.ns_per_call * 1e3);
+
+    fsc::test::motion_encoder again;
+    next = 0;
+    measure("  reference encoder, physics frame", [&] {
+        (void)again.encode(frames[next]);
+        next = (next + 1) % frames.size();
+    });
+}
+
+size_t acked()
+{
+    size_t n = 0;
+    for (const auto* w : host::writes("FSC_WATCH_ACK"))
+    {
+        fsc::protocol::var_acks msg{};
+        std::memcpy(&msg, w->data.data(), sizeof(msg));
+        n += msg.count;
+    }
+    return n;
+}
+
+// the whole tick with n watched L: variables, a few of them changing every frame
+void module_tick(const size_t n)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < n; ++i)
+    {
+        names.push_back("L:FSC_BENCH_" + std::to_string(i));
+        host::vars()[names.back()] = 0;
+        host::deliver("FSC_WATCH_H", fsc::test::watch_msg(static_cast<uint32_t>(i), names.back().c_str(), "Number"));
+    }
+    host::clear_sent();
+    for (int i = 0; i < 1000 && acked() < n; ++i)
+        tick();
+
+    size_t frame = 0;
+    measure(("module tick, " + std::to_string(n) + " watched, 1% change").c_str(), [&] {
+        for (size_t i = 0; i < n / 100 + 1; ++i)
+            host::vars()[names[(frame * 37 + i * 101) % n]] = static_cast<double>(frame);
+        ++frame;
+        tick();
+        host::clear_sent();
+    });
+}
+
+// A 4 Hz physics stream played while in control, through SetDataOnSimObject on def_physics_set and
+// through the calculator program the module falls back to when the sim rejects that write. The
+// fallback can't be undone, so this runs last.
+void physics_apply()
+{
+    host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+
+    fsc::protocol::physics p{};
+    p.session_id = 1;
+    size_t frame = 0;
+    auto   play  = [&] {
+        if (frame++ % 15 == 0)
+        {
+            p.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+            p.lat     = 0.82 + frame * 1e-7;
+            p.lon     = 0.14 + frame * 1e-7;
+            p.alt_feet += 1.0;
+            p.hdg_deg_true = std::fmod(frame * 0.05, 360.0);
+            host::deliver("FSC_PHYSICS", p);
+        }
+        tick();
+    };
+
+    // what one frame sends to the sim, after the playout delay has filled
+    auto sent_per_frame = [&](const char* path) {
+        host::clear_sent();
+        for (int i = 0; i < 60; ++i)
+            play();
+        size_t object_bytes = 0;
+        size_t calc_bytes   = 0;
+        for (const auto& w : host::sent().object_data)
+            object_bytes += w.data.size();
+        for (const auto& c : host::sent().calculator)
+            calc_bytes += c.size();
+        std::printf("%-56s %8zu B data %6zu B calculator per frame\n", path, object_bytes / 60, calc_bytes / 60);
+    };
+
+    host::clear_sent();
+    for (int i = 0; i < 120; ++i)
+        play();
+    const DWORD physics_set = host::definition_of("PLANE LATITUDE");
+    DWORD       probe       = 0;
+    for (const auto& w : host::sent().object_data)
+    {
+        if (w.def == physics_set)
+        {
+            probe = w.packet;
+            break;
+        }
+    }
+
+    sent_per_frame("physics frame, data definition");
+    measure("module tick, physics by data definition", [&] {
+        play();
+        host::clear_sent();
+    });
+
+    host::deliver_exception(SIMCONNECT_EXCEPTION_DATA_ERROR, probe);
+    sent_per_frame("physics frame, calculator code");
+    measure("module tick, physics by calculator code", [&] {
+        play();
+        host::clear_sent();
+    });
+}
+} // namespace
+
+size_t fsc::bench::allocations()
+{
+    return g_allocations;
+}
+
+void* operator new(const size_t size)
+{
+    ++g_allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(const int argc, char** argv)
+{
+    fsc::bench::smoke() = argc > 1 && std::string(argv[1]) == "--smoke";
+
+    for (const size_t n : {100, 1000, 10000})
+        watcher_poll(n);
+    stream_frame();
+    channel_lerp();
+    motion_codec();
+
+    host::reset();
+    module_init();
+    host::deliver("FSC_HELLO", fsc::test::str("1.7"));
+    module_tick(1000);
+    physics_apply();
+    module_deinit();
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+// Host stub of the legacy gauge API, the calls the bridge makes. The calculator understands just
+// enough RPN to read and write variables, see host_sdk.cpp.
+#include <cstdint>
+
+typedef const char* PCSTRINGZ;
+typedef double      FLOAT64;
+typedef int32_t     SINT32;
+typedef uint32_t    UINT32;
+typedef int32_t     ID;
+typedef int32_t     ENUM;
+typedef int32_t     BOOL;
+
+BOOL execute_calculator_code(PCSTRINGZ code, FLOAT64* fvalue, SINT32* ivalue, PCSTRINGZ* svalue);
+BOOL gauge_calculator_code_precompile(PCSTRINGZ* pCompiled, UINT32* pCompiledSize, PCSTRINGZ source);
+
+ID      check_named_variable(PCSTRINGZ name);
+ID      register_named_variable(PCSTRINGZ name);
+FLOAT64 get_named_variable_value(ID id);
+FLOAT64 get_named_variable_typed_value(ID id, ENUM units);
+void    set_named_variable_value(ID id, FLOAT64 value);
+void    set_named_variable_typed_value(ID id, FLOAT64 value, ENUM units);
+
+ENUM    get_units_enum(PCSTRINGZ unitname);
+ENUM    get_aircraft_var_enum(PCSTRINGZ simvar);
+FLOAT64 aircraft_varget(ENUM simvar, ENUM units, SINT32 index);
@@ -0,0 +1,3 @@
+#pragma once
+// Host stub of the MSFS SDK header.
+#define MSFS_CALLBACK
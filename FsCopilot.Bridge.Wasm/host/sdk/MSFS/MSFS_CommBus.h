@@ -0,0 +1,18 @@
+#pragma once
+// Host stub of the MSFS SDK comm bus header, calls are recorded by host_sdk.cpp.
+enum FsCommBusBroadcastFlags
+{
+    FsCommBusBroadcast_JS           = 1 << 0,
+    FsCommBusBroadcast_Wasm         = 1 << 1,
+    FsCommBusBroadcast_WasmSelfCall = 1 << 2,
+    FsCommBusBroadcast_Default      = FsCommBusBroadcast_JS | FsCommBusBroadcast_Wasm,
+    FsCommBusBroadcast_AllWasm      = FsCommBusBroadcast_Wasm | FsCommBusBroadcast_WasmSelfCall,
+    FsCommBusBroadcast_All          = FsCommBusBroadcast_JS | FsCommBusBroadcast_AllWasm
+};
+
+typedef void (*FsCommBusWasmCallback)(const char* buf, unsigned int bufSize, void* ctx);
+
+bool fsCommBusCall(const char* eventName, const char* buf, unsigned int bufSize, FsCommBusBroadcastFlags called = FsCommBusBroadcast_Default);
+bool fsCommBusRegister(const char* eventName, FsCommBusWasmCallback callback, void* ctx = nullptr);
+int  fsCommBusUnregister(const char* eventName, FsCommBusWasmCallback callback);
+int  fsCommBusUnregisterOneEvent(const char* eventName, FsCommBusWasmCallback callback, void* ctx = nullptr);
@@ -0,0 +1,3 @@
+#pragma once
+// Host stub of the MSFS SDK header, the Windows types come with SimConnect.h.
+#include <SimConnect.h>
@@ -0,0 +1,161 @@
+#pragma once
+// Host stub of the SimConnect SDK header, only what the bridge uses. Types are sized as in the
+// wasm32 build (DWORD is 32 bits), so client data and SIMCONNECT_RECV layouts match the sim's.
+// The calls are recorded by host_sdk.cpp, see fsc_host.h.
+#include <cstdint>
+
+typedef uint32_t    DWORD;
+typedef int32_t     HRESULT;
+typedef void*       HANDLE;
+typedef void*       HWND;
+typedef const char* LPCSTR;
+
+#define CALLBACK
+#define S_OK 0
+#define E_FAIL static_cast<HRESULT>(0x80004005)
+#define FAILED(hr) ((hr) < 0)
+#define SUCCEEDED(hr) ((hr) >= 0)
+
+typedef DWORD SIMCONNECT_DATA_DEFINITION_ID;
+typedef DWORD SIMCONNECT_DATA_REQUEST_ID;
+typedef DWORD SIMCONNECT_OBJECT_ID;
+typedef DWORD SIMCONNECT_CLIENT_DATA_ID;
+typedef DWORD SIMCONNECT_CLIENT_DATA_DEFINITION_ID;
+typedef DWORD SIMCONNECT_CLIENT_EVENT_ID;
+typedef DWORD SIMCONNECT_NOTIFICATION_GROUP_ID;
+typedef DWORD SIMCONNECT_DATA_REQUEST_FLAG;
+typedef DWORD SIMCONNECT_DATA_SET_FLAG;
+typedef DWORD SIMCONNECT_CLIENT_DATA_REQUEST_FLAG;
+typedef DWORD SIMCONNECT_CLIENT_DATA_SET_FLAG;
+typedef DWORD SIMCONNECT_CREATE_CLIENT_DATA_FLAG;
+typedef DWORD SIMCONNECT_EVENT_FLAG;
+
+enum SIMCONNECT_DATATYPE
+{
+    SIMCONNECT_DATATYPE_INVALID,
+    SIMCONNECT_DATATYPE_INT32,
+    SIMCONNECT_DATATYPE_INT64,
+    SIMCONNECT_DATATYPE_FLOAT32,
+    SIMCONNECT_DATATYPE_FLOAT64
+};
+
+enum SIMCONNECT_PERIOD
+{
+    SIMCONNECT_PERIOD_NEVER,
+    SIMCONNECT_PERIOD_ONCE,
+    SIMCONNECT_PERIOD_VISUAL_FRAME,
+    SIMCONNECT_PERIOD_SIM_FRAME,
+    SIMCONNECT_PERIOD_SECOND
+};
+
+enum SIMCONNECT_CLIENT_DATA_PERIOD
+{
+    SIMCONNECT_CLIENT_DATA_PERIOD_NEVER,
+    SIMCONNECT_CLIENT_DATA_PERIOD_ONCE,
+    SIMCONNECT_CLIENT_DATA_PERIOD_VISUAL_FRAME,
+    SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET,
+    SIMCONNECT_CLIENT_DATA_PERIOD_SECOND
+};
+
+#define SIMCONNECT_UNUSED 0xFFFFFFFFu
+#define SIMCONNECT_OBJECT_ID_USER 0
+#define SIMCONNECT_DATA_REQUEST_FLAG_DEFAULT 0x00000000u
+#define SIMCONNECT_DATA_REQUEST_FLAG_CHANGED 0x00000001u
+#define SIMCONNECT_DATA_REQUEST_FLAG_TAGGED 0x00000002u
+#define SIMCONNECT_DATA_SET_FLAG_DEFAULT 0x00000000u
+#define SIMCONNECT_DATA_SET_FLAG_TAGGED 0x00000001u
+#define SIMCONNECT_CLIENT_DATA_REQUEST_FLAG_DEFAULT 0x00000000u
+#define SIMCONNECT_CLIENT_DATA_REQUEST_FLAG_CHANGED 0x00000001u
+#define SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT 0x00000000u
+#define SIMCONNECT_EVENT_FLAG_DEFAULT 0x00000000u
+#define SIMCONNECT_EVENT_FLAG_GROUPID_IS_PRIORITY 0x00000010u
+#define SIMCONNECT_GROUP_PRIORITY_HIGHEST 1u
+
+enum SIMCONNECT_RECV_ID
+{
+    SIMCONNECT_RECV_ID_NULL,
+    SIMCONNECT_RECV_ID_EXCEPTION,
+    SIMCONNECT_RECV_ID_OPEN,
+    SIMCONNECT_RECV_ID_QUIT,
+    SIMCONNECT_RECV_ID_EVENT,
+    SIMCONNECT_RECV_ID_EVENT_OBJECT_ADDREMOVE,
+    SIMCONNECT_RECV_ID_EVENT_FILENAME,
+    SIMCONNECT_RECV_ID_EVENT_FRAME,
+    SIMCONNECT_RECV_ID_SIMOBJECT_DATA,
+    SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE,
+    SIMCONNECT_RECV_ID_WEATHER_OBSERVATION,
+    SIMCONNECT_RECV_ID_CLOUD_STATE,
+    SIMCONNECT_RECV_ID_ASSIGNED_OBJECT_ID,
+    SIMCONNECT_RECV_ID_RESERVED_KEY,
+    SIMCONNECT_RECV_ID_CUSTOM_ACTION,
+    SIMCONNECT_RECV_ID_SYSTEM_STATE,
+    SIMCONNECT_RECV_ID_CLIENT_DATA
+};
+
+// the ones the host tests use, values as in the SDK
+enum SIMCONNECT_EXCEPTION
+{
+    SIMCONNECT_EXCEPTION_NONE            = 0,
+    SIMCONNECT_EXCEPTION_ERROR           = 1,
+    SIMCONNECT_EXCEPTION_UNRECOGNIZED_ID = 3,
+    SIMCONNECT_EXCEPTION_DATA_ERROR      = 20
+};
+
+struct SIMCONNECT_RECV
+{
+    DWORD dwSize;
+    DWORD dwVersion;
+    DWORD dwID;
+};
+
+struct SIMCONNECT_RECV_EXCEPTION : SIMCONNECT_RECV
+{
+    DWORD dwException;
+    DWORD dwSendID;
+    DWORD dwIndex;
+};
+
+struct SIMCONNECT_RECV_SIMOBJECT_DATA : SIMCONNECT_RECV
+{
+    DWORD dwRequestID;
+    DWORD dwObjectID;
+    DWORD dwDefineID;
+    DWORD dwFlags;
+    DWORD dwentrynumber;
+    DWORD dwoutof;
+    DWORD dwDefineCount;
+    DWORD dwData;
+};
+
+struct SIMCONNECT_RECV_CLIENT_DATA : SIMCONNECT_RECV_SIMOBJECT_DATA
+{
+};
+
+typedef void(CALLBACK* DispatchProc)(SIMCONNECT_RECV* pData, DWORD cbData, void* pContext);
+
+HRESULT SimConnect_Open(HANDLE* phSimConnect, LPCSTR szName, HWND hWnd, DWORD UserEventWin32, HANDLE hEventHandle, DWORD ConfigIndex);
+HRESULT SimConnect_Close(HANDLE hSimConnect);
+HRESULT SimConnect_CallDispatch(HANDLE hSimConnect, DispatchProc pfcnDispatch, void* pContext);
+HRESULT SimConnect_GetLastSentPacketID(HANDLE hSimConnect, DWORD* pdwError);
+
+HRESULT SimConnect_AddToDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID, const char* DatumName, const char* UnitsName,
+                                       SIMCONNECT_DATATYPE DatumType = SIMCONNECT_DATATYPE_FLOAT64, float fEpsilon = 0, DWORD DatumID = SIMCONNECT_UNUSED);
+HRESULT SimConnect_ClearDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID);
+HRESULT SimConnect_RequestDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID ObjectID,
+                                          SIMCONNECT_PERIOD Period, SIMCONNECT_DATA_REQUEST_FLAG Flags = 0, DWORD origin = 0, DWORD interval = 0, DWORD limit = 0);
+HRESULT SimConnect_SetDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID ObjectID, SIMCONNECT_DATA_SET_FLAG Flags,
+                                      DWORD ArrayCount, DWORD cbUnitSize, void* pDataSet);
+
+HRESULT SimConnect_MapClientEventToSimEvent(HANDLE hSimConnect, SIMCONNECT_CLIENT_EVENT_ID EventID, const char* EventName = "");
+HRESULT SimConnect_TransmitClientEvent(HANDLE hSimConnect, SIMCONNECT_OBJECT_ID ObjectID, SIMCONNECT_CLIENT_EVENT_ID EventID, DWORD dwData,
+                                       SIMCONNECT_NOTIFICATION_GROUP_ID GroupID, SIMCONNECT_EVENT_FLAG Flags);
+
+HRESULT SimConnect_MapClientDataNameToID(HANDLE hSimConnect, const char* szClientDataName, SIMCONNECT_CLIENT_DATA_ID ClientDataID);
+HRESULT SimConnect_CreateClientData(HANDLE hSimConnect, SIMCONNECT_CLIENT_DATA_ID ClientDataID, DWORD dwSize, SIMCONNECT_CREATE_CLIENT_DATA_FLAG Flags);
+HRESULT SimConnect_AddToClientDataDefinition(HANDLE hSimConnect, SIMCONNECT_CLIENT_DATA_DEFINITION_ID DefineID, DWORD dwOffset, DWORD dwSizeOrType, float fEpsilon = 0,
+                                             DWORD DatumID = SIMCONNECT_UNUSED);
+HRESULT SimConnect_RequestClientData(HANDLE hSimConnect, SIMCONNECT_CLIENT_DATA_ID ClientDataID, SIMCONNECT_DATA_REQUEST_ID RequestID,
+                                     SIMCONNECT_CLIENT_DATA_DEFINITION_ID DefineID, SIMCONNECT_CLIENT_DATA_PERIOD Period = SIMCONNECT_CLIENT_DATA_PERIOD_ONCE,
+                                     SIMCONNECT_CLIENT_DATA_REQUEST_FLAG Flags = 0, DWORD origin = 0, DWORD interval = 0, DWORD limit = 0);
+HRESULT SimConnect_SetClientData(HANDLE hSimConnect, SIMCONNECT_CLIENT_DATA_ID ClientDataID, SIMCONNECT_CLIENT_DATA_DEFINITION_ID DefineID,
+                                 SIMCONNECT_CLIENT_DATA_SET_FLAG Flags, DWORD dwReserved, DWORD cbUnitSize, void* pDataSet);
@@ -0,0 +1,129 @@
+#pragma once
+// Host side of the stub SDK (host_sdk.cpp): the clock the module runs on, what it sent to the sim
+// and ways to feed it what the sim would. Tests and benchmarks use all of it, the module itself
+// only takes the clock and the flight recording paths (wasm_module.cpp, FSC_HOST).
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SimConnect.h>
+
+// the module entry points, as the sim calls them
+extern "C" void module_init(void);
+extern "C" void module_deinit(void);
+extern "C" void Update_StandAlone(float d_time);
+
+namespace fsc::host
+{
+// steady clock that only moves when told to
+struct clock
+{
+    using duration                  = std::chrono::nanoseconds;
+    using rep                       = duration::rep;
+    using period                    = duration::period;
+    using time_point                = std::chrono::time_point<clock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now();
+};
+
+void   set_time(double sec);
+void   advance(double sec);
+double time();
+
+struct client_data_write
+{
+    DWORD                area;
+    std::vector<uint8_t> data;
+};
+
+struct object_write
+{
+    DWORD                def;
+    std::vector<uint8_t> data;
+    DWORD                packet; // send id, what SimConnect_GetLastSentPacketID returns right after
+};
+
+struct event_write
+{
+    DWORD event;
+    DWORD data;
+};
+
+struct data_request
+{
+    DWORD             request;
+    DWORD             def;
+    SIMCONNECT_PERIOD period;
+    DWORD             flags;
+};
+
+// what the module sent since the last clear_sent()
+struct calls
+{
+    std::vector<std::string>       calculator; // execute_calculator_code, precompiled code as its source
+    std::vector<client_data_write> client_data;
+    std::vector<object_write>      object_data;
+    std::vector<event_write>       events;
+    std::vector<data_request>      data_requests;
+    std::vector<std::string>       bus; // fsCommBusCall payloads
+    uint32_t                       precompiled   = 0;
+    uint32_t                       compiled_runs = 0; // execute_calculator_code calls given precompiled code
+};
+
+calls& sent();
+void   clear_sent();
+
+// Sim variables, keyed as the calculator names them without units: "L:NAME", "A:NAME",
+// "A:NAME:2", an event "K:NAME" keeps the last value sent with it. Unknown names read as 0.
+// The gauge API keeps pointers into the map, entries are only removed by reset().
+std::unordered_map<std::string, double>& vars();
+
+// execute_calculator_code fails for code that contains text, "" for never
+void fail_calculator_on(const std::string& text);
+
+// files module_init records to and replays from in place of k_record_path and k_replay_path,
+// empty for none
+std::string& record_path();
+std::string& replay_path();
+
+// Back to the state at process start: no registrations, variables, calls or failures. The module
+// keeps its own state, tests that need a fresh one run in their own executable.
+void reset();
+
+// Feeding the module as the sim's dispatch would. Client data areas are found by the name the
+// module mapped, sim object requests by a datum of their definition.
+void deliver_client_data(const char* area, const void* data, size_t size);
+void deliver_object_data(DWORD request, const void* data, size_t size, DWORD define_count);
+void deliver_object_data(const char* datum, const void* data, size_t size, DWORD define_count);
+void deliver_exception(DWORD exception, DWORD send_id);
+void deliver_bus(const char* event, const char* msg);
+
+template <typename T> void deliver(const char* area, const T& msg)
+{
+    deliver_client_data(area, &msg, sizeof(msg));
+}
+
+// registrations of the module
+DWORD                     area_id(const char* name);
+DWORD                     definition_of(const char* datum);
+std::vector<std::string>  datums(DWORD def);
+std::vector<data_request> requests_of(DWORD def); // every RequestDataOnSimObject for def, oldest first
+DWORD                     last_packet_id();
+
+// client data written to an area since the last clear_sent(), oldest first
+std::vector<const client_data_write*> writes(const char* area);
+
+template <typename T> bool last_write(const char* area, T& out)
+{
+    const auto all = writes(area);
+    if (all.empty() || all.back()->data.size() < sizeof(T))
+        return false;
+    std::memcpy(&out, all.back()->data.data(), sizeof(T));
+    return true;
+}
+} // namespace fsc::host
@@ -0,0 +1,617 @@
+// Stub SDK for the host build. SimConnect calls are recorded, client data and sim object data are
+// delivered through the dispatch callback the module registered, and the calculator runs a small
+// RPN subset: numbers, "(NAME, units)" reads and "(>NAME, units)" writes.
+#include "fsc_host.h"
+
+#include <MSFS/Legacy/gauges.h>
+#include <MSFS/MSFS_CommBus.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+
+namespace
+{
+constexpr char k_compiled_mark = '\x01'; // precompiled code is the source behind this byte
+
+struct datum
+{
+    std::string         name;
+    SIMCONNECT_DATATYPE type;
+};
+
+struct bus_handler
+{
+    std::string           event;
+    FsCommBusWasmCallback fn;
+    void*                 ctx;
+};
+
+// names handed out as gauge API ids, in order
+struct name_table
+{
+    std::vector<std::string>                 names;
+    std::unordered_map<std::string, int32_t> ids;
+
+    int32_t intern(const std::string& name)
+    {
+        const auto it = ids.find(name);
+        if (it != ids.end())
+            return it->second;
+        names.push_back(name);
+        return ids[name] = static_cast<int32_t>(names.size() - 1);
+    }
+};
+
+struct sim_state
+{
+    int64_t                                 now_ns = 0;
+    fsc::host::calls                        sent;
+    std::unordered_map<std::string, double> vars;
+    std::string                             fail_on;
+    std::string                             record_path;
+    std::string                             replay_path;
+
+    DispatchProc                         dispatch = nullptr;
+    void*                                context  = nullptr;
+    DWORD                                packet   = 0;
+    std::map<std::string, DWORD>         areas;         // name -> client data id
+    std::map<DWORD, DWORD>               area_requests; // client data id -> request id
+    std::map<DWORD, std::vector<datum>>  definitions;
+    std::vector<fsc::host::data_request> requests;
+    std::vector<bus_handler>             bus;
+
+    // Gauge API reads go straight to the value in vars, elements of an unordered_map stay put
+    name_table                        lvars;   // ID -> name without "L:"
+    std::vector<double*>              lvar_at; // ID -> value
+    name_table                        units;
+    name_table                        simvars;    // ENUM -> name without "A:"
+    std::vector<std::vector<double*>> simvar_at; // ENUM, index -> value
+};
+
+sim_state& sim()
+{
+    static sim_state s;
+    return s;
+}
+
+HRESULT sent()
+{
+    ++sim().packet;
+    return S_OK;
+}
+
+ID intern_lvar(const char* name)
+{
+    const ID id = sim().lvars.intern(name);
+    if (static_cast<size_t>(id) >= sim().lvar_at.size())
+        sim().lvar_at.push_back(&sim().vars[std::string("L:") + name]);
+    return id;
+}
+
+double* lvar(const ID id)
+{
+    return id >= 0 && static_cast<size_t>(id) < sim().lvar_at.size() ? sim().lvar_at[static_cast<size_t>(id)] : nullptr;
+}
+
+// "NAME, units" -> "NAME"
+std::string variable_name(std::string text)
+{
+    const auto comma = text.find(',');
+    if (comma != std::string::npos)
+        text.resize(comma);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+        text.pop_back();
+    return text;
+}
+
+bool is_number(const std::string& token)
+{
+    if (token.empty() || !(std::isdigit(static_cast<unsigned char>(token[0])) || token[0] == '-' || token[0] == '.'))
+        return false;
+    for (const char c : token)
+        if (!std::isdigit(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '+' && c != 'e' && c != 'E')
+            return false;
+    return true;
+}
+
+// Runs code against sim().vars. Malformed code changes nothing and fails, like the sim's
+// calculator which rejects the whole program.
+bool calculate(const std::string& code, double& result)
+{
+    std::vector<double>                           stack;
+    std::vector<std::pair<std::string, double>> writes;
+
+    for (size_t i = 0; i < code.size();)
+    {
+        if (std::isspace(static_cast<unsigned char>(code[i])))
+        {
+            ++i;
+            continue;
+        }
+
+        if (code[i] == '(')
+        {
+            const auto close = code.find(')', i);
+            if (close == std::string::npos)
+                return false;
+            const std::string inner = code.substr(i + 1, close - i - 1);
+            i                       = close + 1;
+
+            if (!inner.empty() && inner[0] == '>')
+            {
+                if (stack.empty())
+                    return false;
+                writes.emplace_back(variable_name(inner.substr(1)), stack.back());
+                stack.pop_back();
+            }
+            else
+            {
+                const auto it = sim().vars.find(variable_name(inner));
+                stack.push_back(it == sim().vars.end() ? 0.0 : it->second);
+            }
+            continue;
+        }
+
+        size_t end = i;
+        while (end < code.size() && !std::isspace(static_cast<unsigned char>(code[end])))
+            ++end;
+        const std::string token = code.substr(i, end - i);
+        i                       = end;
+        if (!is_number(token))
+            return false;
+        stack.push_back(std::strtod(token.c_str(), nullptr));
+    }
+
+    for (const auto& w : writes)
+        sim().vars[w.first] = w.second;
+    result = stack.empty() ? 0.0 : stack.back();
+    return true;
+}
+
+// applies a sim object write to the variables, datum by datum
+void apply_object_data(const std::vector<datum>& def, const uint8_t* data, const size_t size)
+{
+    size_t pos = 0;
+    for (const auto& d : def)
+    {
+        const std::string key = d.name.rfind("L:", 0) == 0 ? d.name : "A:" + d.name;
+        if (d.type == SIMCONNECT_DATATYPE_FLOAT64 && pos + sizeof(double) <= size)
+        {
+            double v = 0;
+            std::memcpy(&v, data + pos, sizeof(v));
+            sim().vars[key] = v;
+            pos += sizeof(double);
+        }
+        else if (d.type == SIMCONNECT_DATATYPE_INT32 && pos + sizeof(int32_t) <= size)
+        {
+            int32_t v = 0;
+            std::memcpy(&v, data + pos, sizeof(v));
+            sim().vars[key] = v;
+            pos += sizeof(int32_t);
+        }
+        else
+            return;
+    }
+}
+
+void dispatch_data(const SIMCONNECT_RECV_ID id, const DWORD request, const DWORD def, const void* data, const size_t size, const DWORD define_count)
+{
+    if (sim().dispatch == nullptr)
+        return;
+
+    const size_t          header = sizeof(SIMCONNECT_RECV_SIMOBJECT_DATA) - sizeof(DWORD); // up to dwData
+    std::vector<uint64_t> storage((header + size) / sizeof(uint64_t) + 1);
+    auto*                 recv = reinterpret_cast<SIMCONNECT_RECV_SIMOBJECT_DATA*>(storage.data());
+    recv->dwSize                = static_cast<DWORD>(header + size);
+    recv->dwVersion             = 0;
+    recv->dwID                  = id;
+    recv->dwRequestID           = request;
+    recv->dwObjectID            = SIMCONNECT_OBJECT_ID_USER;
+    recv->dwDefineID            = def;
+    recv->dwFlags               = 0;
+    recv->dwentrynumber         = 1;
+    recv->dwoutof               = 1;
+    recv->dwDefineCount         = define_count;
+    std::memcpy(&recv->dwData, data, size);
+    sim().dispatch(recv, recv->dwSize, sim().context);
+}
+} // namespace
+
+namespace fsc::host
+{
+clock::time_point clock::now()
+{
+    return time_point(duration(sim().now_ns));
+}
+
+void set_time(const double sec)
+{
+    sim().now_ns = static_cast<int64_t>(sec * 1e9);
+}
+
+void advance(const double sec)
+{
+    sim().now_ns += static_cast<int64_t>(sec * 1e9);
+}
+
+double time()
+{
+    return static_cast<double>(sim().now_ns) / 1e9;
+}
+
+calls& sent()
+{
+    return sim().sent;
+}
+
+void clear_sent()
+{
+    sim().sent = calls();
+}
+
+std::unordered_map<std::string, double>& vars()
+{
+    return sim().vars;
+}
+
+void fail_calculator_on(const std::string& text)
+{
+    sim().fail_on = text;
+}
+
+std::string& record_path()
+{
+    return sim().record_path;
+}
+
+std::string& replay_path()
+{
+    return sim().replay_path;
+}
+
+void reset()
+{
+    sim() = sim_state();
+}
+
+void deliver_client_data(const char* area, const void* data, const size_t size)
+{
+    const DWORD id = area_id(area);
+    const auto  it = sim().area_requests.find(id);
+    if (it != sim().area_requests.end())
+        dispatch_data(SIMCONNECT_RECV_ID_CLIENT_DATA, it->second, id, data, size, 1);
+}
+
+void deliver_object_data(const DWORD request, const void* data, const size_t size, const DWORD define_count)
+{
+    DWORD def = SIMCONNECT_UNUSED;
+    for (const auto& r : sim().requests)
+        if (r.request == request)
+            def = r.def;
+    dispatch_data(SIMCONNECT_RECV_ID_SIMOBJECT_DATA, request, def, data, size, define_count);
+}
+
+void deliver_object_data(const char* datum, const void* data, const size_t size, const DWORD define_count)
+{
+    const DWORD def = definition_of(datum);
+    for (auto it = sim().requests.rbegin(); it != sim().requests.rend(); ++it)
+    {
+        if (it->def == def)
+        {
+            dispatch_data(SIMCONNECT_RECV_ID_SIMOBJECT_DATA, it->request, def, data, size, define_count);
+            return;
+        }
+    }
+}
+
+void deliver_exception(const DWORD exception, const DWORD send_id)
+{
+    if (sim().dispatch == nullptr)
+        return;
+
+    SIMCONNECT_RECV_EXCEPTION ex{};
+    ex.dwSize      = sizeof(ex);
+    ex.dwID        = SIMCONNECT_RECV_ID_EXCEPTION;
+    ex.dwException = exception;
+    ex.dwSendID    = send_id;
+    sim().dispatch(&ex, sizeof(ex), sim().context);
+}
+
+void deliver_bus(const char* event, const char* msg)
+{
+    for (const auto& h : sim().bus)
+        if (h.event == event)
+            h.fn(msg, static_cast<unsigned int>(std::strlen(msg) + 1), h.ctx);
+}
+
+DWORD area_id(const char* name)
+{
+    const auto it = sim().areas.find(name);
+    return it == sim().areas.end() ? SIMCONNECT_UNUSED : it->second;
+}
+
+DWORD definition_of(const char* name)
+{
+    for (const auto& def : sim().definitions)
+        for (const auto& d : def.second)
+            if (d.name == name)
+                return def.first;
+    return SIMCONNECT_UNUSED;
+}
+
+std::vector<std::string> datums(const DWORD def)
+{
+    std::vector<std::string> names;
+    const auto               it = sim().definitions.find(def);
+    if (it != sim().definitions.end())
+        for (const auto& d : it->second)
+            names.push_back(d.name);
+    return names;
+}
+
+std::vector<data_request> requests_of(const DWORD def)
+{
+    std::vector<data_request> out;
+    for (const auto& r : sim().requests)
+        if (r.def == def)
+            out.push_back(r);
+    return out;
+}
+
+DWORD last_packet_id()
+{
+    return sim().packet;
+}
+
+std::vector<const client_data_write*> writes(const char* area)
+{
+    const DWORD                           id = area_id(area);
+    std::vector<const client_data_write*> out;
+    for (const auto& w : sim().sent.client_data)
+        if (w.area == id)
+            out.push_back(&w);
+    return out;
+}
+} // namespace fsc::host
+
+// SimConnect
+
+HRESULT SimConnect_Open(HANDLE* phSimConnect, LPCSTR, HWND, DWORD, HANDLE, DWORD)
+{
+    *phSimConnect = &sim();
+    return sent();
+}
+
+HRESULT SimConnect_Close(HANDLE)
+{
+    sim().dispatch = nullptr;
+    return sent();
+}
+
+HRESULT SimConnect_CallDispatch(HANDLE, DispatchProc pfcnDispatch, void* pContext)
+{
+    sim().dispatch = pfcnDispatch;
+    sim().context  = pContext;
+    return sent();
+}
+
+HRESULT SimConnect_GetLastSentPacketID(HANDLE, DWORD* pdwError)
+{
+    *pdwError = sim().packet;
+    return S_OK;
+}
+
+HRESULT SimConnect_AddToDataDefinition(HANDLE, SIMCONNECT_DATA_DEFINITION_ID DefineID, const char* DatumName, const char*, SIMCONNECT_DATATYPE DatumType, float, DWORD)
+{
+    sim().definitions[DefineID].push_back({DatumName, DatumType});
+    return sent();
+}
+
+HRESULT SimConnect_ClearDataDefinition(HANDLE, SIMCONNECT_DATA_DEFINITION_ID DefineID)
+{
+    sim().definitions.erase(DefineID);
+    return sent();
+}
+
+HRESULT SimConnect_RequestDataOnSimObject(HANDLE, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID,
+                                          SIMCONNECT_PERIOD Period, SIMCONNECT_DATA_REQUEST_FLAG Flags, DWORD, DWORD, DWORD)
+{
+    const fsc::host::data_request r{RequestID, DefineID, Period, Flags};
+    sim().requests.push_back(r);
+    sim().sent.data_requests.push_back(r);
+    return sent();
+}
+
+HRESULT SimConnect_SetDataOnSimObject(HANDLE, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID, SIMCONNECT_DATA_SET_FLAG, DWORD, DWORD cbUnitSize,
+                                      void* pDataSet)
+{
+    const auto*   bytes = static_cast<const uint8_t*>(pDataSet);
+    const HRESULT hr    = sent();
+    sim().sent.object_data.push_back({DefineID, std::vector<uint8_t>(bytes, bytes + cbUnitSize), sim().packet});
+    apply_object_data(sim().definitions[DefineID], bytes, cbUnitSize);
+    return hr;
+}
+
+HRESULT SimConnect_MapClientEventToSimEvent(HANDLE, SIMCONNECT_CLIENT_EVENT_ID, const char*)
+{
+    return sent();
+}
+
+HRESULT SimConnect_TransmitClientEvent(HANDLE, SIMCONNECT_OBJECT_ID, SIMCONNECT_CLIENT_EVENT_ID EventID, DWORD dwData, SIMCONNECT_NOTIFICATION_GROUP_ID,
+                                       SIMCONNECT_EVENT_FLAG)
+{
+    sim().sent.events.push_back({EventID, dwData});
+    return sent();
+}
+
+HRESULT SimConnect_MapClientDataNameToID(HANDLE, const char* szClientDataName, SIMCONNECT_CLIENT_DATA_ID ClientDataID)
+{
+    sim().areas[szClientDataName] = ClientDataID;
+    return sent();
+}
+
+HRESULT SimConnect_CreateClientData(HANDLE, SIMCONNECT_CLIENT_DATA_ID, DWORD, SIMCONNECT_CREATE_CLIENT_DATA_FLAG)
+{
+    return sent();
+}
+
+HRESULT SimConnect_AddToClientDataDefinition(HANDLE, SIMCONNECT_CLIENT_DATA_DEFINITION_ID, DWORD, DWORD, float, DWORD)
+{
+    return sent();
+}
+
+HRESULT SimConnect_RequestClientData(HANDLE, SIMCONNECT_CLIENT_DATA_ID ClientDataID, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_CLIENT_DATA_DEFINITION_ID,
+                                     SIMCONNECT_CLIENT_DATA_PERIOD, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG, DWORD, DWORD, DWORD)
+{
+    sim().area_requests[ClientDataID] = RequestID;
+    return sent();
+}
+
+HRESULT SimConnect_SetClientData(HANDLE, SIMCONNECT_CLIENT_DATA_ID ClientDataID, SIMCONNECT_CLIENT_DATA_DEFINITION_ID, SIMCONNECT_CLIENT_DATA_SET_FLAG, DWORD,
+                                 DWORD cbUnitSize, void* pDataSet)
+{
+    const auto* bytes = static_cast<const uint8_t*>(pDataSet);
+    sim().sent.client_data.push_back({ClientDataID, std::vector<uint8_t>(bytes, bytes + cbUnitSize)});
+    return sent();
+}
+
+// comm bus
+
+bool fsCommBusCall(const char*, const char* buf, unsigned int bufSize, FsCommBusBroadcastFlags)
+{
+    sim().sent.bus.emplace_back(buf, bufSize > 0 && buf[bufSize - 1] == '\0' ? bufSize - 1 : bufSize);
+    return true;
+}
+
+bool fsCommBusRegister(const char* eventName, FsCommBusWasmCallback callback, void* ctx)
+{
+    sim().bus.push_back({eventName, callback, ctx});
+    return true;
+}
+
+int fsCommBusUnregister(const char* eventName, FsCommBusWasmCallback callback)
+{
+    return fsCommBusUnregisterOneEvent(eventName, callback, nullptr);
+}
+
+int fsCommBusUnregisterOneEvent(const char* eventName, FsCommBusWasmCallback callback, void*)
+{
+    auto& bus = sim().bus;
+    for (size_t i = 0; i < bus.size(); ++i)
+    {
+        if (bus[i].event == eventName && bus[i].fn == callback)
+        {
+            bus.erase(bus.begin() + static_cast<ptrdiff_t>(i));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// gauge API
+
+BOOL execute_calculator_code(PCSTRINGZ code, FLOAT64* fvalue, SINT32* ivalue, PCSTRINGZ* svalue)
+{
+    std::string source = code;
+    if (!source.empty() && source[0] == k_compiled_mark)
+    {
+        source.erase(0, 1);
+        ++sim().sent.compiled_runs;
+    }
+    sim().sent.calculator.push_back(source);
+
+    double result = 0.0;
+    if (!sim().fail_on.empty() && source.find(sim().fail_on) != std::string::npos)
+        return 0;
+    if (!calculate(source, result))
+        return 0;
+
+    if (fvalue != nullptr)
+        *fvalue = result;
+    if (ivalue != nullptr)
+        *ivalue = static_cast<SINT32>(result);
+    if (svalue != nullptr)
+        *svalue = "";
+    return 1;
+}
+
+BOOL gauge_calculator_code_precompile(PCSTRINGZ* pCompiled, UINT32* pCompiledSize, PCSTRINGZ source)
+{
+    // the sim hands out a buffer it reuses on the next call
+    static std::string compiled;
+    compiled = std::string(1, k_compiled_mark) + source;
+    ++sim().sent.precompiled;
+
+    *pCompiled     = compiled.c_str();
+    *pCompiledSize = static_cast<UINT32>(compiled.size() + 1);
+    return 1;
+}
+
+ID check_named_variable(PCSTRINGZ name)
+{
+    if (sim().vars.find(std::string("L:") + name) == sim().vars.end())
+        return -1;
+    return intern_lvar(name);
+}
+
+ID register_named_variable(PCSTRINGZ name)
+{
+    return intern_lvar(name);
+}
+
+FLOAT64 get_named_variable_value(ID id)
+{
+    const double* v = lvar(id);
+    return v != nullptr ? *v : 0.0;
+}
+
+FLOAT64 get_named_variable_typed_value(ID id, ENUM)
+{
+    return get_named_variable_value(id);
+}
+
+void set_named_variable_value(ID id, FLOAT64 value)
+{
+    if (double* v = lvar(id))
+        *v = value;
+}
+
+void set_named_variable_typed_value(ID id, FLOAT64 value, ENUM)
+{
+    set_named_variable_value(id, value);
+}
+
+ENUM get_units_enum(PCSTRINGZ unitname)
+{
+    return unitname != nullptr && unitname[0] != '\0' ? sim().units.intern(unitname) : -1;
+}
+
+ENUM get_aircraft_var_enum(PCSTRINGZ simvar)
+{
+    return simvar != nullptr && simvar[0] != '\0' ? sim().simvars.intern(simvar) : -1;
+}
+
+FLOAT64 aircraft_varget(ENUM simvar, ENUM, SINT32 index)
+{
+    if (simvar < 0 || static_cast<size_t>(simvar) >= sim().simvars.names.size() || index < 0)
+        return 0.0;
+
+    auto& at = sim().simvar_at;
+    if (at.size() < sim().simvars.names.size())
+        at.resize(sim().simvars.names.size());
+
+    auto& slots = at[static_cast<size_t>(simvar)];
+    if (slots.size() <= static_cast<size_t>(index))
+        slots.resize(static_cast<size_t>(index) + 1, nullptr);
+
+    double*& v = slots[static_cast<size_t>(index)];
+    if (v == nullptr)
+    {
+        std::string key = "A:" + sim().simvars.names[static_cast<size_t>(simvar)];
+        if (index > 0)
+            key += ":" + std::to_string(index);
+        v = &sim().vars[key];
+    }
+    return *v;
+}
@@ -0,0 +1,86 @@
+#pragma once
+// Host stand-in for the wasm SIMD intrinsics the bridge uses, computed lane by lane with the same
+// results, so the __wasm_simd128__ paths can be checked against their scalar fallbacks off the
+// sim (change_detection_simd_test).
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+struct v128_t
+{
+    uint64_t lanes[2];
+};
+
+namespace fsc::host::simd
+{
+inline double f64(const v128_t v, const int i)
+{
+    double d;
+    std::memcpy(&d, &v.lanes[i], sizeof(d));
+    return d;
+}
+
+inline v128_t f64x2(const double a, const double b)
+{
+    v128_t v;
+    std::memcpy(&v.lanes[0], &a, sizeof(a));
+    std::memcpy(&v.lanes[1], &b, sizeof(b));
+    return v;
+}
+
+inline v128_t mask(const bool a, const bool b)
+{
+    return {{a ? ~0ull : 0ull, b ? ~0ull : 0ull}};
+}
+} // namespace fsc::host::simd
+
+inline v128_t wasm_v128_load(const void* mem)
+{
+    v128_t v;
+    std::memcpy(&v, mem, sizeof(v));
+    return v;
+}
+
+inline v128_t wasm_v128_and(const v128_t a, const v128_t b)
+{
+    return {{a.lanes[0] & b.lanes[0], a.lanes[1] & b.lanes[1]}};
+}
+
+inline v128_t wasm_v128_or(const v128_t a, const v128_t b)
+{
+    return {{a.lanes[0] | b.lanes[0], a.lanes[1] | b.lanes[1]}};
+}
+
+inline v128_t wasm_f64x2_splat(const double x)
+{
+    return fsc::host::simd::f64x2(x, x);
+}
+
+inline v128_t wasm_f64x2_sub(const v128_t a, const v128_t b)
+{
+    using namespace fsc::host::simd;
+    return f64x2(f64(a, 0) - f64(b, 0), f64(a, 1) - f64(b, 1));
+}
+
+inline v128_t wasm_f64x2_abs(const v128_t a)
+{
+    using namespace fsc::host::simd;
+    return f64x2(std::fabs(f64(a, 0)), std::fabs(f64(a, 1)));
+}
+
+inline v128_t wasm_f64x2_le(const v128_t a, const v128_t b)
+{
+    using namespace fsc::host::simd;
+    return mask(f64(a, 0) <= f64(b, 0), f64(a, 1) <= f64(b, 1));
+}
+
+inline v128_t wasm_f64x2_ne(const v128_t a, const v128_t b)
+{
+    using namespace fsc::host::simd;
+    return mask(f64(a, 0) != f64(b, 0), f64(a, 1) != f64(b, 1));
+}
+
+inline uint32_t wasm_i64x2_bitmask(const v128_t a)
+{
+    return static_cast<uint32_t>((a.lanes[0] >> 63) | ((a.lanes[1] >> 63) << 1));
+}
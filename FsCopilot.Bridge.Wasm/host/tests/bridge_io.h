@@ -0,0 +1,119 @@
+#pragma once
+// The desktop app's side of the client data protocol, for tests that talk to the module: reads
+// var_batch records like Connection/VarBatchReader.cs and writes watch lists like SimClient.cs.
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "protocol.h"
+
+namespace fsc::test
+{
+// handle -> value of every record in batch, names of rec_name records go to names when given
+inline std::map<uint16_t, double> read_batch(const protocol::var_batch& batch, std::map<uint16_t, std::string>* names = nullptr)
+{
+    std::map<uint16_t, double> values;
+    const uint8_t*             p   = batch.data;
+    const uint8_t*             end = batch.data + batch.size;
+
+    auto u16 = [&] {
+        uint16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    };
+    auto get = [&](auto v) {
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return static_cast<double>(v);
+    };
+
+    for (uint16_t i = 0; i < batch.count && p < end; ++i)
+    {
+        const auto tag = static_cast<protocol::var_record>(*p++);
+        if (tag == protocol::rec_bits)
+        {
+            const uint8_t  n = *p++;
+            const uint8_t* h = p;
+            p += n * 2;
+            for (uint8_t b = 0; b < n; ++b)
+            {
+                uint16_t handle;
+                std::memcpy(&handle, h + b * 2, sizeof(handle));
+                values[handle] = (p[b / 8] >> (b % 8)) & 1;
+            }
+            p += (n + 7) / 8;
+            continue;
+        }
+
+        const uint16_t handle = u16();
+        switch (tag)
+        {
+        case protocol::rec_name:
+        {
+            const uint8_t len = *p++;
+            if (names != nullptr)
+                (*names)[handle] = std::string(reinterpret_cast<const char*>(p), len);
+            p += len;
+            break;
+        }
+        case protocol::rec_i8:
+            values[handle] = get(int8_t());
+            break;
+        case protocol::rec_i16:
+            values[handle] = get(int16_t());
+            break;
+        case protocol::rec_i32:
+            values[handle] = get(int32_t());
+            break;
+        case protocol::rec_f32:
+            values[handle] = get(float());
+            break;
+        default:
+            values[handle] = get(double());
+            break;
+        }
+    }
+    return values;
+}
+
+// appends one record to a watch list, false when it does not fit
+inline bool add_watch(protocol::var_watch_list& list, size_t& used, const uint32_t tag, const uint8_t flags, const uint8_t rate, const char* name, const char* units)
+{
+    const size_t name_len  = std::strlen(name);
+    const size_t units_len = std::strlen(units);
+    const size_t size      = sizeof(tag) + 2 + 1 + name_len + 1 + units_len;
+    if (used + size > sizeof(list.data))
+        return false;
+
+    uint8_t* p = list.data + used;
+    std::memcpy(p, &tag, sizeof(tag));
+    p[4] = flags;
+    p[5] = rate;
+    p[6] = static_cast<uint8_t>(name_len);
+    std::memcpy(p + 7, name, name_len);
+    p[7 + name_len] = static_cast<uint8_t>(units_len);
+    std::memcpy(p + 8 + name_len, units, units_len);
+    used += size;
+    ++list.count;
+    return true;
+}
+
+inline protocol::var_watch watch_msg(const uint32_t tag, const char* name, const char* units, const uint8_t flags = protocol::watch_poll, const uint8_t rate = protocol::rate_every_frame)
+{
+    protocol::var_watch w{};
+    w.tag   = tag;
+    w.flags = flags;
+    w.rate  = rate;
+    std::strncpy(w.name, name, sizeof(w.name) - 1);
+    std::strncpy(w.units, units, sizeof(w.units) - 1);
+    return w;
+}
+
+inline protocol::str_msg str(const char* text)
+{
+    protocol::str_msg msg{};
+    std::strncpy(msg.msg, text, sizeof(msg.msg) - 1);
+    return msg;
+}
+} // namespace fsc::test
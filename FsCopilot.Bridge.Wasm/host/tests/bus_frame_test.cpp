@@ -0,0 +1,167 @@
+// bus_writer frames read back by bus_reader: coalescing, chunking, sequence gaps and the limits
+// of both queues.
+#include "bus_frame.h"
+#include "check.h"
+
+#include <string>
+#include <vector>
+
+using namespace fsc::protocol;
+using fsc::test::run;
+
+namespace
+{
+std::string message(const size_t size, const char fill)
+{
+    std::string s(size, fill);
+    s.front() = '<';
+    s.back()  = '>';
+    return s;
+}
+
+// every frame the writer has queued up
+std::vector<bus_frame> frames(bus_writer& w)
+{
+    std::vector<bus_frame> out;
+    while (const bus_frame* f = w.next())
+        out.push_back(*f);
+    return out;
+}
+
+std::vector<std::string> drained(bus_reader& r)
+{
+    std::vector<std::string> out;
+    r.drain([&](const char* msg, const size_t size) {
+        CHECK(msg[size] == 0);
+        out.emplace_back(msg, size);
+    });
+    return out;
+}
+
+// one record with the given flags, appended to a hand made frame
+void put(bus_frame& f, const std::string& bytes, const uint8_t flags, const uint16_t claimed)
+{
+    std::memcpy(f.data + f.size, &claimed, sizeof(claimed));
+    f.data[f.size + 2] = flags;
+    std::memcpy(f.data + f.size + k_bus_record_header, bytes.data(), bytes.size());
+    f.size = static_cast<uint16_t>(f.size + k_bus_record_header + bytes.size());
+}
+} // namespace
+
+int main()
+{
+    run("messages queued between two frames share one", [] {
+        bus_writer w;
+        CHECK(w.push("one", 3) && w.push("two", 3) && w.push("", 0));
+        const auto all = frames(w);
+        CHECK(all.size() == 1 && all[0].seq == 1 && all[0].size == 3 * k_bus_record_header + 6);
+        CHECK(w.empty() && w.next() == nullptr);
+
+        bus_reader r;
+        r.read(all[0]);
+        CHECK(drained(r) == (std::vector<std::string>{"one", "two", ""}));
+        CHECK(r.stats().messages == 3 && r.stats().lost == 0 && r.stats().dropped == 0);
+    });
+
+    run("a message past the room left is split and put back together", [] {
+        const std::string small = message(100, 's');
+        const std::string big   = message(6000, 'b');
+        bus_writer        w;
+        CHECK(w.push(small.data(), small.size()) && w.push(big.data(), big.size()));
+        const auto all = frames(w);
+        CHECK(all.size() == 2 && all[0].size == sizeof(all[0].data) && all[1].seq == 2);
+
+        bus_reader r;
+        r.read(all[0]);
+        CHECK(r.pending() == 1);
+        r.read(all[1]);
+        CHECK(drained(r) == (std::vector<std::string>{small, big}));
+    });
+
+    run("k_bus_max_message is the largest message either side takes", [] {
+        const std::string max = message(k_bus_max_message, 'm');
+        bus_writer        w;
+        CHECK(w.push(max.data(), max.size()));
+        CHECK(!w.push(max.data(), max.size() + 1) && w.dropped() == 1);
+
+        bus_reader r;
+        const auto all = frames(w);
+        for (const auto& f : all)
+            r.read(f);
+        const auto got = drained(r);
+        CHECK(got.size() == 1 && got[0] == max);
+
+        // chunks that add up to one byte more are dropped by the reader
+        bus_frame a{};
+        bus_frame b{};
+        a.seq = all.back().seq + 1;
+        b.seq = a.seq + 1;
+        put(a, message(4000, 'x'), bus_first, 4000);
+        put(b, message(4193, 'y'), bus_last, 4193);
+        r.read(a);
+        r.read(b);
+        CHECK(r.pending() == 0 && r.stats().dropped == 1 && r.stats().lost == 0);
+    });
+
+    run("a missing frame drops the message it cut and nothing after", [] {
+        const std::string cut   = message(k_bus_max_message, 'c');
+        const std::string after = message(50, 'a');
+        bus_writer        w;
+        CHECK(w.push(cut.data(), cut.size()) && w.push(after.data(), after.size()));
+        const auto all = frames(w);
+        CHECK(all.size() == 3);
+        if (all.size() != 3)
+            return;
+
+        bus_reader r;
+        r.read(all[0]);
+        r.read(all[2]); // all[1] is lost
+        CHECK(r.stats().lost == 1);
+        CHECK(drained(r) == (std::vector<std::string>{after}));
+        CHECK(r.stats().messages == 1 && r.stats().dropped == 0);
+    });
+
+    run("a record running past the frame ends it", [] {
+        bus_frame f{};
+        f.seq = 1;
+        put(f, "ok", bus_first | bus_last, 2);
+        put(f, "short", bus_first | bus_last, 200);
+        bus_reader r;
+        r.read(f);
+        CHECK(drained(r) == (std::vector<std::string>{"ok"}));
+        CHECK(r.stats().dropped == 1);
+    });
+
+    run("a full writer queue drops the message", [] {
+        const std::string half = message(8000, 'h');
+        bus_writer        w;
+        CHECK(w.push(half.data(), half.size()) && w.push(half.data(), half.size()));
+        CHECK(!w.push(half.data(), 400) && w.dropped() == 1);
+
+        // sending frees the room again
+        CHECK(frames(w).size() == 4 && w.empty());
+        CHECK(w.push(half.data(), half.size()) && w.dropped() == 1);
+    });
+
+    run("a reader that is not drained drops what no longer fits", [] {
+        const std::string msg = message(1000, 'r');
+        bus_writer        w;
+        bus_reader        r;
+        for (int i = 0; i < 20; ++i)
+        {
+            CHECK(w.push(msg.data(), msg.size()));
+            r.read(*w.next());
+        }
+        const auto kept = r.pending();
+        CHECK(kept == 16 * 1024 / (msg.size() + message_queue<1>::k_entry_overhead));
+        CHECK(r.stats().messages == kept && r.stats().dropped == 20 - kept);
+
+        // a drain that stops early leaves the rest for the next one
+        size_t seen = 0;
+        r.drain([&](const char*, size_t) { ++seen; }, [&] { return seen < 3; });
+        CHECK(seen == 3 && r.pending() == kept - 3);
+        CHECK(drained(r).size() == kept - 3);
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,102 @@
+// var_watcher::detect_changes against a per-value reference. Built twice: as is for the scalar
+// loop and as change_detection_simd_test with the wasm SIMD path on emulated intrinsics.
+#include "check.h"
+#include "var_watcher.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+constexpr double k_nan = std::numeric_limits<double>::quiet_NaN();
+constexpr double k_inf = std::numeric_limits<double>::infinity();
+
+// the documented rule, one value at a time
+bool reference(const double last, const double cur, const bool has_last, const double epsilon)
+{
+    if (!has_last)
+        return true;
+    if (std::isnan(last) && std::isnan(cur))
+        return false;
+    return !(std::fabs(cur - last) <= epsilon);
+}
+
+// every bit of detect_changes matches the reference, bits past n stay clear
+void check_all(const std::vector<double>& last, const std::vector<double>& cur, const std::vector<uint8_t>& has_last, const double epsilon)
+{
+    const size_t          n = last.size();
+    std::vector<uint64_t> dirty((n + 63) / 64 + 1, ~0ull);
+    var_watcher::detect_changes(last.data(), cur.data(), has_last.data(), n, epsilon, dirty.data());
+
+    for (size_t i = 0; i < n; ++i)
+        CHECK(((dirty[i / 64] >> (i % 64)) & 1) == reference(last[i], cur[i], has_last[i] != 0, epsilon));
+    if (n % 64 != 0)
+        CHECK((dirty[n / 64] >> (n % 64)) == 0);
+}
+} // namespace
+
+int main()
+{
+#if defined(__wasm_simd128__)
+    std::printf("wasm SIMD path, emulated\n");
+#endif
+
+    run("epsilon bounds a change", [] {
+        check_all({1.0, 1.0, 1.0, 1.0}, {1.0, 1.0 + 1e-7, 1.0 + 1e-6, 1.0 + 2e-6}, {1, 1, 1, 1}, 1e-6);
+        check_all({0.0, -0.0}, {-0.0, 0.0}, {1, 1}, 0.0);
+    });
+
+    run("NaN only matches NaN", [] {
+        check_all({k_nan, k_nan, 1.0, k_nan}, {k_nan, 1.0, k_nan, -k_nan}, {1, 1, 1, 1}, 1e-6);
+    });
+
+    run("infinities", [] {
+        check_all({k_inf, k_inf, -k_inf, 1.0}, {k_inf, -k_inf, -k_inf, k_inf}, {1, 1, 1, 1}, 1e-6);
+    });
+
+    run("a value without a last one is always a change", [] {
+        check_all({5.0, 5.0, k_nan}, {5.0, 6.0, k_nan}, {0, 0, 0}, 1e-6);
+    });
+
+    run("lengths around the 64-bit words and the 2-lane tail", [] {
+        for (const size_t n : {0, 1, 2, 3, 63, 64, 65, 127, 128, 130})
+        {
+            std::vector<double>  last(n);
+            std::vector<double>  cur(n);
+            std::vector<uint8_t> has(n, 1);
+            for (size_t i = 0; i < n; ++i)
+            {
+                last[i] = static_cast<double>(i);
+                cur[i]  = static_cast<double>(i % 3 == 0 ? i + 1 : i);
+                has[i]  = i % 7 != 0;
+            }
+            check_all(last, cur, has, 1e-6);
+        }
+    });
+
+    run("random values", [] {
+        std::mt19937                           rng(7);
+        std::uniform_real_distribution<double> value(-1.0, 1.0);
+        std::uniform_int_distribution<int>     pick(0, 9);
+
+        const size_t         n = 10000;
+        std::vector<double>  last(n);
+        std::vector<double>  cur(n);
+        std::vector<uint8_t> has(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            last[i]     = value(rng);
+            const int p = pick(rng);
+            cur[i]      = p < 4 ? last[i] : p < 6 ? last[i] + value(rng) * 2e-6 : p < 7 ? k_nan : value(rng);
+            if (pick(rng) == 0)
+                last[i] = k_nan;
+            has[i] = pick(rng) != 0;
+        }
+        check_all(last, cur, has, 1e-6);
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,193 @@
+// lerp_channels, the kernel behind fsc::interp::physics, against the scalar lerp, lerp_180_deg and
+// lerp_360_deg it replaced (scalar_physics.h).
+#include "check.h"
+#include "scalar_physics.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <random>
+
+using fsc::protocol::levers;
+using fsc::protocol::physics;
+using fsc::test::run;
+using fsc::test::scalar_physics;
+
+namespace
+{
+// the double fields of physics, all of them channels
+constexpr size_t k_physics_fields = offsetof(physics, session_id) / sizeof(double);
+
+// bit for bit, except that a zero may come out with the other sign
+bool same(const double a, const double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0 || (a == 0.0 && b == 0.0);
+}
+
+// fields where the kernel and the scalar path differ
+size_t mismatches(const physics& a, const physics& b, const double t)
+{
+    physics k{};
+    physics s{};
+    fsc::interp::physics(a, b, t, k);
+    scalar_physics(a, b, t, s);
+
+    double kv[k_physics_fields];
+    double sv[k_physics_fields];
+    std::memcpy(kv, &k, sizeof(kv));
+    std::memcpy(sv, &s, sizeof(sv));
+
+    size_t n = 0;
+    for (size_t i = 0; i < k_physics_fields; ++i)
+        n += !same(kv[i], sv[i]);
+    return n;
+}
+
+void set_angles(physics& p, const double pitch, const double bank, const double hdg)
+{
+    p.pitch        = pitch;
+    p.bank         = bank;
+    p.hdg_deg_gyro = hdg;
+    p.hdg_deg_true = hdg;
+}
+
+// random linear fields, angles drawn by the caller
+physics random_physics(std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> any(-1e4, 1e4);
+    physics                                p{};
+    p.lat            = any(rng) * 1e-4;
+    p.lon            = any(rng) * 1e-4;
+    p.alt_feet       = any(rng) * 4;
+    p.vertical_speed = any(rng);
+    p.g_force        = any(rng) * 1e-3;
+    p.v_body_y       = any(rng);
+    p.v_body_z       = any(rng);
+    p.vx             = any(rng);
+    p.vz             = any(rng);
+    return p;
+}
+} // namespace
+
+int main()
+{
+    run("angles within one turn of their range are bit-identical", [] {
+        std::mt19937                           rng(19);
+        std::uniform_real_distribution<double> a180(-540.0, 540.0);
+        std::uniform_real_distribution<double> a360(-360.0, 720.0);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+        size_t bad = 0;
+        for (int i = 0; i < 200000; ++i)
+        {
+            physics a = random_physics(rng);
+            physics b = random_physics(rng);
+            set_angles(a, a180(rng), a180(rng), a360(rng));
+            set_angles(b, a180(rng), a180(rng), a360(rng));
+            a.hdg_deg_true = a360(rng);
+            b.hdg_deg_true = a360(rng);
+            bad += mismatches(a, b, unit(rng));
+        }
+        CHECK(bad == 0);
+    });
+
+    run("values on the seams are bit-identical", [] {
+        const double seams[] = {0.0, -0.0, 1e-20, -1e-20, 0.5, -0.5, 90.0, -90.0, 179.99999999999997, -179.99999999999997, 180.0, -180.0, 359.99999999999994, 360.0, -360.0, 540.0};
+        const double ts[]    = {0.0, 0.25, 0.5, 0.75, 1.0};
+
+        size_t bad = 0;
+        for (const double x : seams)
+            for (const double y : seams)
+                for (const double t : ts)
+                {
+                    physics a{};
+                    physics b{};
+                    set_angles(a, x, x, x);
+                    set_angles(b, y, y, y);
+                    bad += mismatches(a, b, t);
+                }
+        CHECK(bad == 0);
+    });
+
+    run("angles many turns out stay within an ulp", [] {
+        std::mt19937                           rng(23);
+        std::uniform_real_distribution<double> far(-1e5, 1e5);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+        double worst = 0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            physics a{};
+            physics b{};
+            set_angles(a, far(rng), far(rng), far(rng));
+            set_angles(b, far(rng), far(rng), far(rng));
+            const double t = unit(rng);
+
+            physics k{};
+            physics s{};
+            fsc::interp::physics(a, b, t, k);
+            scalar_physics(a, b, t, s);
+            for (const auto field : {&physics::pitch, &physics::bank, &physics::hdg_deg_gyro, &physics::hdg_deg_true})
+                worst = std::max(worst, std::fabs(fsc::interp::norm180(k.*field - s.*field)));
+        }
+        // an ulp of 1e5 is 1.5e-11, t scales it again
+        CHECK(worst < 1e-10);
+    });
+
+    run("levers lerp, flaps and gear hold the earlier sample", [] {
+        levers a{};
+        levers b{};
+        for (int i = 0; i < 4; ++i)
+        {
+            a.throttle[i]  = 10.0 * i;
+            b.throttle[i]  = 100.0 - i;
+            a.mixture[i]   = 100.0;
+            b.mixture[i]   = 50.0;
+            a.propeller[i] = 0.3 * i;
+            b.propeller[i] = 97.0;
+        }
+        a.spoilers      = 0;
+        b.spoilers      = 100;
+        a.elevator_trim = -0.1;
+        b.elevator_trim = 0.05;
+        a.flaps_index   = 1;
+        b.flaps_index   = 2;
+        a.gear_handle   = 1;
+        b.gear_handle   = 0;
+        a.time_ms       = 7;
+
+        const double t = 0.3;
+        levers       out{};
+        fsc::interp::lerp_channels(a, b, t, out);
+        for (int i = 0; i < 4; ++i)
+        {
+            CHECK(same(out.throttle[i], fsc::interp::lerp(a.throttle[i], b.throttle[i], t)));
+            CHECK(same(out.mixture[i], fsc::interp::lerp(a.mixture[i], b.mixture[i], t)));
+            CHECK(same(out.propeller[i], fsc::interp::lerp(a.propeller[i], b.propeller[i], t)));
+        }
+        CHECK(same(out.spoilers, fsc::interp::lerp(a.spoilers, b.spoilers, t)));
+        CHECK(same(out.elevator_trim, fsc::interp::lerp(a.elevator_trim, b.elevator_trim, t)));
+        CHECK(out.flaps_index == 1 && out.gear_handle == 1);
+        CHECK(out.time_ms == 0); // not a channel, left alone
+    });
+
+    run("out may be either input", [] {
+        std::mt19937 rng(29);
+        physics      a = random_physics(rng);
+        physics      b = random_physics(rng);
+        set_angles(a, 170.0, -175.0, 355.0);
+        set_angles(b, -170.0, 175.0, 5.0);
+
+        physics want{};
+        fsc::interp::physics(a, b, 0.4, want);
+
+        physics into_a = a;
+        fsc::interp::physics(into_a, b, 0.4, into_a);
+        physics into_b = b;
+        fsc::interp::physics(a, into_b, 0.4, into_b);
+        CHECK(std::memcmp(&into_a, &want, sizeof(double) * k_physics_fields) == 0);
+        CHECK(std::memcmp(&into_b, &want, sizeof(double) * k_physics_fields) == 0);
+    });
+
+    return fsc::test::finish();
+}
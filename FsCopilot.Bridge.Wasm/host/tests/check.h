@@ -0,0 +1,45 @@
+#pragma once
+// Checks for the host tests. CHECK records a failure and goes on, a test file runs its cases with
+// run() and returns finish() from main, which fails the ctest entry when any check failed.
+#include <cmath>
+#include <cstdio>
+
+namespace fsc::test
+{
+inline int& failures()
+{
+    static int n = 0;
+    return n;
+}
+
+inline void check(const bool ok, const char* expr, const char* file, const int line)
+{
+    if (ok)
+        return;
+    ++failures();
+    std::printf("%s:%d: CHECK(%s) failed\n", file, line, expr);
+}
+
+inline void check_near(const double a, const double b, const double eps, const char* expr, const char* file, const int line)
+{
+    if (std::fabs(a - b) <= eps)
+        return;
+    ++failures();
+    std::printf("%s:%d: CHECK_NEAR(%s) failed, %.17g vs %.17g\n", file, line, expr, a, b);
+}
+
+template <typename Fn> void run(const char* name, Fn fn)
+{
+    const int before = failures();
+    fn();
+    std::printf("%s %s\n", failures() == before ? "ok  " : "FAIL", name);
+}
+
+inline int finish()
+{
+    return failures() == 0 ? 0 : 1;
+}
+} // namespace fsc::test
+
+#define CHECK(expr) ::fsc::test::check((expr), #expr, __FILE__, __LINE__)
+#define CHECK_NEAR(a, b, eps) ::fsc::test::check_near((a), (b), (eps), #a ", " #b, __FILE__, __LINE__)
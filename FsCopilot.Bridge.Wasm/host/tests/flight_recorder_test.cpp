@@ -0,0 +1,284 @@
+// flight_recorder and flight_replay on real files, then a flight recorded through the module. Run
+// with --replay, a fresh module plays that recording back (flight_replay_test in CMakeLists.txt).
+#include "check.h"
+#include "flight_recorder.h"
+#include "protocol.h"
+
+#include <fsc_host.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace host = fsc::host;
+using fsc::test::run;
+
+namespace
+{
+constexpr auto k_unit_log   = "flight_recorder_unit.fscr";
+constexpr auto k_module_log = "flight_recorder_module.fscr"; // shared with the --replay run
+constexpr auto k_module_out = "flight_recorder_module.lat";  // latitude the module wrote each frame
+
+constexpr int    k_frames       = 180;
+constexpr int    k_samples      = 10;
+constexpr int    k_sample_every = 12; // frames, 0.2 s
+constexpr double k_frame        = 1.0 / 60.0;
+
+struct record
+{
+    uint32_t             id;
+    double               t;
+    uint16_t             size;
+    std::vector<uint8_t> payload;
+};
+
+std::vector<record> play_all(flight_replay& r, const double until = 1e9)
+{
+    std::vector<record> out;
+    r.play(until, [&](const uint32_t id, const double t, const void* data, const uint16_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        out.push_back({id, t, size, std::vector<uint8_t>(bytes, bytes + flight_log::k_max_payload)});
+    });
+    return out;
+}
+
+long file_size(const char* path)
+{
+    FILE* f = std::fopen(path, "rb");
+    if (f == nullptr)
+        return -1;
+    (void)std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    (void)std::fclose(f);
+    return size;
+}
+
+double lat_of(const record& r)
+{
+    fsc::protocol::physics p{};
+    std::memcpy(&p, r.payload.data(), sizeof(p));
+    return p.lat;
+}
+
+// one frame, returns the latitude the module has written so far, NaN before the first
+double tick()
+{
+    host::advance(k_frame);
+    Update_StandAlone(static_cast<float>(k_frame));
+    const auto it = host::vars().find("A:PLANE LATITUDE");
+    return it != host::vars().end() ? it->second : NAN;
+}
+
+int replay_through_module()
+{
+    run("a fresh module replays the recording and ignores the live stream", [] {
+        host::replay_path() = k_module_log;
+        module_init();
+
+        std::vector<double> recorded(k_frames);
+        FILE*               f = std::fopen(k_module_out, "rb");
+        CHECK(f != nullptr);
+        if (f == nullptr)
+            return;
+        CHECK(std::fread(recorded.data(), sizeof(double), recorded.size(), f) == recorded.size());
+        (void)std::fclose(f);
+
+        // a live stream of its own, none of it may show
+        fsc::protocol::physics live{};
+        live.session_id = 2;
+        live.lat        = 0.1;
+
+        // the recorded times went through the ns host clock, the first output frame may come one early
+        size_t differ = 0;
+        int    first = -1, first_recorded = -1;
+        for (int i = 0; i < k_frames; ++i)
+        {
+            if (i % k_sample_every == 0)
+            {
+                live.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+                host::deliver("FSC_PHYSICS", live);
+            }
+            const double lat = tick();
+            if (first < 0 && !std::isnan(lat))
+                first = i;
+            if (first_recorded < 0 && !std::isnan(recorded[i]))
+                first_recorded = i;
+            differ += !std::isnan(lat) && !std::isnan(recorded[i]) && lat != recorded[i];
+        }
+
+        CHECK(host::vars()["L:FSC_CONTROL"] == 2);
+        CHECK(first >= 0 && first_recorded >= 0 && std::abs(first - first_recorded) <= 1);
+        CHECK(differ == 0); // the same frames as the live run, to the bit
+        module_deinit();
+        (void)std::remove(k_module_log);
+        (void)std::remove(k_module_out);
+    });
+    return fsc::test::finish();
+}
+} // namespace
+
+int main(const int argc, char** argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--replay")
+        return replay_through_module();
+
+    run("records read back in order, trimmed and zero-filled", [] {
+        uint8_t big[300]{};
+        for (size_t i = 0; i < 200; ++i)
+            big[i] = static_cast<uint8_t>(i + 1);
+        const uint8_t small[4] = {9, 0, 7, 0};
+        const uint8_t zeros[8] = {};
+        {
+            flight_recorder rec;
+            CHECK(rec.open(k_unit_log));
+            rec.record(3, 0.5, big, sizeof(big));
+            rec.record(4, 1.0, small, sizeof(small));
+            rec.record(5, 2.0, zeros, sizeof(zeros));
+            CHECK(rec.records() == 3);
+        }
+
+        flight_replay r;
+        CHECK(r.open(k_unit_log));
+        CHECK(r.start() == 0.5);
+        const auto all = play_all(r);
+        CHECK(all.size() == 3 && !r.active());
+        if (all.size() != 3)
+            return;
+        CHECK(all[0].id == 3 && all[0].t == 0.5 && all[0].size == 200);
+        CHECK(std::memcmp(all[0].payload.data(), big, sizeof(big)) == 0);
+        CHECK(all[1].id == 4 && all[1].size == 3 && all[1].payload[0] == 9 && all[1].payload[2] == 7);
+        CHECK(all[2].id == 5 && all[2].size == 0);
+
+        size_t nonzero = 0;
+        for (const auto& rec : all)
+            for (size_t i = rec.size; i < rec.payload.size(); ++i)
+                nonzero += rec.payload[i] != 0;
+        CHECK(nonzero == 0);
+    });
+
+    run("play stops at the given recording time", [] {
+        flight_replay r;
+        CHECK(r.open(k_unit_log));
+        CHECK(play_all(r, 1.0).size() == 2 && r.active());
+        CHECK(play_all(r, 1.5).empty() && r.active());
+        CHECK(play_all(r, 2.0).size() == 1 && !r.active());
+    });
+
+    run("a full buffer is written out before the next record", [] {
+        uint8_t payload[1000];
+        {
+            flight_recorder rec;
+            CHECK(rec.open(k_unit_log));
+            for (int i = 0; i < 100; ++i)
+            {
+                std::memset(payload, i + 1, sizeof(payload));
+                rec.record(1, i, payload, sizeof(payload));
+            }
+        }
+
+        flight_replay r;
+        CHECK(r.open(k_unit_log));
+        const auto all = play_all(r);
+        CHECK(all.size() == 100);
+        size_t bad = 0;
+        for (size_t i = 0; i < all.size(); ++i)
+            bad += all[i].t != static_cast<double>(i) || all[i].size != sizeof(payload) || all[i].payload[999] != i + 1;
+        CHECK(bad == 0);
+    });
+
+    run("records reach the file once per k_flush_sec", [] {
+        flight_recorder rec;
+        CHECK(rec.open(k_unit_log));
+        const uint8_t one = 1;
+        rec.record(1, 0.0, &one, 1);
+        rec.flush(0.5);
+        CHECK(file_size(k_unit_log) == 0);
+        rec.flush(flight_recorder::k_flush_sec);
+        CHECK(file_size(k_unit_log) == static_cast<long>(8 + flight_log::k_header_size + 1));
+    });
+
+    run("payloads past k_max_payload are left out", [] {
+        std::vector<uint8_t> huge(flight_log::k_max_payload + 1, 1);
+        flight_recorder      rec;
+        CHECK(rec.open(k_unit_log));
+        rec.record(1, 0.0, huge.data(), huge.size());
+        CHECK(rec.records() == 0);
+    });
+
+    run("other files are refused, a cut record ends the replay", [] {
+        FILE* f = std::fopen(k_unit_log, "wb");
+        CHECK(f != nullptr);
+        (void)std::fwrite("FSCX\1\0\0\0", 1, 8, f);
+        (void)std::fclose(f);
+        flight_replay r;
+        CHECK(!r.open(k_unit_log));
+        CHECK(!r.open("no_such_file.fscr"));
+
+        {
+            flight_recorder rec;
+            CHECK(rec.open(k_unit_log));
+            const uint8_t payload[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+            rec.record(1, 0.0, payload, sizeof(payload));
+            rec.record(2, 1.0, payload, sizeof(payload));
+        }
+        std::vector<char> bytes(static_cast<size_t>(file_size(k_unit_log)));
+        f = std::fopen(k_unit_log, "rb");
+        (void)std::fread(bytes.data(), 1, bytes.size(), f);
+        (void)std::fclose(f);
+        f = std::fopen(k_unit_log, "wb");
+        (void)std::fwrite(bytes.data(), 1, bytes.size() - 5, f);
+        (void)std::fclose(f);
+
+        CHECK(r.open(k_unit_log));
+        const auto all = play_all(r);
+        CHECK(all.size() == 1 && all[0].id == 1 && !r.active());
+    });
+    (void)std::remove(k_unit_log);
+
+    run("the module records what it receives", [] {
+        host::record_path() = k_module_log;
+        module_init();
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        host::deliver("FSC_HELLO", fsc::protocol::str_msg{"1.7"}); // not part of the flight
+
+        fsc::protocol::physics p{};
+        p.session_id = 1;
+        std::vector<double> lat;
+        for (int i = 0; i < k_frames; ++i)
+        {
+            if (i % k_sample_every == 0 && i / k_sample_every < k_samples)
+            {
+                p.lat     = 0.5 + 0.01 * (i / k_sample_every);
+                p.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+                host::deliver("FSC_PHYSICS", p);
+            }
+            lat.push_back(tick());
+        }
+        module_deinit();
+
+        FILE* out = std::fopen(k_module_out, "wb");
+        CHECK(out != nullptr && std::fwrite(lat.data(), sizeof(double), lat.size(), out) == lat.size());
+        if (out != nullptr)
+            (void)std::fclose(out);
+
+        flight_replay r;
+        CHECK(r.open(k_module_log));
+        const auto all = play_all(r);
+        CHECK(all.size() == 1 + k_samples);
+        if (all.size() != 1 + k_samples)
+            return;
+        CHECK(all[0].id == host::area_id("FSC_CONTROL") && all[0].t == 0);
+        for (int i = 0; i < k_samples; ++i)
+        {
+            const auto& rec = all[1 + i];
+            CHECK(rec.id == host::area_id("FSC_PHYSICS"));
+            CHECK_NEAR(rec.t, i * k_sample_every * k_frame, 1e-6); // the host clock counts whole nanoseconds
+            CHECK(lat_of(rec) == 0.5 + 0.01 * i);
+        }
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,118 @@
+// frame_budget driving a deferred queue the way tick() does: items that each take a few
+// microseconds, a pass per frame that stops once the budget is spent and the next one resuming
+// from the first item left.
+#include "check.h"
+#include "frame_budget.h"
+
+#include <chrono>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+constexpr double k_budget_us = 2000.0;
+constexpr double k_item_us   = 20.0;
+
+void spin(const double us)
+{
+    const auto until = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::micro>(us));
+    while (clock::now() < until)
+    {
+    }
+}
+
+double elapsed_us(const clock::time_point since)
+{
+    return std::chrono::duration<double, std::micro>(clock::now() - since).count();
+}
+
+struct work
+{
+    size_t              next = 0;
+    std::vector<size_t> done; // item order across every pass
+
+    explicit work(const size_t items)
+        : items_(items)
+    {
+    }
+
+    size_t left() const
+    {
+        return items_ - next;
+    }
+
+    // one frame: the work every frame does, then the queue while the budget holds
+    void frame(frame_budget& budget, const double fixed_us = 0)
+    {
+        budget.begin();
+        spin(fixed_us);
+        if (left() > 0)
+        {
+            do
+            {
+                spin(k_item_us);
+                done.push_back(next++);
+            } while (left() > 0 && budget.left());
+        }
+        budget.end(static_cast<uint32_t>(left()));
+    }
+
+  private:
+    size_t items_;
+};
+} // namespace
+
+int main()
+{
+    run("a pass stops at the budget and the next resumes where it stopped", [] {
+        frame_budget budget(k_budget_us);
+        work         w(1000); // 20 ms of work, about ten frames
+
+        const auto start = clock::now();
+        w.frame(budget);
+        const double first_us = elapsed_us(start);
+        const size_t first    = w.done.size();
+        CHECK(first > 0 && first < 1000);
+        CHECK(first_us >= k_budget_us && first_us < 4 * k_budget_us); // the item under way finishes, the bound is loose for busy machines
+        CHECK(budget.stats().frames == 1 && budget.stats().overruns == 1 && budget.stats().carried == 1000 - first);
+
+        w.frame(budget);
+        CHECK(w.done.size() > first && w.done[first] == first);
+
+        uint32_t frames = 2;
+        while (w.left() > 0 && frames < 1000)
+        {
+            w.frame(budget);
+            ++frames;
+        }
+        bool in_order = w.done.size() == 1000;
+        for (size_t i = 0; in_order && i < w.done.size(); ++i)
+            in_order = w.done[i] == i;
+        CHECK(in_order);
+        CHECK(budget.stats().frames == frames && budget.stats().overruns == frames - 1 && budget.stats().carried == 0);
+    });
+
+    run("a frame over budget before the queue still takes one item", [] {
+        frame_budget budget(k_budget_us);
+        work         w(10);
+        w.frame(budget, 2 * k_budget_us);
+        CHECK(w.done.size() == 1 && budget.stats().carried == 9);
+
+        frame_budget none(0.0);
+        w.frame(none);
+        CHECK(w.done.size() == 2 && !none.left());
+    });
+
+    run("a frame with nothing deferred is not an overrun", [] {
+        frame_budget budget(k_budget_us);
+        work         w(0);
+        w.frame(budget);
+        w.frame(budget);
+        CHECK(budget.stats().frames == 2 && budget.stats().overruns == 0 && budget.stats().carried == 0);
+    });
+
+    return fsc::test::finish();
+}
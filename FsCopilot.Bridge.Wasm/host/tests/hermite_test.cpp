@@ -0,0 +1,201 @@
+// fsc::interp::hermite against flight paths known in closed form, with fsc::interp::linear as the
+// baseline it has to beat.
+#include "check.h"
+#include "interpolators.h"
+
+#include <algorithm>
+#include <random>
+
+using fsc::interp::k_earth_radius_ft;
+using fsc::interp::k_pi;
+using fsc::protocol::physics;
+using fsc::test::run;
+
+namespace
+{
+using sample = timed_sample<physics>;
+
+constexpr double k_deg = k_pi / 180.0;
+
+// A climbing coordinated turn: 200 ft/s ground speed at 3 deg/s, heading starting at 350 so it
+// crosses north, altitude, pitch and bank on slow sines. Velocities are what the packet carries,
+// the east one over the radius of the parallel the aircraft is on.
+physics turn(const double t)
+{
+    constexpr double speed = 200.0;
+    constexpr double rate  = 3.0 * k_deg;
+    constexpr double r     = speed / rate;
+    const double     track = 350.0 * k_deg + rate * t;
+
+    const double north = r * (std::sin(track) - std::sin(350.0 * k_deg));
+    const double east  = r * (std::cos(350.0 * k_deg) - std::cos(track));
+
+    physics p{};
+    p.lat            = 47.0 * k_deg + north / k_earth_radius_ft;
+    p.lon            = 8.0 * k_deg + east / (k_earth_radius_ft * std::cos(47.0 * k_deg));
+    p.alt_feet       = 3000.0 + 200.0 * std::sin(0.5 * t);
+    p.vertical_speed = 100.0 * std::cos(0.5 * t);
+    p.vz             = speed * std::cos(track);
+    p.vx             = speed * std::sin(track) * std::cos(p.lat) / std::cos(47.0 * k_deg);
+    p.pitch          = 5.0 * std::sin(0.7 * t);
+    p.bank           = 20.0 + 5.0 * std::sin(t);
+    p.hdg_deg_true   = fsc::interp::norm360(track / k_deg);
+    p.hdg_deg_gyro   = p.hdg_deg_true;
+    return p;
+}
+
+// horizontal distance in feet between two positions close to each other
+double distance_ft(const physics& a, const physics& b)
+{
+    const double north = (a.lat - b.lat) * k_earth_radius_ft;
+    const double east  = fsc::interp::wrap_pi(a.lon - b.lon) * k_earth_radius_ft * std::cos(a.lat);
+    return std::hypot(north, east);
+}
+
+double angle_error(const double a, const double b)
+{
+    return std::fabs(fsc::interp::norm180(a - b));
+}
+
+struct errors
+{
+    double position = 0;
+    double altitude = 0;
+    double heading  = 0;
+    double pitch    = 0;
+    double bank     = 0;
+
+    void add(const physics& got, const physics& want)
+    {
+        position = std::max(position, distance_ft(got, want));
+        altitude = std::max(altitude, std::fabs(got.alt_feet - want.alt_feet));
+        heading  = std::max(heading, angle_error(got.hdg_deg_true, want.hdg_deg_true));
+        pitch    = std::max(pitch, angle_error(got.pitch, want.pitch));
+        bank     = std::max(bank, angle_error(got.bank, want.bank));
+    }
+};
+
+// Streams the path through a buffer with policy Interp at uneven 0.22-0.35 s gaps and renders it at
+// 60 fps 0.4 s behind, the largest error against the path over 60 s.
+template <typename Interp> errors replay(physics (*path)(double))
+{
+    std::mt19937                           rng(11);
+    std::uniform_real_distribution<double> gap(0.22, 0.35);
+
+    stream_buffer<physics, Interp> buffer;
+    double                         next = 1.0;
+    errors                         e;
+    for (double now = 1.0; now < 61.0; now += 1.0 / 60.0)
+    {
+        if (now >= next)
+        {
+            buffer.push(next, path(next));
+            next += gap(rng);
+        }
+
+        physics      out{};
+        const double render = now - 0.4;
+        if (render > 1.0 && buffer.interpolate(render, out))
+            e.add(out, path(render));
+    }
+    return e;
+}
+
+sample at(const double t, physics (*path)(double))
+{
+    return {t, path(t)};
+}
+} // namespace
+
+int main()
+{
+    run("a climbing turn stays on the path", [] {
+        const errors h = replay<fsc::interp::hermite>(&turn);
+        const errors l = replay<fsc::interp::linear>(&turn);
+        std::printf("     hermite position %.2e ft, altitude %.2e ft, heading %.2e, pitch %.2e, bank %.2e deg\n", h.position, h.altitude, h.heading, h.pitch, h.bank);
+        std::printf("     linear  position %.2e ft, altitude %.2e ft, heading %.2e, pitch %.2e, bank %.2e deg\n", l.position, l.altitude, l.heading, l.pitch, l.bank);
+
+        // velocities are exact here, the cubic only misses by the fourth-order term
+        CHECK(h.position < 1e-4);
+        CHECK(h.altitude < 1e-3);
+        CHECK(h.heading < 1e-9);
+
+        // attitude has no rates in the packet, its slopes come from the neighbours
+        CHECK(h.pitch < 0.05 && h.pitch < l.pitch);
+        CHECK(h.bank < 0.1 && h.bank < l.bank);
+
+        // linear cuts the corners of the turn and the climb
+        CHECK(l.position > 1000 * h.position);
+        CHECK(l.altitude > 100 * h.altitude);
+    });
+
+    run("passes through the samples", [] {
+        const sample p0 = at(0.0, &turn);
+        const sample a  = at(0.25, &turn);
+        const sample b  = at(0.5, &turn);
+        const sample p3 = at(0.75, &turn);
+        physics      out{};
+
+        fsc::interp::hermite::blend(p0, a, b, p3, 0.0, out);
+        CHECK(distance_ft(out, a.value) < 1e-6);
+        CHECK_NEAR(out.alt_feet, a.value.alt_feet, 1e-9);
+        CHECK(angle_error(out.hdg_deg_true, a.value.hdg_deg_true) < 1e-9);
+
+        fsc::interp::hermite::blend(p0, a, b, p3, 1.0, out);
+        CHECK(distance_ft(out, b.value) < 1e-6);
+        CHECK_NEAR(out.alt_feet, b.value.alt_feet, 1e-9);
+        CHECK(angle_error(out.bank, b.value.bank) < 1e-9);
+    });
+
+    run("heading and bank take the short way across the wrap", [] {
+        sample p0 = at(0.0, &turn);
+        sample a  = at(0.25, &turn);
+        sample b  = at(0.5, &turn);
+        sample p3 = at(0.75, &turn);
+        p0.value.hdg_deg_true = 354.0;
+        a.value.hdg_deg_true  = 358.0;
+        b.value.hdg_deg_true  = 2.0;
+        p3.value.hdg_deg_true = 6.0;
+        p0.value.bank         = 174.0;
+        a.value.bank          = 178.0;
+        b.value.bank          = -178.0;
+        p3.value.bank         = -174.0;
+
+        physics out{};
+        fsc::interp::hermite::blend(p0, a, b, p3, 0.5, out);
+        CHECK_NEAR(out.hdg_deg_true, 0.0, 1e-9);
+        CHECK_NEAR(std::fabs(out.bank), 180.0, 1e-9);
+
+        fsc::interp::hermite::blend(p0, a, b, p3, 0.25, out);
+        CHECK_NEAR(out.hdg_deg_true, 359.0, 1e-9);
+        CHECK(out.hdg_deg_true >= 0.0 && out.hdg_deg_true < 360.0);
+        CHECK_NEAR(out.bank, 179.0, 1e-9);
+    });
+
+    run("longitude takes the short way across the antimeridian", [] {
+        sample a = at(0.25, &turn);
+        sample b = at(0.5, &turn);
+        a.value.lon = k_pi - 1e-7;
+        b.value.lon = -k_pi + 1e-7;
+        a.value.vx = b.value.vx = 2e-7 / 0.25 * k_earth_radius_ft * std::cos(a.value.lat);
+
+        physics out{};
+        fsc::interp::hermite::blend(a, a, b, b, 0.5, out);
+        CHECK(std::fabs(std::fabs(out.lon) - k_pi) < 1e-9);
+    });
+
+    run("longitude is lerped near the poles", [] {
+        sample a = at(0.25, &turn);
+        sample b = at(0.5, &turn);
+        a.value.lat = b.value.lat = k_pi / 2 - 1e-4;
+        a.value.lon = 0.1;
+        b.value.lon = 0.3;
+        a.value.vz = b.value.vz = 0;
+
+        physics out{};
+        fsc::interp::hermite::blend(a, a, b, b, 0.25, out);
+        CHECK_NEAR(out.lon, 0.15, 1e-12);
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,97 @@
+// log_ring stores entries in the frame and formats them on drain. A ring of four shows the wrap
+// and the overflow accounting without thousands of entries.
+#include "check.h"
+#include "log_ring.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+using lines = std::vector<std::pair<log_level, std::string>>;
+
+template <typename Ring> lines drain(Ring& ring, const size_t max = 100)
+{
+    lines out;
+    ring.drain(max, [&](const log_level level, const char* line) { out.emplace_back(level, line); });
+    return out;
+}
+} // namespace
+
+int main()
+{
+    run("arguments are formatted on drain, below MinLevel nothing is kept", [] {
+        log_ring<log_info, 4> ring;
+        ring.debug("not kept %d", 1);
+        CHECK(ring.size() == 0);
+
+        const std::string name = "L:FSC_TEST";
+        ring.info("plain");
+        ring.warn("%s = %.2f (%d, %u, %c)", name.c_str(), 1.5, -3, 7u, 'x');
+        ring.error("%s %s", "a", static_cast<const char*>(nullptr));
+        CHECK(ring.size() == 3);
+
+        const auto got = drain(ring);
+        CHECK(got == (lines{{log_info, "plain"}, {log_warn, "L:FSC_TEST = 1.50 (-3, 7, x)"}, {log_error, "a "}}));
+        CHECK(ring.size() == 0);
+    });
+
+    run("strings are copied when logged and cut at k_text_size", [] {
+        using ring_t = log_ring<log_debug, 4>;
+        ring_t      ring;
+        std::string s = "before";
+        ring.info("%s", s.c_str());
+        s = "after";
+
+        const std::string longer(300, 'l');
+        ring.info("%s|%s", longer.c_str(), "tail");
+        const auto got = drain(ring);
+        CHECK(got.size() == 2 && got[0].second == "before");
+        // the first string fills the text, the second one is left empty
+        CHECK(got.size() == 2 && got[1].second == std::string(ring_t::k_text_size - 1, 'l') + "|");
+    });
+
+    run("entries wrap around the ring and come out oldest first", [] {
+        log_ring<log_debug, 4> ring;
+        int                    next = 0;
+        std::vector<int>       seen;
+        ring.info("%d", next++);
+        for (int round = 0; round < 10; ++round) // one entry stays behind, so the slots shift each round
+        {
+            for (int i = 0; i < 3; ++i)
+                ring.info("%d", next++);
+            for (const auto& l : drain(ring, 3))
+                seen.push_back(std::stoi(l.second));
+            CHECK(ring.size() == 1);
+        }
+        for (const auto& l : drain(ring))
+            seen.push_back(std::stoi(l.second));
+
+        bool in_order = seen.size() == static_cast<size_t>(next);
+        for (size_t i = 0; in_order && i < seen.size(); ++i)
+            in_order = seen[i] == static_cast<int>(i);
+        CHECK(in_order);
+    });
+
+    run("a full ring drops new entries and reports them once drained", [] {
+        log_ring<log_debug, 4> ring;
+        for (int i = 0; i < 6; ++i)
+            ring.info("%d", i);
+        CHECK(ring.size() == 4);
+
+        // the report waits until the entries before it are out
+        auto got = drain(ring, 2);
+        CHECK(got == (lines{{log_info, "0"}, {log_info, "1"}}));
+        ring.info("%d", 6);
+        got = drain(ring);
+        CHECK(got == (lines{{log_info, "2"}, {log_info, "3"}, {log_info, "6"}, {log_warn, "Log ring full, 2 entries dropped"}}));
+
+        ring.info("%d", 7);
+        CHECK(drain(ring) == (lines{{log_info, "7"}}));
+    });
+
+    return fsc::test::finish();
+}
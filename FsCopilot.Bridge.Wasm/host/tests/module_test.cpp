@@ -0,0 +1,437 @@
+// wasm_module.cpp driven through its entry points and dispatch, the way the sim runs it. The
+// module keeps its state for the whole process, so the cases run in order and build on each other.
+#include "bridge_io.h"
+#include "check.h"
+
+#include <fsc_host.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace host = fsc::host;
+using fsc::test::run;
+
+namespace
+{
+void tick(const double dt = 0.02)
+{
+    host::advance(dt);
+    Update_StandAlone(static_cast<float>(dt));
+}
+
+std::vector<fsc::protocol::var_ack> acks()
+{
+    std::vector<fsc::protocol::var_ack> out;
+    for (const auto* w : host::writes("FSC_WATCH_ACK"))
+    {
+        fsc::protocol::var_acks msg{};
+        std::memcpy(&msg, w->data.data(), sizeof(msg));
+        out.insert(out.end(), msg.acks, msg.acks + msg.count);
+    }
+    return out;
+}
+
+// values of every batch sent since the last clear_sent(), later batches win
+std::map<uint16_t, double> batches()
+{
+    std::map<uint16_t, double> values;
+    for (const auto* w : host::writes("FSC_VARIABLE_BATCH"))
+    {
+        fsc::protocol::var_batch msg{};
+        std::memcpy(&msg, w->data.data(), sizeof(msg));
+        for (const auto& v : fsc::test::read_batch(msg))
+            values[v.first] = v.second;
+    }
+    return values;
+}
+
+// the snapshot parts sent since the last clear_sent()
+size_t snapshots()
+{
+    return host::writes("FSC_VARIABLE_SNAPSHOT").size();
+}
+
+// var_watcher::set_hash of a watch set, the way SimClient.WatchSetHash computes it for the hello
+uint64_t watch_set_hash(std::initializer_list<std::pair<const char*, const char*>> watches)
+{
+    uint64_t sum = 0;
+    for (const auto& [name, units] : watches)
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (const char* c = name; *c != '\0'; ++c)
+            h = (h ^ static_cast<uint8_t>(*c)) * 1099511628211ull;
+        h *= 1099511628211ull;
+        for (const char* c = units; *c != '\0'; ++c)
+            h = (h ^ static_cast<uint8_t>(*c)) * 1099511628211ull;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        sum += h;
+    }
+    return sum;
+}
+
+uint32_t handle = 0;
+} // namespace
+
+int main()
+{
+    module_init();
+
+    run("init announces the bridge version", [] {
+        fsc::protocol::str_msg ready{};
+        CHECK(host::last_write("FSC_READY", ready));
+        CHECK(std::string(ready.msg) == "1.7");
+        CHECK(host::area_id("FSC_WATCH_H") != SIMCONNECT_UNUSED);
+    });
+
+    run("watched variable is acked and sent when it changes", [] {
+        host::vars()["L:FSC_TEST_A"] = 3;
+        host::deliver("FSC_HELLO", fsc::test::str("1.7"));
+        host::deliver("FSC_WATCH_H", fsc::test::watch_msg(7, "L:FSC_TEST_A", "Number"));
+        host::clear_sent();
+        tick(); // registrations run after the poll, the value follows on the next tick
+        tick();
+
+        const auto a = acks();
+        CHECK(a.size() == 1 && a[0].tag == 7 && a[0].handle != 0xFFFFFFFF);
+        handle = a.empty() ? 0 : a[0].handle;
+        CHECK(batches()[static_cast<uint16_t>(handle)] == 3);
+
+        host::clear_sent();
+        tick();
+        CHECK(batches().empty());
+
+        host::vars()["L:FSC_TEST_A"] = 4.5;
+        tick();
+        CHECK(batches()[static_cast<uint16_t>(handle)] == 4.5);
+    });
+
+    run("set by handle runs through the calculator", [] {
+        host::clear_sent();
+        host::deliver("FSC_SET_H", fsc::protocol::var_value{handle, 9});
+        tick();
+        CHECK(host::vars()["L:FSC_TEST_A"] == 9);
+        CHECK(!host::sent().calculator.empty());
+    });
+
+    run("control packet takes control of the aircraft", [] {
+        host::clear_sent();
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        CHECK(host::vars()["L:FSC_CONTROL"] == 2);
+        CHECK(host::vars()["K:FREEZE_ALTITUDE_SET"] == 1);
+    });
+
+    run("physics is written by data definition until the sim rejects it", [] {
+        fsc::protocol::physics p{};
+        p.session_id = 1;
+        p.lat        = 0.8;
+        auto stream  = [&] {
+            for (int i = 0; i < 60; ++i)
+            {
+                if (i % 15 == 0)
+                {
+                    p.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+                    host::deliver("FSC_PHYSICS", p);
+                }
+                tick(1.0 / 60.0);
+            }
+        };
+
+        host::clear_sent();
+        stream();
+        const DWORD physics_set = host::definition_of("PLANE LATITUDE");
+        DWORD       probe       = 0;
+        for (const auto& w : host::sent().object_data)
+            if (w.def == physics_set && probe == 0)
+                probe = w.packet;
+        CHECK(probe != 0);
+        CHECK(host::vars()["A:PLANE LATITUDE"] == 0.8);
+
+        // a rejection of some other packet changes nothing
+        host::deliver_exception(SIMCONNECT_EXCEPTION_DATA_ERROR, probe + 1000);
+        host::clear_sent();
+        stream();
+        CHECK(!host::sent().object_data.empty());
+
+        host::deliver_exception(SIMCONNECT_EXCEPTION_DATA_ERROR, probe);
+        host::clear_sent();
+        p.lat = 0.5;
+        stream();
+        size_t physics_writes = 0;
+        for (const auto& w : host::sent().object_data)
+            physics_writes += w.def == physics_set;
+        CHECK(physics_writes == 0);
+        CHECK(!host::sent().calculator.empty() && host::sent().calculator.back().find("(>A:PLANE LATITUDE, Radians)") != std::string::npos);
+        CHECK_NEAR(host::vars()["A:PLANE LATITUDE"], 0.5, 1e-9);
+    });
+
+    run("a new session takes over with a cross-fade, not a jump", [] {
+        fsc::protocol::physics old_p{};
+        old_p.session_id = 10;
+        old_p.lat        = 0.5;
+        fsc::protocol::physics new_p{};
+        new_p.session_id = 11;
+        new_p.lat        = 0.6;
+
+        double last  = 0;
+        double step  = 0;
+        size_t mixed = 0;
+        for (int i = 0; i < 6 * 60; ++i)
+        {
+            if (i % 12 == 0)
+            {
+                old_p.time_ms = new_p.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+                host::deliver("FSC_PHYSICS", old_p);
+                if (i >= 3 * 60) // the peer reconnects with a new session, the old one still sends
+                    host::deliver("FSC_PHYSICS", new_p);
+            }
+            tick(1.0 / 60.0);
+
+            const double lat = host::vars()["A:PLANE LATITUDE"];
+            if (i == 3 * 60 - 1)
+                CHECK_NEAR(lat, 0.5, 1e-9);
+            if (i >= 3 * 60)
+                step = std::max(step, std::fabs(lat - last));
+            mixed += lat > 0.51 && lat < 0.59;
+            last = lat;
+        }
+
+        // smoothstep over k_crossfade_sec moves at most 1.5 * 0.1 / 30 a frame, twice that after a
+        // frame the new session's buffer holds
+        CHECK(step < 0.011);
+        CHECK(mixed >= 10);
+        CHECK_NEAR(last, 0.6, 1e-9);
+    });
+
+    run("levers write only the channels that changed", [] {
+        fsc::protocol::physics p{};
+        fsc::protocol::levers  l{};
+        p.session_id = l.session_id = 1;
+        for (int i = 0; i < 4; ++i)
+        {
+            l.throttle[i]  = 20;
+            l.mixture[i]   = 100;
+            l.propeller[i] = 90;
+        }
+        l.mixture[2] = l.mixture[3] = std::numeric_limits<double>::quiet_NaN(); // left to the aircraft
+        l.flaps_index                = 1;
+        l.gear_handle                = 1;
+
+        const DWORD first  = host::definition_of("GENERAL ENG THROTTLE LEVER POSITION:1");
+        auto        stream = [&](const double throttle_step) {
+            host::clear_sent();
+            for (int i = 0; i < 60; ++i)
+            {
+                if (i % 15 == 0)
+                {
+                    p.time_ms = l.time_ms = static_cast<uint32_t>(host::time() * 1000.0);
+                    host::deliver("FSC_PHYSICS", p);
+                    host::deliver("FSC_LEVERS", l);
+                    l.throttle[0] += throttle_step;
+                }
+                tick(1.0 / 60.0);
+            }
+            std::map<DWORD, size_t> writes;
+            for (const auto& w : host::sent().object_data)
+                if (w.def >= first && w.def < first + 16)
+                    ++writes[w.def - first];
+            return writes;
+        };
+
+        auto writes = stream(0);
+        CHECK(writes.size() == 14 && writes.count(6) == 0 && writes.count(7) == 0);
+        CHECK(host::vars()["A:GEAR HANDLE POSITION"] == 1 && host::vars()["A:FLAPS HANDLE INDEX"] == 1);
+        CHECK(host::vars().count("A:GENERAL ENG MIXTURE LEVER POSITION:3") == 0);
+
+        writes = stream(10);
+        CHECK(writes.size() == 1 && writes[0] > 1);
+        CHECK(host::vars()["A:GENERAL ENG THROTTLE LEVER POSITION:1"] > 20);
+    });
+
+    run("a write the calculator fails leaves the others in its frame", [] {
+        auto set = [](const char* name, const double value) {
+            fsc::protocol::var_set msg{};
+            std::strncpy(msg.name, name, sizeof(msg.name) - 1);
+            msg.value = value;
+            host::deliver("FSC_SET", msg);
+        };
+
+        host::fail_calculator_on("L:FSC_TEST_BROKEN");
+        host::clear_sent();
+        set("L:FSC_TEST_B", 5);
+        set("L:FSC_TEST_BROKEN", 6);
+        set("L:FSC_TEST_C", std::numeric_limits<double>::quiet_NaN());
+        set("L:FSC_TEST_D", 7);
+        tick();
+        host::fail_calculator_on("");
+
+        CHECK(host::vars()["L:FSC_TEST_B"] == 5 && host::vars()["L:FSC_TEST_D"] == 7);
+        CHECK(host::vars().count("L:FSC_TEST_BROKEN") == 0 && host::vars().count("L:FSC_TEST_C") == 0);
+        size_t programs = 0;
+        for (const auto& c : host::sent().calculator)
+            programs += c.find("L:FSC_TEST_") != std::string::npos;
+        CHECK(programs == 4); // the joined program, then each write alone
+    });
+
+    run("a watch list snapshot holds back only the deltas of its own variables", [] {
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        host::vars()["L:FSC_TEST_A"] = 10;
+        host::vars()["L:FSC_TEST_E"] = 11;
+        tick();
+
+        fsc::protocol::var_watch_list list{};
+        size_t                        used = 0;
+        list.id                            = 5;
+        list.last                          = 1;
+        CHECK(fsc::test::add_watch(list, used, 20, fsc::protocol::watch_poll, fsc::protocol::rate_every_frame, "L:FSC_TEST_E", "Number"));
+        host::clear_sent();
+        host::deliver("FSC_WATCH_LIST", list);
+        tick();
+        tick();
+
+        const auto a = acks();
+        CHECK(a.size() == 1 && a[0].tag == 20);
+        const auto e = static_cast<uint16_t>(a.empty() ? 0 : a[0].handle);
+
+        std::map<uint16_t, double> snapshot;
+        for (const auto* w : host::writes("FSC_VARIABLE_SNAPSHOT"))
+        {
+            fsc::protocol::var_snapshot msg{};
+            std::memcpy(&msg, w->data.data(), sizeof(msg));
+            CHECK(msg.id == 5 && msg.last == 1);
+            snapshot = fsc::test::read_batch(msg.batch);
+        }
+        CHECK(snapshot.size() == 1 && snapshot[e] == 11);
+
+        // the bound variable goes on while the snapshot waits for its ack
+        host::vars()["L:FSC_TEST_A"] = 12;
+        host::vars()["L:FSC_TEST_E"] = 13;
+        host::clear_sent();
+        tick();
+        auto values = batches();
+        CHECK(values.size() == 1 && values[static_cast<uint16_t>(handle)] == 12);
+
+        host::deliver("FSC_SNAPSHOT_ACK", fsc::protocol::var_snapshot_ack{5});
+        host::clear_sent();
+        tick();
+        values = batches();
+        CHECK(values.size() == 1 && values[e] == 13);
+    });
+
+    run("a hello with another watch set drops the old watches", [] {
+        host::deliver("FSC_HELLO", fsc::test::str("1.7"));
+        host::vars()["L:FSC_TEST_A"] = 20;
+        host::vars()["L:FSC_TEST_E"] = 21;
+        host::clear_sent();
+        tick();
+        tick();
+        CHECK(batches().empty());
+
+        host::deliver("FSC_WATCH_H", fsc::test::watch_msg(7, "L:FSC_TEST_A", "Number"));
+        tick();
+        tick();
+        const auto a = acks();
+        CHECK(a.size() == 1 && a[0].handle == handle);
+        const auto values = batches();
+        CHECK(values.size() == 1 && values.at(static_cast<uint16_t>(handle)) == 20);
+    });
+
+    run("a watch list resent after a lost ack is acked again without a snapshot", [] {
+        fsc::protocol::var_watch_list list{};
+        size_t                        used = 0;
+        list.id                            = 6;
+        list.last                          = 1;
+        CHECK(fsc::test::add_watch(list, used, 30, fsc::protocol::watch_poll, fsc::protocol::rate_every_frame, "L:FSC_TEST_F", "Number"));
+        host::vars()["L:FSC_TEST_F"] = 22;
+        host::clear_sent();
+        host::deliver("FSC_WATCH_LIST", list);
+        tick();
+        tick();
+        auto a = acks();
+        CHECK(a.size() == 1 && snapshots() == 1);
+        const uint32_t f = a.empty() ? 0 : a[0].handle;
+        host::deliver("FSC_SNAPSHOT_ACK", fsc::protocol::var_snapshot_ack{6});
+        tick();
+
+        list.id = 7;
+        host::clear_sent();
+        host::deliver("FSC_WATCH_LIST", list);
+        tick();
+        tick();
+        a = acks();
+        CHECK(a.size() == 1 && a[0].handle == f);
+        CHECK(snapshots() == 0 && batches().empty());
+    });
+
+    run("a hello with the same watch set rebinds and sends only what changed", [] {
+        // control lost, A changes while the watches are dormant
+        const int32_t in_control[5] = {0, 0, 0, 0, 2};
+        const int32_t released[5]   = {};
+        host::deliver_object_data("IS LATITUDE LONGITUDE FREEZE ON", in_control, sizeof(in_control), 5);
+        tick(1.5);
+        host::deliver_object_data("IS LATITUDE LONGITUDE FREEZE ON", released, sizeof(released), 5);
+        host::vars()["L:FSC_TEST_A"] = 40;
+
+        // the app reconnects, hashes the set it holds values for and binds all of it again
+        char hello[64];
+        std::snprintf(hello, sizeof(hello), "1.7 %016llx", static_cast<unsigned long long>(watch_set_hash({{"L:FSC_TEST_A", "Number"}, {"L:FSC_TEST_F", "Number"}})));
+        fsc::protocol::var_watch_list list{};
+        size_t                        used = 0;
+        list.id                            = 8;
+        list.last                          = 1;
+        CHECK(fsc::test::add_watch(list, used, 7, fsc::protocol::watch_poll, fsc::protocol::rate_every_frame, "L:FSC_TEST_A", "Number"));
+        CHECK(fsc::test::add_watch(list, used, 30, fsc::protocol::watch_poll, fsc::protocol::rate_every_frame, "L:FSC_TEST_F", "Number"));
+        host::clear_sent();
+        host::deliver("FSC_HELLO", fsc::test::str(hello));
+        host::deliver("FSC_WATCH_LIST", list);
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        tick();
+        tick();
+
+        const auto a = acks();
+        CHECK(a.size() == 2 && a[0].tag == 7 && a[0].handle == handle && a[1].tag == 30);
+        CHECK(snapshots() == 0);
+        const auto values = batches();
+        CHECK(values.size() == 1 && values.at(static_cast<uint16_t>(handle)) == 40);
+    });
+
+    run("watches are dropped once control is gone for a minute", [] {
+        const int32_t in_control[5] = {0, 0, 0, 0, 2};
+        const int32_t released[5]   = {};
+        host::deliver_object_data("IS LATITUDE LONGITUDE FREEZE ON", in_control, sizeof(in_control), 5);
+        tick(1.5);
+        CHECK(host::vars()["L:FSC_CONTROL"] == 0);
+        host::deliver_object_data("IS LATITUDE LONGITUDE FREEZE ON", released, sizeof(released), 5); // the sim reports the write back
+
+        tick(60.0); // k_dormant_sec after the last control packet
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        host::vars()["L:FSC_TEST_A"] = 30;
+        host::clear_sent();
+        tick();
+        tick();
+        CHECK(batches().empty());
+    });
+
+    run("hot path stats are published once a second", [] {
+        tick(1.0); // starts a fresh interval
+        host::clear_sent();
+        host::deliver("FSC_CONTROL", fsc::protocol::control{2});
+        tick(1.0);
+
+        fsc::protocol::bridge_stats s{};
+        CHECK(host::last_write("FSC_STATS", s));
+        CHECK(s.seq > 1 && s.interval_ms == 1000);
+        CHECK(s.counters[fsc::protocol::counter_control] == 1);
+        CHECK(s.timers[fsc::protocol::timer_dispatch].count >= 1);
+    });
+
+    module_deinit();
+    return fsc::test::finish();
+}
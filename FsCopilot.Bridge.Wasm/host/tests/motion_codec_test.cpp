@@ -0,0 +1,274 @@
+// motion_decoder against the app's encoder (motion_encoder.h): round-trip error bounds, frame sizes,
+// lost and truncated frames.
+#include "check.h"
+#include "motion_encoder.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+using fsc::protocol::k_physics_fields;
+using fsc::protocol::k_physics_scale;
+using fsc::protocol::motion_decoder;
+using fsc::protocol::physics;
+using fsc::protocol::surfaces;
+using fsc::test::motion_encoder;
+using fsc::test::motion_frame;
+using fsc::test::run;
+
+namespace
+{
+// a climbing turn with some turbulence on attitude and g, sampled at t seconds
+physics flight(const double t)
+{
+    physics p{};
+    p.lat            = 0.8203 + 2e-6 * std::sin(0.05 * t);
+    p.lon            = 0.1396 + 3e-6 * (1 - std::cos(0.05 * t));
+    p.alt_feet       = 3000 + 12.5 * t;
+    p.pitch          = 4 + 0.8 * std::sin(1.3 * t);
+    p.bank           = -25 + 1.5 * std::sin(2.1 * t);
+    p.hdg_deg_gyro   = std::fmod(350 + 3 * t, 360.0);
+    p.hdg_deg_true   = std::fmod(352 + 3 * t, 360.0);
+    p.vertical_speed = 12.5 + 0.3 * std::sin(0.7 * t);
+    p.g_force        = 1.1 + 0.05 * std::sin(5.0 * t);
+    p.v_body_y       = 0.4 * std::sin(0.9 * t);
+    p.v_body_z       = 200 + std::sin(0.2 * t);
+    p.vx             = 200 * std::sin(0.05 * t);
+    p.vz             = 200 * std::cos(0.05 * t);
+    p.session_id     = 0x1234'5678'9ABC'DEF0ull;
+    p.time_ms        = static_cast<uint32_t>(t * 1000);
+    return p;
+}
+
+// largest error of each field in quanta
+struct bounds
+{
+    double quanta[k_physics_fields]{};
+
+    void add(const physics& got, const physics& want)
+    {
+        double g[k_physics_fields];
+        double w[k_physics_fields];
+        std::memcpy(g, &got, sizeof(g));
+        std::memcpy(w, &want, sizeof(w));
+        for (size_t i = 0; i < k_physics_fields; ++i)
+            quanta[i] = std::max(quanta[i], std::fabs(g[i] - w[i]) * k_physics_scale[i]);
+    }
+
+    double worst() const
+    {
+        return *std::max_element(std::begin(quanta), std::end(quanta));
+    }
+};
+
+uint8_t decode(motion_decoder& d, const motion_frame& f, physics& p)
+{
+    surfaces s{};
+    return d.decode(f.data, f.size, p, s);
+}
+
+// frames written by hand, for values the encoder never produces
+struct frame_writer
+{
+    motion_frame f{};
+
+    void put(const void* src, const size_t size)
+    {
+        std::memcpy(f.data + f.size, src, size);
+        f.size += size;
+    }
+
+    void varint(uint64_t v)
+    {
+        for (; v >= 0x80; v >>= 7)
+            f.data[f.size++] = static_cast<uint8_t>(v | 0x80);
+        f.data[f.size++] = static_cast<uint8_t>(v);
+    }
+
+    void zigzag(const int64_t v)
+    {
+        varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+};
+
+// a physics keyframe with every field at q
+motion_frame physics_key(const uint16_t seq, const int64_t q)
+{
+    frame_writer   w;
+    const uint8_t  header     = fsc::protocol::motion_physics | fsc::protocol::motion_key;
+    const uint64_t session_id = 1;
+    const uint32_t time_ms    = 0;
+    w.put(&header, 1);
+    w.put(&seq, 2);
+    w.put(&session_id, 8);
+    w.put(&time_ms, 4);
+    for (size_t i = 0; i < k_physics_fields; ++i)
+        w.zigzag(q);
+    return w.f;
+}
+
+// a physics delta moving the first field by d
+motion_frame physics_delta(const uint16_t seq, const uint16_t key_seq, const int64_t d)
+{
+    frame_writer   w;
+    const uint8_t  header = fsc::protocol::motion_physics;
+    const uint16_t mask   = 1;
+    w.put(&header, 1);
+    w.put(&seq, 2);
+    w.put(&key_seq, 2);
+    w.varint(20);
+    w.put(&mask, 2);
+    w.zigzag(d);
+    return w.f;
+}
+} // namespace
+
+int main()
+{
+    run("physics round trip stays within half a quantum", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        bounds         b;
+        size_t         bytes = 0;
+        size_t         keys  = 0;
+        const int      n     = 60 * 30;
+        for (int i = 0; i < n; ++i)
+        {
+            const physics      want = flight(i / 30.0);
+            const motion_frame f    = enc.encode(want);
+            bytes += f.size;
+            keys += (f.data[0] & fsc::protocol::motion_key) != 0;
+
+            physics got{};
+            CHECK(decode(dec, f, got) == fsc::protocol::motion_physics);
+            CHECK(got.session_id == want.session_id && got.time_ms == want.time_ms);
+            b.add(got, want);
+        }
+        std::printf("     %.1f bytes per frame (%zu keyframes), %.0f B/s at 30 Hz, worst error %.3f quanta\n", static_cast<double>(bytes) / n, keys,
+                    static_cast<double>(bytes) / 60, b.worst());
+
+        CHECK(b.worst() <= 0.5 + 1e-6);
+        CHECK(keys == 60);
+        CHECK(static_cast<double>(bytes) / n < 40);
+        CHECK(dec.stats().frames == static_cast<uint32_t>(n) && dec.stats().lost == 0 && dec.stats().dropped == 0);
+    });
+
+    run("surfaces are exact", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        for (int i = 0; i < 100; ++i)
+        {
+            const surfaces want{-16384 + i * 300, i * i - 2000, (i % 7) * -4000, 42, static_cast<uint32_t>(i * 33)};
+            const auto     f = enc.encode(want);
+            physics        p{};
+            surfaces       got{};
+            CHECK(dec.decode(f.data, f.size, p, got) == fsc::protocol::motion_surfaces);
+            CHECK(got.ail_pos == want.ail_pos && got.elev_pos == want.elev_pos && got.rud_pos == want.rud_pos);
+            CHECK(got.session_id == 42 && got.time_ms == want.time_ms);
+        }
+    });
+
+    run("a lost delta is counted and the next one still decodes", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        physics        got{};
+        CHECK(decode(dec, enc.encode(flight(0.0)), got) != 0);
+        (void)enc.encode(flight(0.1)); // lost
+        (void)enc.encode(flight(0.2)); // lost
+        CHECK(decode(dec, enc.encode(flight(0.3)), got) == fsc::protocol::motion_physics);
+        CHECK(dec.stats().lost == 2);
+        CHECK_NEAR(got.alt_feet, flight(0.3).alt_feet, 0.5 / k_physics_scale[2] + 1e-9);
+    });
+
+    run("deltas without their keyframe are dropped until the next one", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        physics        got{};
+        (void)enc.encode(flight(0.0)); // keyframe lost
+        size_t dropped = 0;
+        for (int i = 1; i < 10; ++i)
+            dropped += decode(dec, enc.encode(flight(i / 10.0)), got) == 0;
+        CHECK(dropped == 9 && dec.stats().dropped == 9);
+        CHECK(decode(dec, enc.encode(flight(1.05)), got) == fsc::protocol::motion_physics); // a second after, a keyframe
+        CHECK(decode(dec, enc.encode(flight(1.1)), got) == fsc::protocol::motion_physics);
+    });
+
+    run("a new session starts with a keyframe", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        physics        got{};
+        physics        p = flight(0.0);
+        CHECK(decode(dec, enc.encode(p), got) != 0);
+        p.session_id = 7;
+        p.time_ms += 20;
+        const auto f = enc.encode(p);
+        CHECK((f.data[0] & fsc::protocol::motion_key) != 0);
+        CHECK(decode(dec, f, got) != 0 && got.session_id == 7);
+    });
+
+    run("sequence numbers wrap without counting losses", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        physics        got{};
+        for (int i = 0; i < 70000; ++i)
+            (void)decode(dec, enc.encode(flight(i / 30.0)), got);
+        CHECK(dec.stats().lost == 0 && dec.stats().dropped == 0);
+    });
+
+    run("truncated and unknown frames decode to nothing", [] {
+        motion_encoder     enc;
+        const motion_frame key   = enc.encode(flight(0.0));
+        const motion_frame delta = enc.encode(flight(0.1));
+        for (const auto* f : {&key, &delta})
+        {
+            for (size_t size = 0; size < f->size; ++size)
+            {
+                motion_decoder dec;
+                physics        got{};
+                surfaces       s{};
+                if (f == &delta)
+                    (void)dec.decode(key.data, key.size, got, s);
+                CHECK(dec.decode(f->data, size, got, s) == 0);
+            }
+        }
+
+        motion_frame bad = key;
+        bad.data[0]      = 0x83;
+        motion_decoder dec;
+        physics        got{};
+        CHECK(decode(dec, bad, got) == 0 && dec.stats().dropped == 1);
+    });
+
+    run("values and deltas past k_max_quantum drop the frame", [] {
+        using fsc::protocol::k_max_quantum;
+        motion_decoder dec;
+        physics        got{};
+
+        CHECK(decode(dec, physics_key(0, std::numeric_limits<int64_t>::max()), got) == 0);
+        CHECK(decode(dec, physics_key(1, -k_max_quantum - 1), got) == 0);
+        CHECK(dec.stats().dropped == 2);
+
+        CHECK(decode(dec, physics_key(2, k_max_quantum), got) == fsc::protocol::motion_physics);
+        CHECK(decode(dec, physics_delta(3, 2, std::numeric_limits<int64_t>::max()), got) == 0);
+        CHECK(decode(dec, physics_delta(4, 2, std::numeric_limits<int64_t>::min()), got) == 0);
+        CHECK(decode(dec, physics_delta(5, 2, 1), got) == 0); // the sum leaves the range
+        CHECK(dec.stats().dropped == 5);
+
+        // the keyframe is still good for deltas that stay in range
+        CHECK(decode(dec, physics_delta(6, 2, -k_max_quantum), got) == fsc::protocol::motion_physics);
+        CHECK(got.lat == 0 && got.lon == static_cast<double>(k_max_quantum) / k_physics_scale[1]);
+    });
+
+    run("non-finite values are sent as zero", [] {
+        motion_encoder enc;
+        motion_decoder dec;
+        physics        p = flight(0.0);
+        p.pitch          = std::numeric_limits<double>::quiet_NaN();
+        p.g_force        = std::numeric_limits<double>::infinity();
+        physics got{};
+        CHECK(decode(dec, enc.encode(p), got) != 0);
+        CHECK(got.pitch == 0 && got.g_force == 0);
+    });
+
+    return fsc::test::finish();
+}
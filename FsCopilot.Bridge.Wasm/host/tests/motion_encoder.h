@@ -0,0 +1,123 @@
+#pragma once
+// MotionEncoder of the desktop app (FsCopilot/Simulation/Motion.cs) line for line, so the host tests
+// and benchmarks can make the frames motion_decoder reads. Keep the two in step.
+#include "motion_codec.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace fsc::test
+{
+struct motion_frame
+{
+    uint8_t data[255];
+    size_t  size;
+};
+
+class motion_encoder
+{
+  public:
+    static constexpr uint32_t k_key_interval_ms = 1000;
+
+    motion_frame encode(const protocol::physics& p)
+    {
+        int64_t q[protocol::k_physics_fields];
+        double  v[protocol::k_physics_fields];
+        std::memcpy(v, &p, sizeof(v));
+        for (size_t i = 0; i < protocol::k_physics_fields; ++i)
+            q[i] = quantize(v[i], i);
+        return encode(physics_, protocol::motion_physics, p.session_id, p.time_ms, q, protocol::k_physics_fields);
+    }
+
+    motion_frame encode(const protocol::surfaces& s)
+    {
+        const int64_t q[protocol::k_surfaces_fields] = {s.ail_pos, s.elev_pos, s.rud_pos};
+        return encode(surfaces_, protocol::motion_surfaces, s.session_id, s.time_ms, q, protocol::k_surfaces_fields);
+    }
+
+  private:
+    struct key_state
+    {
+        int64_t  values[protocol::k_physics_fields]{};
+        bool     has_key    = false;
+        uint16_t seq        = 0;
+        uint16_t key_seq    = 0;
+        uint64_t session_id = 0;
+        uint32_t time_ms    = 0;
+    };
+
+    key_state physics_;
+    key_state surfaces_;
+
+    // Math.Round, ties to even
+    static int64_t quantize(const double value, const size_t field)
+    {
+        return std::isfinite(value) ? static_cast<int64_t>(std::nearbyint(value * protocol::k_physics_scale[field])) : 0;
+    }
+
+    static motion_frame encode(key_state& st, const uint8_t kind, const uint64_t session_id, const uint32_t time_ms, const int64_t* q, const size_t n)
+    {
+        motion_frame f{};
+        auto         put = [&](const void* src, const size_t size) {
+            std::memcpy(f.data + f.size, src, size);
+            f.size += size;
+        };
+
+        const uint16_t seq = st.seq++;
+        const bool     key = !st.has_key || st.session_id != session_id || time_ms - st.time_ms >= k_key_interval_ms;
+
+        f.data[f.size++] = static_cast<uint8_t>(kind | (key ? protocol::motion_key : 0));
+        put(&seq, 2);
+
+        if (key)
+        {
+            put(&session_id, 8);
+            put(&time_ms, 4);
+            for (size_t i = 0; i < n; ++i)
+                f.size += write_zigzag(f.data + f.size, q[i]);
+
+            st.has_key    = true;
+            st.key_seq    = seq;
+            st.session_id = session_id;
+            st.time_ms    = time_ms;
+            std::memcpy(st.values, q, n * sizeof(int64_t));
+        }
+        else
+        {
+            put(&st.key_seq, 2);
+            f.size += write_varint(f.data + f.size, time_ms - st.time_ms);
+
+            const size_t mask_pos = f.size;
+            f.size += 2;
+            uint16_t mask = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const int64_t d = q[i] - st.values[i];
+                if (d == 0)
+                    continue;
+                mask |= static_cast<uint16_t>(1u << i);
+                f.size += write_zigzag(f.data + f.size, d);
+            }
+            std::memcpy(f.data + mask_pos, &mask, 2);
+        }
+        return f;
+    }
+
+    static size_t write_zigzag(uint8_t* dst, const int64_t v)
+    {
+        return write_varint(dst, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    static size_t write_varint(uint8_t* dst, uint64_t v)
+    {
+        size_t n = 0;
+        while (v >= 0x80)
+        {
+            dst[n++] = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        dst[n++] = static_cast<uint8_t>(v);
+        return n;
+    }
+};
+} // namespace fsc::test
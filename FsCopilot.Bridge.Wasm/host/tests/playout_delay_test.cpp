@@ -0,0 +1,132 @@
+// playout_delay fed like a session buffer: samples sent at a fixed interval arrive late by a random
+// amount, the render loop advances the delay every frame.
+#include "check.h"
+#include "playout_delay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+constexpr double k_frame = 1.0 / 60.0;
+
+// Samples stamped on our clock, handed over on the first frame after they arrive.
+struct feed
+{
+    double       now         = 0;
+    double       next_sample = 0;
+    double       max_step    = 0; // largest change of the delay between two frames of the last play()
+    std::mt19937 rng{8};
+
+    std::vector<std::pair<double, double>> pending; // arrival, sample time
+
+    void play(playout_delay& pd, const double seconds, const double interval, const double jitter = 0)
+    {
+        std::uniform_real_distribution<double> late(0.0, jitter);
+
+        const double end  = now + seconds;
+        double       last = pd.advance(now);
+        max_step          = 0;
+        for (; now < end; now += k_frame)
+        {
+            for (; next_sample <= now; next_sample += interval)
+                pending.emplace_back(next_sample + (jitter > 0 ? late(rng) : 0.0), next_sample);
+
+            std::sort(pending.begin(), pending.end());
+            auto it = pending.begin();
+            for (; it != pending.end() && it->first <= now; ++it)
+                pd.on_arrival(now, it->second);
+            pending.erase(pending.begin(), it);
+
+            const double delay = pd.advance(now);
+            max_step           = std::max(max_step, std::fabs(delay - last));
+            last               = delay;
+        }
+    }
+};
+} // namespace
+
+int main()
+{
+    playout_delay pd(0.3);
+    feed          f;
+
+    run("the initial delay holds until k_warmup gaps are seen", [&] {
+        f.play(pd, 2.0, 0.2);
+        CHECK(pd.snapshot().target_sec == 0.3 && pd.snapshot().delay_sec == 0.3);
+    });
+
+    run("steady arrivals settle on the interval plus the margin", [&] {
+        f.play(pd, 10.0, 0.2);
+        const auto s = pd.snapshot();
+        // a sample waits up to a frame for its arrival to be seen
+        CHECK(s.target_sec >= 0.2 + playout_delay::k_margin_sec && s.target_sec <= 0.2 + k_frame + playout_delay::k_margin_sec);
+        CHECK(s.delay_sec == s.target_sec);
+        CHECK_NEAR(s.gap_sec, 0.2, k_frame);
+        CHECK(s.jitter_sec < k_frame);
+        CHECK(f.max_step <= playout_delay::k_shrink_rate * k_frame + 1e-12);
+    });
+
+    run("jitter grows the delay, no faster than k_grow_rate", [&] {
+        const double before = pd.snapshot().delay_sec;
+        f.play(pd, 30.0, 0.2, 0.3);
+        const auto s = pd.snapshot();
+        CHECK(s.target_sec > before + 0.2 && s.jitter_sec > 0.1);
+        CHECK(s.delay_sec == s.target_sec);
+        CHECK(f.max_step <= playout_delay::k_grow_rate * k_frame + 1e-12);
+    });
+
+    run("the delay shrinks back at k_shrink_rate once the jitter is gone", [&] {
+        const double before = pd.snapshot().delay_sec;
+        f.play(pd, 60.0, 0.2);
+        const auto s = pd.snapshot();
+        CHECK(s.target_sec <= 0.2 + k_frame + playout_delay::k_margin_sec && s.delay_sec == s.target_sec);
+        CHECK(s.delay_sec < before - 0.2);
+        CHECK(f.max_step <= playout_delay::k_shrink_rate * k_frame + 1e-12);
+    });
+
+    run("the target is clamped to the min and max delay", [] {
+        playout_delay fast(0.3);
+        feed          a;
+        a.play(fast, 5.0, 0.01);
+        CHECK(fast.snapshot().target_sec == playout_delay::k_min_delay_sec);
+
+        playout_delay slow(0.3);
+        feed          b;
+        b.play(slow, 80.0, 3.0);
+        CHECK(slow.snapshot().target_sec == playout_delay::k_max_delay_sec);
+        CHECK(slow.snapshot().delay_sec == playout_delay::k_max_delay_sec);
+    });
+
+    run("a render after a pause takes the target at once", [] {
+        playout_delay p(0.3);
+        feed          a;
+        a.play(p, 10.0, 0.2);
+
+        // eight arrivals that each come a second after the newest sample lift the target
+        for (int i = 0; i < 8; ++i)
+            p.on_arrival(a.now + 1.0 + 0.2 * i, a.now + 0.2 * i);
+        const double target = p.snapshot().target_sec;
+        CHECK(target > p.snapshot().delay_sec + 0.5);
+        CHECK(p.advance(a.now + 5.0) == target);
+    });
+
+    run("an underrun is counted once while it lasts", [] {
+        playout_delay p;
+        p.on_arrival(0.0, 1.0);
+        CHECK(!p.on_render(0.5));
+        CHECK(p.on_render(1.0));
+        CHECK(!p.on_render(1.1));
+        p.on_arrival(1.2, 2.0);
+        CHECK(!p.on_render(1.5));
+        CHECK(p.on_render(2.5));
+        CHECK(p.snapshot().underruns == 2 && p.snapshot().samples == 2);
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,29 @@
+#pragma once
+// fsc::interp::physics as it was before channel_table.h, one scalar call per field. The reference
+// lerp_channels is held to in the host tests and benchmarks.
+#include "interpolators.h"
+
+namespace fsc::test
+{
+inline void scalar_physics(const protocol::physics& a, const protocol::physics& b, const double t, protocol::physics& out)
+{
+    using namespace fsc::interp;
+
+    out.lat      = lerp(a.lat, b.lat, t);
+    out.lon      = lerp(a.lon, b.lon, t);
+    out.alt_feet = lerp(a.alt_feet, b.alt_feet, t);
+
+    out.pitch = lerp_180_deg(a.pitch, b.pitch, t);
+    out.bank  = lerp_180_deg(a.bank, b.bank, t);
+
+    out.hdg_deg_gyro = lerp_360_deg(a.hdg_deg_gyro, b.hdg_deg_gyro, t);
+    out.hdg_deg_true = lerp_360_deg(a.hdg_deg_true, b.hdg_deg_true, t);
+
+    out.vertical_speed = lerp(a.vertical_speed, b.vertical_speed, t);
+    out.g_force        = lerp(a.g_force, b.g_force, t);
+    out.v_body_y       = lerp(a.v_body_y, b.v_body_y, t);
+    out.v_body_z       = lerp(a.v_body_z, b.v_body_z, t);
+    out.vx             = lerp(a.vx, b.vx, t);
+    out.vz             = lerp(a.vz, b.vz, t);
+}
+} // namespace fsc::test
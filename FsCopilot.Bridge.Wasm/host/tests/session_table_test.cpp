@@ -0,0 +1,62 @@
+// session_table: lookup, reuse and eviction of the session seen least recently.
+#include "check.h"
+#include "session_table.h"
+
+#include <map>
+
+using fsc::test::run;
+
+namespace
+{
+struct state
+{
+    int packets = 0;
+};
+
+using table = session_table<state, 3>;
+
+std::map<uint64_t, int> contents(const table& t)
+{
+    std::map<uint64_t, int> out;
+    t.for_each([&](const uint64_t id, const state& s) { out[id] = s.packets; });
+    return out;
+}
+} // namespace
+
+int main()
+{
+    run("a session keeps its state", [] {
+        table t;
+        CHECK(t.find(7) == nullptr);
+        t.touch(7, 1.0).packets = 3;
+        ++t.touch(7, 2.0).packets;
+        CHECK(t.find(7) != nullptr && t.find(7)->packets == 4);
+        CHECK((contents(t) == std::map<uint64_t, int>{{7, 4}}));
+    });
+
+    run("free slots are used before anything is evicted", [] {
+        table t;
+        t.touch(1, 1.0).packets = 1;
+        t.touch(2, 0.5).packets = 2;
+        t.touch(3, 2.0).packets = 3;
+        CHECK((contents(t) == std::map<uint64_t, int>{{1, 1}, {2, 2}, {3, 3}}));
+    });
+
+    run("a new session evicts the one seen least recently", [] {
+        table t;
+        t.touch(1, 1.0).packets = 1;
+        t.touch(2, 2.0).packets = 2;
+        t.touch(3, 3.0).packets = 3;
+        (void)t.touch(1, 4.0); // 2 is the oldest now
+
+        state& fresh = t.touch(4, 5.0);
+        CHECK(fresh.packets == 0); // starts from a default state, not 2's
+        CHECK(t.find(2) == nullptr);
+        CHECK((contents(t) == std::map<uint64_t, int>{{1, 1}, {3, 3}, {4, 0}}));
+
+        (void)t.touch(5, 6.0);
+        CHECK(t.find(3) == nullptr && t.find(1) != nullptr && t.find(4) != nullptr);
+    });
+
+    return fsc::test::finish();
+}
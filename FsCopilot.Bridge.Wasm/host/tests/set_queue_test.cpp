@@ -0,0 +1,120 @@
+// set_queue: collapsing of state writes, rejected writes and the one-by-one fallback when a joined
+// program fails.
+#include "check.h"
+#include "set_queue.h"
+
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+using queue = set_queue<64>;
+
+// runs programs like the calculator, failing the ones that contain `bad`
+struct calculator
+{
+    std::string              bad;
+    std::vector<std::string> programs;
+
+    bool operator()(const char* program)
+    {
+        programs.emplace_back(program);
+        return bad.empty() || programs.back().find(bad) == std::string::npos;
+    }
+};
+} // namespace
+
+int main()
+{
+    run("state writes collapse, events keep every write in order", [] {
+        queue q;
+        CHECK(q.push("L:KNOB", 1));
+        CHECK(q.push("L:KNOB", 2));
+        CHECK(q.push("K:TOGGLE", 1));
+        CHECK(q.push("K:TOGGLE", 1));
+        CHECK(q.push("L:KNOB", 3));
+
+        calculator calc;
+        q.flush(std::ref(calc));
+        CHECK(calc.programs.size() == 1);
+        CHECK(calc.programs[0] == "2 (>L:KNOB) 1 (>K:TOGGLE) 1 (>K:TOGGLE) 3 (>L:KNOB) ");
+        CHECK(q.stats().collapsed == 1 && q.stats().queued == 4 && q.empty());
+    });
+
+    run("non-finite values and unusable names are rejected", [] {
+        queue q;
+        CHECK(q.push("L:A", std::numeric_limits<double>::quiet_NaN()));
+        CHECK(q.push("L:A", std::numeric_limits<double>::infinity()));
+        CHECK(q.push("L:A", -std::numeric_limits<double>::infinity()));
+        CHECK(q.push("", 1));
+        CHECK(q.push("L:A) 0 (>K:OTHER", 1));
+        CHECK(q.push(std::string(queue::k_name_size, 'X').c_str(), 1));
+        CHECK(q.empty() && q.stats().rejected == 6);
+
+        CHECK(q.push("L:A", 1));
+        calculator calc;
+        q.flush(std::ref(calc));
+        CHECK(calc.programs.size() == 1 && calc.programs[0] == "1 (>L:A) ");
+    });
+
+    run("a failed program is run again one write at a time", [] {
+        queue q;
+        (void)q.push("L:A", 1);
+        (void)q.push("K:BROKEN", 2);
+        (void)q.push("L:C", 3);
+
+        calculator calc;
+        calc.bad = "BROKEN";
+        q.flush(std::ref(calc));
+        CHECK(calc.programs.size() == 4 && calc.programs[1] == "1 (>L:A) " && calc.programs[2] == "2 (>K:BROKEN) " && calc.programs[3] == "3 (>L:C) ");
+        CHECK(q.stats().failed == 1 && q.stats().programs == 4);
+    });
+
+    run("a failed single write is not run twice", [] {
+        queue q;
+        (void)q.push("K:BROKEN", 1);
+        calculator calc;
+        calc.bad = "BROKEN";
+        q.flush(std::ref(calc));
+        CHECK(calc.programs.size() == 1 && q.stats().failed == 1);
+    });
+
+    run("only the program that failed is split", [] {
+        queue             q;
+        const std::string name = "_" + std::string(100, 'N');
+        for (int i = 0; i < 40; ++i)
+            (void)q.push(("K:EVENT_" + std::to_string(i) + name).c_str(), i);
+
+        calculator calc;
+        calc.bad = "K:EVENT_30";
+        q.flush(std::ref(calc));
+
+        // 40 writes of ~120 bytes make programs of 17, 17 and 6, the second one fails and is split
+        size_t joined = 0;
+        for (const auto& p : calc.programs)
+            joined += p.find("K:EVENT_") != p.rfind("K:EVENT_");
+        CHECK(joined == 3 && calc.programs.size() == 3 + 17);
+        CHECK(q.stats().failed == 1);
+        CHECK(calc.programs.back().find("K:EVENT_39") != std::string::npos);
+    });
+
+    run("flush can stop after a program and keep the rest", [] {
+        queue             q;
+        const std::string name = "_" + std::string(100, 'N');
+        for (int i = 0; i < 40; ++i)
+            (void)q.push(("K:EVENT_" + std::to_string(i) + name).c_str(), i);
+
+        calculator calc;
+        q.flush(std::ref(calc), [] { return false; });
+        CHECK(calc.programs.size() == 1 && !q.empty());
+        const size_t left = q.size();
+        q.flush(std::ref(calc));
+        CHECK(left > 0 && q.empty() && calc.programs.size() == 3);
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,161 @@
+// stream_buffer edge cases: holds at both ends, the pending sample, age and capacity limits, and
+// segment lookup against a linear scan.
+#include "check.h"
+#include "stream_buffer.h"
+
+#include <random>
+#include <vector>
+
+using fsc::test::run;
+
+namespace
+{
+struct sample
+{
+    double x;
+};
+
+// lerps x and remembers the neighbours it was given
+struct probe
+{
+    static inline double p0 = 0;
+    static inline double p3 = 0;
+
+    static void blend(const timed_sample<sample>& n0, const timed_sample<sample>& a, const timed_sample<sample>& b, const timed_sample<sample>& n3,
+                      const double t, sample& out)
+    {
+        p0    = n0.value.x;
+        p3    = n3.value.x;
+        out.x = a.value.x + (b.value.x - a.value.x) * t;
+    }
+};
+
+using buffer = stream_buffer<sample, probe, 8, 3000>;
+
+double at(buffer& b, const double t, bool* ok = nullptr)
+{
+    sample     out{-1};
+    const bool has = b.interpolate(t, out);
+    if (ok != nullptr)
+        *ok = has;
+    return out.x;
+}
+} // namespace
+
+int main()
+{
+    run("empty buffer has nothing to play", [] {
+        buffer b;
+        bool   ok = true;
+        (void)at(b, 1.0, &ok);
+        CHECK(!ok);
+    });
+
+    run("a single sample is held", [] {
+        buffer b;
+        b.push(1.0, {5});
+        CHECK(at(b, 0.0) == 5 && at(b, 1.0) == 5 && at(b, 9.0) == 5);
+    });
+
+    run("holds the first sample before and the last after the stream", [] {
+        buffer b;
+        b.push(1.0, {10});
+        b.push(1.5, {20});
+        b.push(2.0, {30});
+        CHECK(at(b, 0.5) == 10);
+        CHECK(at(b, 1.0) == 10);
+        CHECK(at(b, 2.0) == 30);
+        CHECK(at(b, 7.0) == 30);
+    });
+
+    run("interpolates inside a segment with its neighbours", [] {
+        buffer b;
+        b.push(1.0, {10});
+        b.push(1.5, {20});
+        b.push(2.0, {30});
+        b.push(2.5, {40});
+        CHECK_NEAR(at(b, 1.25), 15, 1e-12);
+        CHECK(probe::p0 == 10 && probe::p3 == 30); // repeats the first sample
+        CHECK_NEAR(at(b, 1.75), 25, 1e-12);
+        CHECK(probe::p0 == 10 && probe::p3 == 40);
+        CHECK_NEAR(at(b, 2.4), 38, 1e-9);
+        CHECK(probe::p0 == 20 && probe::p3 == 40); // repeats the last sample
+    });
+
+    run("a sample closer than 0.2 s waits as pending", [] {
+        buffer b;
+        b.push(1.0, {10});
+        b.push(1.5, {20});
+        b.push(1.6, {26}); // pending
+        CHECK(b.size() == 2);
+        CHECK_NEAR(at(b, 1.25), 15, 1e-12);
+
+        // render reached the last sample, the pending one joins the buffer once and this frame plays nothing
+        bool ok = true;
+        (void)at(b, 1.5, &ok);
+        CHECK(!ok);
+        CHECK(b.size() == 3);
+        (void)at(b, 1.55, &ok);
+        CHECK(b.size() == 3);
+        CHECK(ok);
+        CHECK_NEAR(at(b, 1.55), 23, 1e-9);
+    });
+
+    run("pending sample older than the last one is dropped", [] {
+        buffer b;
+        b.push(1.0, {10});
+        b.push(1.5, {20});
+        b.push(1.4, {99});
+        CHECK(at(b, 1.6) == 20);
+        CHECK(b.size() == 2);
+    });
+
+    run("samples older than the maximum age are pruned on push", [] {
+        buffer b;
+        b.push(1.0, {10});
+        b.push(2.0, {20});
+        b.push(3.0, {30});
+        b.push(4.5, {45}); // 1.0 is older than 3 s now
+        CHECK(b.size() == 3);
+        CHECK(at(b, 0.0) == 20);
+    });
+
+    run("a full buffer drops the oldest sample", [] {
+        buffer b;
+        for (int i = 0; i < 12; ++i)
+            b.push(1.0 + i * 0.25, {static_cast<double>(i)});
+        CHECK(b.size() == 8);
+        CHECK(at(b, 0.0) == 4);
+        CHECK(at(b, 10.0) == 11);
+        CHECK_NEAR(at(b, 1.0 + 5.5 * 0.25), 5.5, 1e-9);
+    });
+
+    run("lookup matches a linear scan for any render time", [] {
+        std::mt19937                           rng(3);
+        std::uniform_real_distribution<double> gap(0.25, 0.6);
+        std::uniform_real_distribution<double> jump(-1.0, 1.0);
+
+        buffer              b;
+        std::vector<double> times;
+        double              t = 1.0;
+        for (int i = 0; i < 200; ++i)
+        {
+            t += gap(rng);
+            b.push(t, {t * 10});
+            times.push_back(t);
+            while (times.size() > 8 || times.front() < t - 3.0)
+                times.erase(times.begin());
+
+            // mostly forward like a render clock, sometimes jumping back
+            double render = times.front();
+            for (int k = 0; k < 6; ++k)
+            {
+                render += k == 3 ? jump(rng) : 0.07;
+                const double expected = render <= times.front() ? times.front() * 10 : render >= times.back() ? times.back() * 10 : render * 10;
+                CHECK_NEAR(at(b, render), expected, 1e-6);
+            }
+        }
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,155 @@
+// time_shift against simulated peers: clock skew, network jitter and spikes, the 32-bit rollover of
+// time_ms, reordering and a restarted peer clock.
+#include "check.h"
+#include "time_shift.h"
+
+#include <algorithm>
+#include <random>
+
+using fsc::test::run;
+
+namespace
+{
+// A peer sending every 50 ms. Its clock runs skew faster than ours and reads start_ms when ours
+// reads local_start. Packets take base_delay plus exponential jitter.
+struct peer
+{
+    double       skew        = 0;
+    uint32_t     start_ms    = 0;
+    double       local_start = 100.0;
+    double       base_delay  = 0.02;
+    double       jitter      = 0;
+    std::mt19937 rng{5};
+
+    // local seconds at which the peer's clock reads client_sec past start_ms
+    double local_at(const double client_sec) const
+    {
+        return local_start + client_sec / (1.0 + skew);
+    }
+
+    uint32_t raw(const double client_sec) const
+    {
+        return start_ms + static_cast<uint32_t>(std::llround(client_sec * 1000.0));
+    }
+
+    double delay()
+    {
+        return base_delay + (jitter > 0 ? std::exponential_distribution<double>(1.0 / jitter)(rng) : 0.0);
+    }
+};
+
+struct stats
+{
+    double max_error = 0; // |mapped - (sent + base delay)|, seconds, after the first `settle` seconds
+    double last      = 0; // the same for the last packet
+};
+
+// Feeds `seconds` of packets from p and compares each mapping to the local send time plus the base
+// delay, which is what a perfect estimator returns.
+stats play(time_shift& ts, peer& p, const double from_sec, const double seconds, const double settle = 10.0)
+{
+    stats s;
+    for (double c = from_sec; c < from_sec + seconds; c += 0.05)
+    {
+        const double sent    = p.local_at(c);
+        const double mapped  = ts.to_local_sec(sent + p.delay(), p.raw(c));
+        const double settled = c - from_sec >= settle;
+        if (settled)
+            s.max_error = std::max(s.max_error, std::fabs(mapped - (sent + p.base_delay)));
+        s.last = mapped - (sent + p.base_delay);
+    }
+    return s;
+}
+} // namespace
+
+int main()
+{
+    run("a steady link maps exactly", [] {
+        time_shift ts;
+        peer       p;
+        p.start_ms = 123456;
+        CHECK(play(ts, p, 0.0, 30.0, 0.0).max_error < 1e-9);
+        CHECK_NEAR(ts.skew(), 0.0, 1e-9);
+    });
+
+    run("skew is estimated and followed under jitter", [] {
+        time_shift ts;
+        peer       p;
+        p.skew   = 200e-6;
+        p.jitter = 0.03;
+        const stats s = play(ts, p, 0.0, 120.0);
+        std::printf("     mapping error %.2f ms, skew %.0f ppm\n", s.max_error * 1e3, ts.skew() * 1e6);
+
+        // our clock loses 200 ppm against the peer's, local per client second is 1 / (1 + skew)
+        CHECK_NEAR(ts.skew(), -200e-6, 50e-6);
+        CHECK(s.max_error < 0.005);
+    });
+
+    run("skew beyond 1000 ppm is clamped", [] {
+        time_shift ts;
+        peer       p;
+        p.skew = -5e-3;
+        (void)play(ts, p, 0.0, 60.0);
+        CHECK_NEAR(ts.skew(), time_shift::k_max_skew, 1e-12);
+    });
+
+    run("a delay spike does not move the mapping", [] {
+        time_shift ts;
+        peer       p;
+        p.jitter = 0.01;
+        (void)play(ts, p, 0.0, 20.0);
+
+        // one packet 2 s late is still mapped to when it was sent, then normal traffic again
+        const double spike = ts.to_local_sec(p.local_at(20.0) + 2.0, p.raw(20.0));
+        CHECK_NEAR(spike, p.local_at(20.0) + p.base_delay, 0.005);
+        CHECK(play(ts, p, 20.05, 10.0, 0.0).max_error < 0.005);
+    });
+
+    run("time_ms rolls over without a jump", [] {
+        time_shift ts;
+        peer       p;
+        p.skew     = 100e-6;
+        p.jitter   = 0.02;
+        p.start_ms = 0xFFFFFFFFu - 20000; // wraps 20 s in
+        const stats s = play(ts, p, 0.0, 60.0);
+        CHECK(s.max_error < 0.005);
+        CHECK(std::fabs(s.last) < 0.005); // 40 s past the wrap
+    });
+
+    run("reordered packets keep their place", [] {
+        time_shift ts;
+        peer       p;
+        p.start_ms = 0xFFFFFFFFu - 100; // the late packet is from before the wrap
+        (void)play(ts, p, 0.0, 20.0);
+
+        const double late = ts.to_local_sec(p.local_at(20.5) + 0.3, p.raw(0.05));
+        CHECK_NEAR(late, p.local_at(0.05) + p.base_delay, 1e-6);
+    });
+
+    run("a restarted peer clock is picked up after a run of outliers", [] {
+        time_shift ts;
+        peer       p;
+        p.start_ms = 5000000;
+        (void)play(ts, p, 0.0, 20.0);
+
+        // the peer restarts, its clock reads 0 at local 120 s
+        p.start_ms    = 0;
+        p.local_start = 120.0;
+        size_t wrong  = 0;
+        size_t last   = 0;
+        size_t i      = 0;
+        for (double c = 0.0; c < 10.0; c += 0.05, ++i)
+        {
+            const double sent = p.local_at(c);
+            if (std::fabs(ts.to_local_sec(sent + p.delay(), p.raw(c)) - (sent + p.base_delay)) > 1e-6)
+            {
+                ++wrong;
+                last = i;
+            }
+        }
+        // only the run that proves the restart is mapped on the old clock
+        CHECK(wrong == time_shift::k_reset_run - 1 && last == wrong - 1);
+    });
+
+    return fsc::test::finish();
+}
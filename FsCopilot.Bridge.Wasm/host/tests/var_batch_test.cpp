@@ -0,0 +1,102 @@
+// var_batch_writer against the desktop app's reading of the records (bridge_io.h read_batch): every
+// record kind, the rec_bits packing and a batch that runs full.
+#include "bridge_io.h"
+#include "check.h"
+#include "var_batch.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+using fsc::protocol::var_batch_writer;
+using fsc::test::read_batch;
+using fsc::test::run;
+
+namespace
+{
+// bytes a single value takes in an otherwise empty batch
+size_t size_of(const double value)
+{
+    var_batch_writer w;
+    CHECK(w.add(1, nullptr, value));
+    return w.finish(1).size;
+}
+} // namespace
+
+int main()
+{
+    run("values take the smallest record that holds them", [] {
+        CHECK(size_of(1) == 2 + 2 + 1); // a bitset of one
+        CHECK(size_of(-5) == 3 + 1);
+        CHECK(size_of(300) == 3 + 2);
+        CHECK(size_of(-70000) == 3 + 4);
+        CHECK(size_of(0.5) == 3 + 4);
+        CHECK(size_of(3e9) == 3 + 4); // whole, but past int32, still exact as a float
+        CHECK(size_of(0.1) == 3 + 8);
+        CHECK(size_of(1e300) == 3 + 8);
+        CHECK(size_of(-1e300) == 3 + 8);
+        CHECK(size_of(std::numeric_limits<double>::infinity()) == 3 + 4);
+        CHECK(size_of(std::numeric_limits<double>::quiet_NaN()) == 3 + 4);
+    });
+
+    run("every record kind reads back", [] {
+        const double values[] = {0, 1, -128, 127, -32768, 32767, -2147483648.0, 2147483647.0, 0.25, -1e-3, 1e300, 3.14159265358979, -std::numeric_limits<double>::infinity()};
+
+        var_batch_writer w;
+        for (size_t i = 0; i < std::size(values); ++i)
+            CHECK(w.add(static_cast<uint16_t>(i), i == 2 ? "L:NAMED" : nullptr, values[i]));
+
+        std::map<uint16_t, std::string> names;
+        const auto&                     frame = w.finish(9);
+        const auto                      read  = read_batch(frame, &names);
+        CHECK(frame.seq == 9 && read.size() == std::size(values));
+        for (size_t i = 0; i < std::size(values); ++i)
+            CHECK(read.count(static_cast<uint16_t>(i)) && read.at(static_cast<uint16_t>(i)) == values[i]);
+        CHECK(names.size() == 1 && names[2] == "L:NAMED");
+
+        var_batch_writer nan;
+        CHECK(nan.add(4, nullptr, std::numeric_limits<double>::quiet_NaN()));
+        CHECK(std::isnan(read_batch(nan.finish(1)).at(4)));
+    });
+
+    run("bits pack across bytes and stop at k_max_bits", [] {
+        var_batch_writer w;
+        for (uint16_t h = 0; h < var_batch_writer::k_max_bits; ++h)
+            CHECK(w.add(h, nullptr, h % 3 == 0 ? 1.0 : 0.0));
+        CHECK(!w.add(1000, nullptr, 1.0));
+        CHECK(w.add(1000, nullptr, 2.0)); // other records still fit
+
+        const auto& frame = w.finish(1);
+        const auto  read  = read_batch(frame);
+        CHECK(frame.count == 2 && read.size() == var_batch_writer::k_max_bits + 1);
+        size_t bad = 0;
+        for (uint16_t h = 0; h < var_batch_writer::k_max_bits; ++h)
+            bad += read.at(h) != (h % 3 == 0 ? 1.0 : 0.0);
+        CHECK(bad == 0 && read.at(1000) == 2.0);
+    });
+
+    run("a full batch refuses the value, the next batch takes it", [] {
+        var_batch_writer w;
+        uint16_t         h = 0;
+        while (w.add(h, nullptr, h + 0.1))
+            ++h;
+        CHECK(h == sizeof(fsc::protocol::var_batch::data) / 11); // f64 records of 11 bytes
+
+        const auto first = read_batch(w.finish(1));
+        w.reset();
+        CHECK(w.empty());
+        CHECK(w.add(h, nullptr, h + 0.1));
+        const auto second = read_batch(w.finish(2));
+
+        CHECK(first.size() == h && second.size() == 1 && second.at(h) == h + 0.1);
+        CHECK(first.at(0) == 0.1 && first.at(static_cast<uint16_t>(h - 1)) == (h - 1) + 0.1);
+    });
+
+    run("a name longer than 255 bytes is refused", [] {
+        var_batch_writer w;
+        CHECK(!w.add(1, std::string(256, 'N').c_str(), 5));
+        CHECK(w.empty());
+    });
+
+    return fsc::test::finish();
+}
@@ -0,0 +1,175 @@
+// var_watcher against the stub gauge API: compiled expression cache, shared entries, poll cost.
+#include "check.h"
+#include "var_watcher.h"
+
+#include <fsc_host.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace host = fsc::host;
+using fsc::test::run;
+
+namespace
+{
+std::map<uint32_t, double> g_changes;
+
+bool collect(const uint32_t handle, const char* /*name*/, const double value, void* /*user*/)
+{
+    g_changes[handle] = value;
+    return true;
+}
+
+std::map<uint32_t, double> poll(var_watcher& w)
+{
+    g_changes.clear();
+    w.poll(0, &collect, nullptr);
+    return g_changes;
+}
+} // namespace
+
+int main()
+{
+    run("same name and units share one compiled entry", [] {
+        host::reset();
+        var_watcher w;
+        const auto  a = w.watch("B:FSC_KNOB", "number");
+        const auto  b = w.watch("B:FSC_KNOB", "number");
+        CHECK(a == b);
+        CHECK(w.size() == 1);
+        CHECK(w.stats().compiled == 1 && w.stats().shared == 1);
+        CHECK(host::sent().precompiled == 1);
+    });
+
+    run("other units are a separate watch", [] {
+        host::reset();
+        host::vars()["A:PLANE ALTITUDE"] = 1000;
+        var_watcher w;
+        const auto  feet   = w.watch("A:PLANE ALTITUDE", "Feet");
+        const auto  meters = w.watch("A:PLANE ALTITUDE", "Meters");
+        CHECK(feet != meters);
+        CHECK(w.stats().compiled == 2);
+        CHECK(std::string(w.units_of(feet)) == "Feet" && std::string(w.units_of(meters)) == "Meters");
+        CHECK(std::string(w.name_of(meters)) == "A:PLANE ALTITUDE");
+        CHECK(w.is_watched("A:PLANE ALTITUDE", "Feet") && !w.is_watched("A:PLANE ALTITUDE", "Knots"));
+
+        w.unwatch("A:PLANE ALTITUDE", "Feet");
+        CHECK(!w.is_watched("A:PLANE ALTITUDE", "Feet") && w.is_watched("A:PLANE ALTITUDE", "Meters"));
+        CHECK(w.watch("A:PLANE ALTITUDE", "Feet") == feet);
+    });
+
+    run("handles survive unwatch and watch churn", [] {
+        host::reset();
+        var_watcher           w;
+        std::vector<uint32_t> handles;
+        for (int i = 0; i < 10; ++i)
+        {
+            const std::string name = "L:FSC_V" + std::to_string(i);
+            host::vars()[name]     = i;
+            handles.push_back(w.watch(name.c_str(), ""));
+        }
+        for (int i = 0; i < 10; i += 2)
+            w.unwatch(handles[static_cast<size_t>(i)]);
+        host::vars()["L:FSC_NEW"] = 100;
+        const auto added          = w.watch("L:FSC_NEW", "");
+        CHECK(std::find(handles.begin(), handles.end(), added) == handles.end());
+        CHECK(w.size() == 6);
+
+        const auto values = poll(w);
+        CHECK(values.size() == 6);
+        for (int i = 1; i < 10; i += 2)
+            CHECK(values.at(handles[static_cast<size_t>(i)]) == i);
+        CHECK(values.at(added) == 100);
+
+        CHECK(w.watch("L:FSC_V4", "") == handles[4]);
+        CHECK(std::string(w.name_of(handles[4])) == "L:FSC_V4");
+        CHECK(poll(w).at(handles[4]) == 4);
+    });
+
+    run("set hash covers names and units", [] {
+        host::reset();
+        var_watcher a;
+        var_watcher b;
+        (void)a.watch("B:FSC_KNOB", "number");
+        (void)b.watch("B:FSC_KNOB", "bool");
+        CHECK(a.set_hash() != b.set_hash());
+
+        (void)b.watch("B:FSC_KNOB", "number");
+        b.unwatch("B:FSC_KNOB", "bool");
+        CHECK(a.set_hash() == b.set_hash());
+    });
+
+    run("precompiled code runs as a C string", [] {
+        host::reset();
+        var_watcher w;
+        const auto  h = w.watch("B:FSC_KNOB", "number");
+        host::vars()["B:FSC_KNOB"] = 4;
+        host::clear_sent();
+
+        CHECK(poll(w)[h] == 4);
+        CHECK(host::sent().compiled_runs == 1);
+        CHECK(host::sent().calculator.size() == 1 && host::sent().calculator[0] == "(B:FSC_KNOB, number)");
+    });
+
+    run("poll reads every watch once and compiles nothing", [] {
+        host::reset();
+        var_watcher w;
+        for (int i = 0; i < 100; ++i)
+        {
+            const std::string name = "L:FSC_V" + std::to_string(i);
+            host::vars()[name]     = i;
+            (void)w.watch(name.c_str(), "");
+        }
+        (void)w.watch("B:FSC_KNOB", "number");
+        host::clear_sent();
+
+        CHECK(poll(w).size() == 101);
+        CHECK(w.stats().reads == 101 && w.stats().changed == 101);
+        CHECK(poll(w).empty());
+        CHECK(w.stats().reads == 101 && w.stats().changed == 0);
+
+        host::vars()["L:FSC_V42"] = -1;
+        const auto changed        = poll(w);
+        CHECK(changed.size() == 1 && changed.begin()->second == -1);
+
+        // L: variables are read through their named variable id, only the B: one runs code
+        CHECK(host::sent().precompiled == 0);
+        CHECK(host::sent().compiled_runs == 3);
+    });
+
+    run("unwatch during a budgeted pass still reads every other watch", [] {
+        host::reset();
+        var_watcher           w;
+        std::vector<uint32_t> handles;
+        for (int i = 0; i < 200; ++i)
+        {
+            const std::string name = "L:FSC_P" + std::to_string(i);
+            host::vars()[name]     = i;
+            handles.push_back(w.watch(name.c_str(), ""));
+        }
+
+        // the first block is read, then slots behind, at and ahead of the cursor are removed
+        g_changes.clear();
+        CHECK(!w.poll(0, &collect, nullptr, [] { return false; }));
+        CHECK(g_changes.size() == var_watcher::k_block);
+        w.unwatch(handles[3]);
+        w.unwatch(handles[var_watcher::k_block - 1]);
+        w.unwatch(handles[100]);
+        w.unwatch(handles[10]);
+
+        while (!w.poll(0, &collect, nullptr, [] { return false; }))
+        {
+        }
+        // the three removed after they were read are in the first block, only the one ahead is missing
+        CHECK(g_changes.size() == 199 && g_changes.count(handles[100]) == 0);
+        for (const int i : {196, 197, 198, 199})
+            CHECK(g_changes.count(handles[static_cast<size_t>(i)]) == 1);
+
+        // the pass is complete, the next one reports nothing and reads the 196 left
+        CHECK(poll(w).empty() && w.stats().reads == 196);
+    });
+
+    return fsc::test::finish();
+}
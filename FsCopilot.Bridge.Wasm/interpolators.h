@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include <cmath>
 
+#include "channel_table.h"
+#include "stream_buffer.h"
+
 namespace fsc::interp
 {
 inline double lerp(const double a, const double b, const double t)
@@ -75,24 +78,11 @@ inline double lerp_180_deg(double a_deg, double b_deg, const double t)
     return norm180(a_deg + d * t);
 }
 
+// Per channels<protocol::physics>: position and rates are lerped, attitude takes the short way
+// round, the same as lerp_180_deg/lerp_360_deg on every field.
 inline void physics(const protocol::physics& a, const protocol::physics& b, const double t, protocol::physics& out)
 {
-    out.lat      = lerp(a.lat, b.lat, t);
-    out.lon      = lerp(a.lon, b.lon, t);
-    out.alt_feet = lerp(a.alt_feet, b.alt_feet, t);
-
-    out.pitch = lerp_180_deg(a.pitch, b.pitch, t);
-    out.bank  = lerp_180_deg(a.bank, b.bank, t);
-
-    out.hdg_deg_gyro = lerp_360_deg(a.hdg_deg_gyro, b.hdg_deg_gyro, t);
-    out.hdg_deg_true = lerp_360_deg(a.hdg_deg_true, b.hdg_deg_true, t);
-
-    out.vertical_speed = lerp(a.vertical_speed, b.vertical_speed, t);
-    out.g_force        = lerp(a.g_force, b.g_force, t);
-    out.v_body_y       = lerp(a.v_body_y, b.v_body_y, t);
-    out.v_body_z       = lerp(a.v_body_z, b.v_body_z, t);
-    out.vx             = lerp(a.vx, b.vx, t);
-    out.vz             = lerp(a.vz, b.vz, t);
+    lerp_channels(a, b, t, out);
 }
 
 inline void control(const protocol::surfaces& a, const protocol::surfaces& b, const double t, protocol::surfaces& out)
@@ -101,4 +91,110 @@ inline void control(const protocol::surfaces& a, const protocol::surfaces& b, co
     out.elev_pos = static_cast<int32_t>(llround(lerp(a.elev_pos, b.elev_pos, t)));
     out.rud_pos  = static_cast<int32_t>(llround(lerp(a.rud_pos, b.rud_pos, t)));
 }
+
+constexpr double k_pi              = 3.14159265358979323846;
+constexpr double k_earth_radius_ft = 20925646.3; // WGS84 equatorial
+
+// Cubic Hermite between p0 and p1 with slopes m0 and m1 per second over a segment of h seconds.
+inline double cubic_hermite(const double p0, const double m0, const double p1, const double m1, const double h, const double t)
+{
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    return (2.0 * t3 - 3.0 * t2 + 1.0) * p0 + (t3 - 2.0 * t2 + t) * h * m0 + (-2.0 * t3 + 3.0 * t2) * p1 + (t3 - t2) * h * m1;
+}
+
+inline double slope(const double from, const double t_from, const double to, const double t_to)
+{
+    const double dt = t_to - t_from;
+    return dt <= 1e-9 ? 0.0 : (to - from) / dt;
+}
+
+inline double wrap_pi(double a)
+{
+    a = std::fmod(a + k_pi, 2.0 * k_pi);
+    if (a < 0.0)
+        a += 2.0 * k_pi;
+    return a - k_pi;
+}
+
+// Hermite over an angle in degrees. Samples are unwrapped around a so the curve takes the short
+// way across 0/360, slopes are the centered differences of the neighbours (Catmull-Rom).
+inline double hermite_deg(const timed_sample<protocol::physics>& p0, const timed_sample<protocol::physics>& a,
+                          const timed_sample<protocol::physics>& b, const timed_sample<protocol::physics>& p3,
+                          double protocol::physics::*field, const double t)
+{
+    const double d0 = norm180(p0.value.*field - a.value.*field);
+    const double d1 = norm180(b.value.*field - a.value.*field);
+    const double d3 = d1 + norm180(p3.value.*field - b.value.*field);
+
+    const double m0 = slope(d0, p0.t_local, d1, b.t_local);
+    const double m1 = slope(0.0, a.t_local, d3, p3.t_local);
+
+    return a.value.*field + cubic_hermite(0.0, m0, d1, m1, b.t_local - a.t_local, t);
+}
+
+// Straight lerp of every field, works for any segment. Structs with a channels<T> table are
+// interpolated per their table.
+struct linear
+{
+    template <typename T>
+    static void blend(const timed_sample<T>&, const timed_sample<T>& a, const timed_sample<T>& b, const timed_sample<T>&, const double t, T& out)
+    {
+        lerp_channels(a.value, b.value, t, out);
+    }
+
+    static void blend(const timed_sample<protocol::physics>&, const timed_sample<protocol::physics>& a,
+                      const timed_sample<protocol::physics>& b, const timed_sample<protocol::physics>&, const double t,
+                      protocol::physics& out)
+    {
+        physics(a.value, b.value, t, out);
+    }
+
+    static void blend(const timed_sample<protocol::surfaces>&, const timed_sample<protocol::surfaces>& a,
+                      const timed_sample<protocol::surfaces>& b, const timed_sample<protocol::surfaces>&, const double t,
+                      protocol::surfaces& out)
+    {
+        control(a.value, b.value, t, out);
+    }
+};
+
+// Position follows the world velocities each packet carries (vz north, vx east, vertical_speed up,
+// all feet per second), so the path has no corners at the samples. Attitude uses angle-aware
+// Catmull-Rom slopes. The remaining rates and forces are lerped.
+struct hermite
+{
+    static void blend(const timed_sample<protocol::physics>& p0, const timed_sample<protocol::physics>& a,
+                      const timed_sample<protocol::physics>& b, const timed_sample<protocol::physics>& p3, const double t,
+                      protocol::physics& out)
+    {
+        const auto&  va = a.value;
+        const auto&  vb = b.value;
+        const double h  = b.t_local - a.t_local;
+
+        // lon/lat are radians, lon rates blow up near the poles, stay linear there.
+        const double cos_a = std::cos(va.lat);
+        const double cos_b = std::cos(vb.lat);
+        const double d_lon = wrap_pi(vb.lon - va.lon);
+
+        out.lat = cubic_hermite(va.lat, va.vz / k_earth_radius_ft, vb.lat, vb.vz / k_earth_radius_ft, h, t);
+        if (cos_a > 1e-3 && cos_b > 1e-3)
+            out.lon = wrap_pi(va.lon + cubic_hermite(0.0, va.vx / (k_earth_radius_ft * cos_a), d_lon, vb.vx / (k_earth_radius_ft * cos_b), h, t));
+        else
+            out.lon = wrap_pi(va.lon + d_lon * t);
+        out.alt_feet = cubic_hermite(va.alt_feet, va.vertical_speed, vb.alt_feet, vb.vertical_speed, h, t);
+
+        out.pitch = norm180(hermite_deg(p0, a, b, p3, &protocol::physics::pitch, t));
+        out.bank  = norm180(hermite_deg(p0, a, b, p3, &protocol::physics::bank, t));
+
+        out.hdg_deg_gyro = norm360(hermite_deg(p0, a, b, p3, &protocol::physics::hdg_deg_gyro, t));
+        out.hdg_deg_true = norm360(hermite_deg(p0, a, b, p3, &protocol::physics::hdg_deg_true, t));
+
+        out.vertical_speed = lerp(va.vertical_speed, vb.vertical_speed, t);
+        out.g_force        = lerp(va.g_force, vb.g_force, t);
+        out.v_body_y       = lerp(va.v_body_y, vb.v_body_y, t);
+        out.v_body_z       = lerp(va.v_body_z, vb.v_body_z, t);
+        out.vx             = lerp(va.vx, vb.vx, t);
+        out.vz             = lerp(va.vz, vb.vz, t);
+    }
+};
 } // namespace fsc::interp
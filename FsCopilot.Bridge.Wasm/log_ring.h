@@ -0,0 +1,178 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+enum log_level : uint8_t
+{
+    log_debug,
+    log_info,
+    log_warn,
+    log_error
+};
+
+// In-memory log for the frame. A call stores the format string, its arguments and a formatter
+// for their types in a fixed ring, the text is only produced by drain(), which the caller runs
+// at a bounded rate outside the hot path. Calls below MinLevel compile to nothing.
+//
+// The format string must outlive the entry, in practice a literal. String arguments are copied,
+// up to k_text_size bytes for all of them together, longer ones are cut. Other arguments are
+// scalars, at most k_max_args in all. A full ring drops new entries and counts them.
+template <log_level MinLevel, size_t Capacity = 256> class log_ring
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    static constexpr size_t k_max_args  = 8;
+    static constexpr size_t k_text_size = 128;
+    static constexpr size_t k_line_size = 512;
+
+    template <typename... Args> void debug(const char* fmt, const Args&... args)
+    {
+        write<log_debug>(fmt, args...);
+    }
+
+    template <typename... Args> void info(const char* fmt, const Args&... args)
+    {
+        write<log_info>(fmt, args...);
+    }
+
+    template <typename... Args> void warn(const char* fmt, const Args&... args)
+    {
+        write<log_warn>(fmt, args...);
+    }
+
+    template <typename... Args> void error(const char* fmt, const Args&... args)
+    {
+        write<log_error>(fmt, args...);
+    }
+
+    // Formats up to `max` entries, oldest first, and hands each line to fn(level, line).
+    template <typename Fn> void drain(const size_t max, Fn fn)
+    {
+        char line[k_line_size];
+        for (size_t i = 0; i < max && tail_ != head_; ++i)
+        {
+            const entry& e = entries_[tail_ & (Capacity - 1)];
+            e.format(e, line, sizeof(line));
+            fn(e.level, line);
+            ++tail_;
+        }
+
+        if (dropped_ > 0 && tail_ == head_)
+        {
+            (void)snprintf(line, sizeof(line), "Log ring full, %u entries dropped", dropped_);
+            fn(log_warn, line);
+            dropped_ = 0;
+        }
+    }
+
+    size_t size() const
+    {
+        return head_ - tail_;
+    }
+
+  private:
+    // a string argument, an offset into entry::text
+    struct text_ref
+    {
+        uint16_t offset;
+    };
+
+    struct entry
+    {
+        const char* fmt;
+        void (*format)(const entry&, char*, size_t);
+        log_level level;
+        uint16_t  text_used;
+        uint64_t  args[k_max_args]; // one argument per slot
+        char      text[k_text_size];
+    };
+
+    entry    entries_[Capacity]{};
+    uint32_t head_    = 0;
+    uint32_t tail_    = 0;
+    uint32_t dropped_ = 0;
+
+    template <typename T> using stored_t = std::conditional_t<std::is_convertible_v<const T&, const char*>, text_ref, T>;
+
+    template <log_level Level, typename... Args> void write(const char* fmt, const Args&... args)
+    {
+        if constexpr (Level >= MinLevel)
+        {
+            static_assert(sizeof...(Args) <= k_max_args, "too many log arguments");
+            static_assert(((std::is_scalar_v<stored_t<Args>> || std::is_same_v<stored_t<Args>, text_ref>) && ...),
+                          "log arguments must be scalars or strings");
+
+            if (head_ - tail_ == Capacity)
+            {
+                ++dropped_;
+                return;
+            }
+
+            entry& e    = entries_[head_ & (Capacity - 1)];
+            e.fmt       = fmt;
+            e.format    = &format_entry<stored_t<Args>...>;
+            e.level     = Level;
+            e.text_used = 0;
+
+            size_t slot = 0;
+            (store(e.args[slot++], stash(e, args)), ...);
+            ++head_;
+        }
+    }
+
+    template <typename T> static stored_t<T> stash(entry& e, const T& value)
+    {
+        if constexpr (std::is_same_v<stored_t<T>, text_ref>)
+        {
+            const char*    s      = value;
+            const uint16_t offset = e.text_used;
+            const size_t   room   = k_text_size - offset - 1;
+            size_t         n      = 0;
+            if (s != nullptr)
+                while (n < room && s[n] != '\0')
+                    ++n;
+
+            std::memcpy(e.text + offset, s, n);
+            e.text[offset + n] = '\0';
+            e.text_used        = static_cast<uint16_t>(offset + n + (offset + n + 1 < k_text_size ? 1 : 0));
+            return text_ref{offset};
+        }
+        else
+            return value;
+    }
+
+    template <typename T> static void store(uint64_t& slot, const T& value)
+    {
+        static_assert(sizeof(T) <= sizeof(slot));
+        std::memcpy(&slot, &value, sizeof(value));
+    }
+
+    template <typename T> static auto load(const entry& e, const uint64_t& slot)
+    {
+        T value;
+        std::memcpy(&value, &slot, sizeof(value));
+        if constexpr (std::is_same_v<T, text_ref>)
+            return static_cast<const char*>(e.text + value.offset);
+        else
+            return value;
+    }
+
+    template <typename... Stored> static void format_entry(const entry& e, char* out, const size_t size)
+    {
+        format_entry<Stored...>(e, out, size, std::index_sequence_for<Stored...>{});
+    }
+
+    template <typename... Stored, size_t... I>
+    static void format_entry(const entry& e, char* out, const size_t size, std::index_sequence<I...>)
+    {
+        if constexpr (sizeof...(Stored) == 0)
+            (void)snprintf(out, size, "%s", e.fmt);
+        else
+            (void)snprintf(out, size, e.fmt, load<Stored>(e, e.args[I])...);
+    }
+};
@@ -0,0 +1,227 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+namespace fsc::protocol
+{
+// Quantized physics and surfaces frames, as written by the desktop app (Simulation/Motion.cs).
+//
+//   u8  header   kind in the low nibble, motion_key set on keyframes
+//   u16 seq      per kind, +1 every frame
+//   keyframe:    u64 session_id, u32 time_ms, then every field as a zigzag varint
+//   delta:       u16 key_seq, varint ms since the keyframe, u16 mask of the fields that differ
+//                from the keyframe, then a zigzag varint of the difference for each of them
+//
+// Deltas are taken against the last keyframe, not the previous frame, so losing one costs only
+// that frame. A delta for a keyframe we don't have is dropped until the next keyframe.
+//
+// Round-trip error is half a quantum: 5e-11 rad lat/lon (~0.3 mm), 0.5 mm altitude, 0.0005 deg
+// attitude, 1/512 ft/s velocities, 0.0005 g. Surfaces are exact.
+enum motion_kind : uint8_t
+{
+    motion_physics  = 1,
+    motion_surfaces = 2,
+    motion_key      = 0x80
+};
+
+constexpr size_t k_physics_fields  = 13;
+constexpr size_t k_surfaces_fields = 3;
+
+// Bound on a quantized value and on a delta. Real ones stay far below (lat/lon reach 3.2e10), a
+// frame past it is malformed. Keeping both within 2^52 means their sum cannot overflow.
+constexpr int64_t k_max_quantum = int64_t{1} << 52;
+
+static_assert(offsetof(physics, session_id) == k_physics_fields * sizeof(double));
+
+// quantum per physics field, in protocol::physics order
+constexpr double k_physics_scale[k_physics_fields] = {
+    1e10,  1e10,  // lat, lon, radians
+    304.8,        // alt, feet to millimetres
+    1000,  1000,  // pitch, bank, degrees
+    1000,  1000,  // heading gyro, true, degrees
+    256,          // vertical speed, ft/s
+    1000,         // g force
+    256,   256,   // body velocities, ft/s
+    256,   256    // world velocities, ft/s
+};
+
+class motion_decoder
+{
+  public:
+    struct counters
+    {
+        uint32_t frames;
+        uint32_t lost;    // sequence gaps
+        uint32_t dropped; // deltas without their keyframe, or malformed
+    };
+
+    // Decodes one frame into `p` or `s`, returns its kind or 0 when nothing was decoded.
+    uint8_t decode(const uint8_t* data, const size_t size, physics& p, surfaces& s)
+    {
+        reader r{data, data + size};
+
+        uint8_t  header = 0;
+        uint16_t seq    = 0;
+        if (!r.u8(header) || !r.u16(seq))
+            return drop();
+
+        const uint8_t kind = header & 0x0F;
+        if (kind != motion_physics && kind != motion_surfaces)
+            return drop();
+
+        stream& st = kind == motion_physics ? phys_ : surf_;
+        const size_t n = kind == motion_physics ? k_physics_fields : k_surfaces_fields;
+
+        if (st.has_seq && seq != static_cast<uint16_t>(st.seq + 1))
+            stats_.lost += static_cast<uint16_t>(seq - st.seq - 1);
+        st.seq     = seq;
+        st.has_seq = true;
+
+        uint32_t time_ms = 0;
+        int64_t  q[k_physics_fields]{};
+
+        if (header & motion_key)
+        {
+            key_frame key{};
+            if (!r.u64(key.session_id) || !r.u32(key.time_ms))
+                return drop();
+            for (size_t i = 0; i < n; ++i)
+                if (!r.zigzag(key.q[i]) || !in_range(key.q[i]))
+                    return drop();
+
+            st.key     = key;
+            st.key_seq = seq;
+            st.has_key = true;
+
+            time_ms = key.time_ms;
+            std::memcpy(q, key.q, sizeof(q));
+        }
+        else
+        {
+            uint16_t key_seq = 0;
+            uint64_t dt      = 0;
+            uint16_t mask    = 0;
+            if (!r.u16(key_seq) || !r.varint(dt) || !r.u16(mask))
+                return drop();
+            if (!st.has_key || key_seq != st.key_seq)
+                return drop();
+
+            std::memcpy(q, st.key.q, sizeof(q));
+            for (size_t i = 0; i < n; ++i)
+            {
+                int64_t d = 0;
+                if ((mask & (1u << i)) != 0 && (!r.zigzag(d) || !in_range(d)))
+                    return drop();
+                q[i] += d;
+                if (!in_range(q[i]))
+                    return drop();
+            }
+            time_ms = st.key.time_ms + static_cast<uint32_t>(dt);
+        }
+
+        ++stats_.frames;
+        if (kind == motion_physics)
+        {
+            double v[k_physics_fields];
+            for (size_t i = 0; i < n; ++i)
+                v[i] = static_cast<double>(q[i]) / k_physics_scale[i];
+
+            std::memcpy(&p, v, sizeof(v));
+            p.session_id = st.key.session_id;
+            p.time_ms    = time_ms;
+        }
+        else
+        {
+            s.ail_pos    = static_cast<int32_t>(q[0]);
+            s.elev_pos   = static_cast<int32_t>(q[1]);
+            s.rud_pos    = static_cast<int32_t>(q[2]);
+            s.session_id = st.key.session_id;
+            s.time_ms    = time_ms;
+        }
+        return kind;
+    }
+
+    const counters& stats() const
+    {
+        return stats_;
+    }
+
+  private:
+    struct key_frame
+    {
+        uint64_t session_id;
+        uint32_t time_ms;
+        int64_t  q[k_physics_fields];
+    };
+
+    struct stream
+    {
+        key_frame key{};
+        uint16_t  key_seq = 0;
+        uint16_t  seq     = 0;
+        bool      has_key = false;
+        bool      has_seq = false;
+    };
+
+    struct reader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+
+        template <typename T> bool fixed(T& out)
+        {
+            if (end - p < static_cast<ptrdiff_t>(sizeof(T)))
+                return false;
+            std::memcpy(&out, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+
+        bool u8(uint8_t& out) { return fixed(out); }
+        bool u16(uint16_t& out) { return fixed(out); }
+        bool u32(uint32_t& out) { return fixed(out); }
+        bool u64(uint64_t& out) { return fixed(out); }
+
+        bool varint(uint64_t& out)
+        {
+            out = 0;
+            for (int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                const uint8_t b = *p++;
+                out |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        bool zigzag(int64_t& out)
+        {
+            uint64_t u = 0;
+            if (!varint(u))
+                return false;
+            out = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+            return true;
+        }
+    };
+
+    stream   phys_;
+    stream   surf_;
+    counters stats_{};
+
+    static bool in_range(const int64_t v)
+    {
+        return v >= -k_max_quantum && v <= k_max_quantum;
+    }
+
+    uint8_t drop()
+    {
+        ++stats_.dropped;
+        return 0;
+    }
+};
+} // namespace fsc::protocol
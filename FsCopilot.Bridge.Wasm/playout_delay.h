@@ -0,0 +1,111 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Render delay for one session, tuned from how late samples arrive. For every arrival we record
+// how far the clock has run past the newest sample timestamp seen before it: rendering further
+// back than that never runs out of samples. The delay is a high percentile of those gaps plus a
+// margin, and moves towards its target at a limited rate so the render time never jumps.
+struct playout_delay
+{
+    static constexpr size_t k_window        = 128;  // gaps kept for the percentile
+    static constexpr size_t k_warmup        = 16;   // gaps needed before the delay is tuned
+    static constexpr size_t k_update_every  = 8;    // arrivals between target updates
+    static constexpr double k_quantile      = 0.98; // allowed underrun probability is 1 - this
+    static constexpr double k_margin_sec    = 0.02;
+    static constexpr double k_min_delay_sec = 0.05;
+    static constexpr double k_max_delay_sec = 1.0;
+    static constexpr double k_grow_rate     = 0.1;  // delay seconds per second, render runs at 90%
+    static constexpr double k_shrink_rate   = 0.02; // render runs at 102%
+
+    struct stats
+    {
+        double   delay_sec;  // delay in use
+        double   target_sec; // delay being moved to
+        double   gap_sec;    // median gap, about the sample interval
+        double   jitter_sec; // percentile gap minus median gap
+        uint32_t underruns;  // times the render time passed the newest sample
+        uint32_t samples;
+    };
+
+    explicit playout_delay(const double initial_sec = 0.3) : delay_(initial_sec), target_(initial_sec) {}
+
+    void on_arrival(const double now, const double t_local)
+    {
+        if (samples_ > 0)
+        {
+            gaps_[gap_count_++ % k_window] = now - newest_;
+            newest_                        = std::max(newest_, t_local);
+        }
+        else
+            newest_ = t_local;
+
+        ++samples_;
+        if (gap_count_ >= k_warmup && gap_count_ % k_update_every == 0)
+            update_target();
+    }
+
+    // Moves the delay towards its target and returns it. A render that resumes after a pause
+    // takes the target straight away, nothing was shown in between.
+    double advance(const double now)
+    {
+        const double dt = now - last_advance_;
+        last_advance_   = now;
+
+        if (dt < 0.0 || dt > 1.0)
+            delay_ = target_;
+        else if (target_ > delay_)
+            delay_ = std::min(target_, delay_ + k_grow_rate * dt);
+        else
+            delay_ = std::max(target_, delay_ - k_shrink_rate * dt);
+
+        return delay_;
+    }
+
+    // true when this render starts an underrun
+    bool on_render(const double render_t)
+    {
+        const bool under = samples_ > 0 && render_t >= newest_;
+        const bool start = under && !in_underrun_;
+        if (start)
+            ++underruns_;
+        in_underrun_ = under;
+        return start;
+    }
+
+    stats snapshot() const
+    {
+        return {delay_, target_, gap_, jitter_, underruns_, samples_};
+    }
+
+  private:
+    double   gaps_[k_window]{};
+    double   newest_       = 0.0;
+    double   delay_        = 0.0;
+    double   target_       = 0.0;
+    double   gap_          = 0.0;
+    double   jitter_       = 0.0;
+    double   last_advance_ = -1.0;
+    uint32_t samples_      = 0;
+    uint32_t gap_count_    = 0;
+    uint32_t underruns_    = 0;
+    bool     in_underrun_  = false;
+
+    void update_target()
+    {
+        const size_t n = std::min<size_t>(gap_count_, k_window);
+
+        double sorted[k_window];
+        std::copy(gaps_, gaps_ + n, sorted);
+
+        const size_t q = std::min(n - 1, static_cast<size_t>(k_quantile * static_cast<double>(n)));
+        std::nth_element(sorted, sorted + q, sorted + n);
+        const double high = sorted[q];
+        std::nth_element(sorted, sorted + n / 2, sorted + q);
+        gap_ = sorted[n / 2];
+
+        jitter_ = high - gap_;
+        target_ = std::clamp(high + k_margin_sec, k_min_delay_sec, k_max_delay_sec);
+    }
+};
@@ -33,6 +33,22 @@ struct surfaces
     uint32_t time_ms;
 };
 
+// lever and handle positions, streamed and interpolated like physics. How each field is
+// interpolated and the variable it is written to are in channels<levers> (channel_table.h). A NaN
+// field is never written, the app sends NaN for the channels the aircraft profile leaves out.
+struct levers
+{
+    double   throttle[4];  // percent
+    double   mixture[4];   // percent
+    double   propeller[4]; // percent
+    double   spoilers;     // percent
+    double   elevator_trim;
+    double   flaps_index;
+    double   gear_handle;
+    uint64_t session_id;
+    uint32_t time_ms;
+};
+
 struct control
 {
     int32_t state;
@@ -50,11 +66,189 @@ struct var_set
     double value;
 };
 
+// Handle based variable messages, names cross the wire once per session in var_watch.
+enum watch_flags : uint8_t
+{
+    watch_resolve = 0, // only assign a handle, e.g. for variables that are set but never read
+    watch_poll    = 1
+};
+
+// var_watch::rate, values in between are a poll rate in Hz
+enum watch_rate : uint8_t
+{
+    rate_every_frame = 0,
+    rate_background  = 255 // a few variables per frame, round-robin
+};
+
+struct var_watch
+{
+    uint32_t tag; // chosen by the desktop app, echoed in var_ack
+    uint8_t  flags;
+    uint8_t  rate;
+    char     name[128];
+    char     units[64];
+};
+
+struct var_ack
+{
+    uint32_t tag;
+    uint32_t handle; // 0xFFFFFFFF when the expression could not be compiled
+};
+
+struct var_acks
+{
+    uint32_t count;
+    var_ack  acks[127];
+};
+
+struct var_handle
+{
+    uint32_t handle;
+};
+
+struct var_value
+{
+    uint32_t handle;
+    double   value;
+};
+
+// Variable deltas collected in one poll. `data` holds `count` records, each starting with
+// a var_record tag; handles are uint16, multi-byte fields are little endian.
+//   rec_name : handle, uint8 len, len chars      (first time a handle is sent, 1.2 peers only)
+//   rec_bits : uint8 n, n handles, (n + 7) / 8 bytes of values, bit i = value of handle i
+//   rec_i8 / rec_i16 / rec_i32 / rec_f32 / rec_f64 : handle, value
+struct var_batch
+{
+    uint32_t seq;
+    uint16_t count;
+    uint16_t size; // bytes used in data
+    uint8_t  data[4088];
+};
+
+enum var_record : uint8_t
+{
+    rec_name = 1,
+    rec_bits = 2,
+    rec_i8   = 3,
+    rec_i16  = 4,
+    rec_i32  = 5,
+    rec_f32  = 6,
+    rec_f64  = 7
+};
+
+// Many var_watch requests in one transfer, see watch_list.h. A list longer than one transfer is
+// sent as several with the same id, the last one has `last` set. The bridge acks every record in
+// var_acks and then answers the whole list with one var_snapshot.
+//   record: u32 tag, u8 flags, u8 rate, u8 name length, name, u8 units length, units
+struct var_watch_list
+{
+    uint32_t id;
+    uint16_t count; // records in data
+    uint8_t  last;
+    uint8_t  reserved;
+    uint8_t  data[4088];
+};
+
+// The value of every variable in a watch list once it is done, in var_batch records spread over as
+// many parts as it takes. Their deltas on FSC_VARIABLE_BATCH only follow after var_snapshot_ack,
+// other watches are sent meanwhile.
+struct var_snapshot
+{
+    uint32_t  id;   // var_watch_list::id
+    uint8_t   last; // set on the final part
+    uint8_t   reserved[3];
+    var_batch batch; // batch.seq numbers the parts from 1
+};
+
+struct var_snapshot_ack
+{
+    uint32_t id;
+};
+
+// comm bus messages, length-prefixed and coalesced, see bus_frame.h
+struct bus_frame
+{
+    uint32_t seq;
+    uint16_t size; // bytes used in data
+    uint8_t  data[4090];
+};
+
+// one quantized physics or surfaces frame, see motion_codec.h
+struct motion
+{
+    uint8_t size; // bytes used in data
+    uint8_t data[255];
+};
+
+// bridge hot path timings, see frame_stats.h
+enum stats_timer : uint8_t
+{
+    timer_dispatch,
+    timer_interpolate,
+    timer_poll,
+    timer_apply_physics,
+    timer_apply_control,
+    timer_set,
+    k_stats_timers
+};
+
+enum stats_counter : uint8_t
+{
+    counter_physics,
+    counter_surfaces,
+    counter_motion,
+    counter_control,
+    counter_set,
+    counter_bus_in,
+    counter_underruns,
+    counter_vars_polled,
+    counter_vars_changed,
+    counter_overruns, // ticks that left deferred work for the next one
+    counter_deferred, // deferred items left, summed over the ticks
+    k_stats_counters
+};
+
+// bucket 0 counts calls under 512 ns, bucket i under 512 << i ns, the last one everything above.
+constexpr uint8_t k_stats_buckets = 16;
+
+struct stats_histogram
+{
+    uint64_t total_ns;
+    uint32_t count;
+    uint32_t max_ns;
+    uint32_t buckets[k_stats_buckets];
+};
+
+// One publish interval, counters and histograms start over after each. 540 bytes, StatsMsg in
+// SimClient.cs has to match, its sizes come from BridgeStats.TimerCount, CounterCount and BucketCount.
+struct bridge_stats
+{
+    uint32_t        seq;
+    uint32_t        interval_ms;
+    double          offset_sec; // clock offset to the active session, local - peer
+    stats_histogram timers[k_stats_timers];
+    uint32_t        counters[k_stats_counters];
+};
+
 #pragma pack(pop)
 
 static_assert(sizeof(physics) == 116);
 static_assert(sizeof(surfaces) == 24);
+static_assert(sizeof(levers) == 140);
 static_assert(sizeof(control) == 4);
 static_assert(sizeof(str_msg) == 512);
 static_assert(sizeof(var_set) == 200);
+static_assert(sizeof(var_watch) == 198);
+static_assert(sizeof(var_ack) == 8);
+static_assert(sizeof(var_acks) == 1020);
+static_assert(sizeof(var_handle) == 4);
+static_assert(sizeof(var_value) == 12);
+static_assert(sizeof(var_batch) == 4096);
+static_assert(sizeof(var_watch_list) == 4096);
+static_assert(sizeof(var_snapshot) == 4104);
+static_assert(sizeof(var_snapshot_ack) == 4);
+static_assert(sizeof(bus_frame) == 4096);
+static_assert(sizeof(motion) == 256);
+static_assert(sizeof(stats_histogram) == 80);
+static_assert(sizeof(bridge_stats) == 540);
 } // namespace fsc::protocol
\ No newline at end of file
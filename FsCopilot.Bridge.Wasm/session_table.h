@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Per-session state for the few peers we hear from at once. Fixed size, a new session takes the
+// slot of the one seen least recently and starts from a default T. Nothing is allocated.
+template <typename T, size_t N> class session_table
+{
+  public:
+    // Returns the state for `id`, making room for it when it is new.
+    T& touch(const uint64_t id, const double now)
+    {
+        entry* victim = &entries_[0];
+        for (auto& e : entries_)
+        {
+            if (e.used && e.id == id)
+            {
+                e.last_seen = now;
+                return e.value;
+            }
+            if (!e.used)
+            {
+                if (victim->used)
+                    victim = &e;
+            }
+            else if (victim->used && e.last_seen < victim->last_seen)
+                victim = &e;
+        }
+
+        victim->id        = id;
+        victim->last_seen = now;
+        victim->used      = true;
+        victim->value     = T();
+        return victim->value;
+    }
+
+    T* find(const uint64_t id)
+    {
+        for (auto& e : entries_)
+            if (e.used && e.id == id)
+                return &e.value;
+        return nullptr;
+    }
+
+    template <typename Fn> void for_each(Fn fn)
+    {
+        for (auto& e : entries_)
+            if (e.used)
+                fn(e.id, e.value);
+    }
+
+    template <typename Fn> void for_each(Fn fn) const
+    {
+        for (const auto& e : entries_)
+            if (e.used)
+                fn(e.id, e.value);
+    }
+
+  private:
+    struct entry
+    {
+        uint64_t id        = 0;
+        double   last_seen = 0;
+        bool     used      = false;
+        T        value{};
+    };
+
+    entry entries_[N]{};
+};
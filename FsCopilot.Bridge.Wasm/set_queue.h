@@ -0,0 +1,211 @@
+﻿#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Variable writes received during a frame, applied together once per tick.
+//
+// A write to a state variable (L:, A:, Z:, B:..._Set) replaces an earlier queued write to the same
+// name, only the last value of a knob turn is executed. Anything else, H: and K: events or B:
+// inc/dec/toggle events, is an event where every write counts: those stay in the queue in order,
+// and a state write never moves across one.
+//
+// flush() turns the queue into calculator programs of up to k_program_size bytes, in queue order,
+// usually a single one per frame. It can stop after any program and leave the rest queued. A write
+// that would break the program it is joined into, a non-finite value or a name the calculator
+// can't parse, is rejected by push(). When a program still fails, its writes are run again one by
+// one, so one bad write costs only itself. A failed program is taken to have run none of them.
+template <size_t Capacity> class set_queue
+{
+  public:
+    static constexpr size_t k_name_size    = 128;
+    static constexpr size_t k_program_size = 2048;
+
+    struct counters
+    {
+        uint32_t queued;
+        uint32_t collapsed; // writes replaced by a later one
+        uint32_t rejected;  // writes dropped by push()
+        uint32_t programs;  // calculator calls
+        uint32_t failed;    // writes that failed when run alone
+    };
+
+    // false when the queue is full, the caller flushes and pushes again. A rejected write is
+    // dropped and counted, and returns true.
+    bool push(const char* name, const double value)
+    {
+        if (!std::isfinite(value) || !valid_name(name))
+        {
+            ++stats_.rejected;
+            return true;
+        }
+
+        const uint32_t hash  = fnv1a(name);
+        const bool     event = is_event(name);
+
+        if (!event)
+        {
+            for (size_t i = size_; i-- > 0;)
+            {
+                entry& e = entries_[i];
+                if (e.event)
+                    break;
+                if (e.hash == hash && std::strncmp(e.name, name, k_name_size) == 0)
+                {
+                    e.value = value;
+                    ++stats_.collapsed;
+                    return true;
+                }
+            }
+        }
+
+        if (size_ == Capacity)
+            return false;
+
+        entry& e = entries_[size_++];
+        e.hash   = hash;
+        e.event  = event;
+        e.value  = value;
+        std::strncpy(e.name, name, k_name_size - 1);
+        e.name[k_name_size - 1] = '\0';
+        ++stats_.queued;
+        return true;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    // Calls run(program) for each calculator program built from the queue and clears it. run
+    // returns false when the calculator failed the program.
+    template <typename Run> void flush(Run run)
+    {
+        flush(run, [] { return true; });
+    }
+
+    // Same, but stops when more() is false after a program. The writes not run yet stay queued.
+    template <typename Run, typename More> void flush(Run run, More more)
+    {
+        size_t used  = 0;
+        size_t first = 0; // first write of the program being built
+        for (size_t i = 0; i < size_; ++i)
+        {
+            char         one[k_entry_size];
+            const size_t len = format(entries_[i], one);
+            if (used + len >= k_program_size)
+            {
+                execute(run, first, i);
+                used  = 0;
+                first = i;
+
+                if (!more())
+                {
+                    std::memmove(entries_, entries_ + i, (size_ - i) * sizeof(entry));
+                    size_ -= i;
+                    return;
+                }
+            }
+            std::memcpy(program_ + used, one, len);
+            used += len;
+            program_[used] = '\0';
+        }
+
+        if (used > 0)
+            execute(run, first, size_);
+        size_ = 0;
+    }
+
+    const counters& stats() const
+    {
+        return stats_;
+    }
+
+  private:
+    static constexpr size_t k_entry_size = k_name_size + 32;
+
+    struct entry
+    {
+        uint32_t hash;
+        bool     event;
+        double   value;
+        char     name[k_name_size];
+    };
+
+    entry    entries_[Capacity]{};
+    size_t   size_ = 0;
+    counters stats_{};
+    char     program_[k_program_size]{};
+
+    // "value (>name) ", the length without the terminator
+    static size_t format(const entry& e, char* out)
+    {
+        const int n = snprintf(out, k_entry_size, "%.15g (>%s) ", e.value, e.name);
+        return n <= 0 ? 0 : static_cast<size_t>(n) < k_entry_size ? static_cast<size_t>(n) : k_entry_size - 1;
+    }
+
+    // runs the program of writes [from, to), and each of them alone if it fails
+    template <typename Run> void execute(Run& run, const size_t from, const size_t to)
+    {
+        ++stats_.programs;
+        if (run(program_))
+            return;
+        if (to - from == 1)
+        {
+            ++stats_.failed;
+            return;
+        }
+
+        for (size_t i = from; i < to; ++i)
+        {
+            (void)format(entries_[i], program_);
+            ++stats_.programs;
+            if (!run(program_))
+                ++stats_.failed;
+        }
+    }
+
+    // Names that fit and can't end the (>...) they are written into early. A longer one would be
+    // cut to the name of some other variable.
+    static bool valid_name(const char* name)
+    {
+        const size_t len = strnlen(name, k_name_size);
+        return len > 0 && len < k_name_size && std::strpbrk(name, "()") == nullptr;
+    }
+
+    static bool is_event(const char* name)
+    {
+        if (name[0] == '\0' || name[1] != ':')
+            return true;
+
+        switch (name[0])
+        {
+        case 'L':
+        case 'A':
+        case 'Z':
+            return false;
+        case 'B':
+        {
+            const size_t len = std::strlen(name);
+            return len < 4 || std::strcmp(name + len - 4, "_Set") != 0;
+        }
+        default:
+            return true;
+        }
+    }
+
+    static uint32_t fnv1a(const char* s)
+    {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < k_name_size && s[i] != '\0'; ++i)
+            h = (h ^ static_cast<uint8_t>(s[i])) * 16777619u;
+        return h;
+    }
+};
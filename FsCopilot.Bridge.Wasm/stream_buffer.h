@@ -1,5 +1,6 @@
 ﻿#pragma once
-#include <deque>
+#include <cstddef>
+#include <cstdint>
 
 template <typename T> struct timed_sample
 {
@@ -7,87 +8,144 @@ template <typename T> struct timed_sample
     T      value;
 };
 
-template <typename T> class stream_buffer
+// Fixed-capacity ring of timed samples, no allocation after construction. When full the
+// oldest sample is dropped. Segment lookup starts from the segment found last frame, render
+// time moves forward so that is O(1) amortized, with a binary search as fallback.
+//
+// Interp is the interpolation policy, see fsc::interp::linear and fsc::interp::hermite. It gets
+// the segment [a, b] and its neighbours p0 and p3, which repeat a and b at the ends of the buffer.
+template <typename T, typename Interp, size_t Capacity = 32, uint32_t MaxAgeMs = 3000> class stream_buffer
 {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
   public:
     void push(double t_local, const T& v)
     {
         if (t_local - last_time_ < 0.2)
         {
-            pending_ = {t_local, v};
-            has_pending_ = true;
+            pending_        = {t_local, v};
+            has_pending_    = true;
+            pending_in_buf_ = false;
             return;
         }
         last_time_ = t_local;
         prune(t_local);
-        buf_.push_back({t_local, v});
+        push_back({t_local, v});
     }
 
-    template <typename LerpFn> bool interpolate(double t_render, T& out, LerpFn lerp_fn)
+    bool interpolate(double t_render, T& out)
     {
-        const auto n = buf_.size();
-        // if (n < 2)
-        //     return false;
+        const uint32_t n = size();
 
         if (n == 0) return false;
 
-        if (has_pending_ && t_render >= buf_[n - 1].t_local)
+        if (has_pending_ && t_render >= at(n - 1).t_local)
         {
-            if (pending_.t_local >= buf_[n - 1].t_local)
+            if (pending_.t_local >= at(n - 1).t_local)
             {
-                buf_.push_back(pending_);
+                // the pending sample stays pending until something newer arrives, don't append it twice.
+                if (!pending_in_buf_)
+                {
+                    push_back(pending_);
+                    pending_in_buf_ = true;
+                }
                 return false;
             }
             has_pending_ = false;
         }
 
         // if only one sample, we can only hold it.
-        if (n == 1) { out = buf_[0].value; return true; }
+        if (n == 1) { out = at(0).value; return true; }
 
         // if asked time is after the last sample, hold last.
-        if (t_render >= buf_[n - 1].t_local)
+        if (t_render >= at(n - 1).t_local)
         {
-            out = buf_[n - 1].value;
+            out = at(n - 1).value;
             return true;
         }
 
         // if asked time is before the first sample, hold first.
-        if (t_render <= buf_[0].t_local) { out = buf_[0].value; return true; }
+        if (t_render <= at(0).t_local) { out = at(0).value; return true; }
 
         // find segment [i, i+1] containing t_render
-        uint32_t i = 0;
-        while (i + 1 < n && buf_[i + 1].t_local < t_render)
-            ++i;
-
-        // i+1 must exist because we handled t_render < last above.
-        // if (i + 1 >= n)
-        //     return false;
-
-        const auto& a = buf_[i];
-        const auto& b = buf_[i + 1];
+        const uint32_t i = find_segment(t_render, n);
 
-        // if (t_render < a.t_local || t_render > b.t_local)
-        //     return false;
+        const auto& a  = at(i);
+        const auto& b  = at(i + 1);
+        const auto& p0 = i > 0 ? at(i - 1) : a;
+        const auto& p3 = i + 2 < n ? at(i + 2) : b;
 
         const double dt    = b.t_local - a.t_local;
         const double alpha = dt <= 1e-9 ? 0.0 : (t_render - a.t_local) / dt;
 
-        lerp_fn(a.value, b.value, alpha, out);
+        Interp::blend(p0, a, b, p3, alpha, out);
         return true;
     }
 
+    uint32_t size() const
+    {
+        return tail_ - head_;
+    }
+
   private:
-    std::deque<timed_sample<T>> buf_;
+    static constexpr uint32_t k_mask        = static_cast<uint32_t>(Capacity - 1);
+    static constexpr double   k_max_age_sec = MaxAgeMs / 1000.0;
 
-    static constexpr double k_max_age_sec = 3.0;
-    double last_time_ = 0;
+    timed_sample<T> buf_[Capacity]{};
+    uint32_t        head_   = 0; // sequence number of the oldest sample
+    uint32_t        tail_   = 0; // sequence number of the next sample
+    uint32_t        cursor_ = 0; // sequence number of the segment start found last
+
+    double          last_time_ = 0;
     timed_sample<T> pending_{};
-    bool has_pending_ = false;
+    bool            has_pending_    = false;
+    bool            pending_in_buf_ = false;
+
+    const timed_sample<T>& at(const uint32_t i) const
+    {
+        return buf_[(head_ + i) & k_mask];
+    }
+
+    void push_back(const timed_sample<T>& s)
+    {
+        if (size() == Capacity)
+            ++head_;
+        buf_[tail_ & k_mask] = s;
+        ++tail_;
+    }
+
+    // First i with at(i).t_local < t_render <= at(i + 1).t_local, given at(0) < t_render < at(n - 1).
+    uint32_t find_segment(const double t_render, const uint32_t n)
+    {
+        // try the last segment and the one after it
+        for (uint32_t i = cursor_ - head_, k = 0; k < 2 && i + 1 < n; ++i, ++k)
+        {
+            if (at(i).t_local < t_render && at(i + 1).t_local >= t_render)
+            {
+                cursor_ = head_ + i;
+                return i;
+            }
+        }
+
+        // first j in [1, n-1] with at(j).t_local >= t_render
+        uint32_t lo = 1, hi = n - 1;
+        while (lo < hi)
+        {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (at(mid).t_local < t_render)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        cursor_ = head_ + lo - 1;
+        return lo - 1;
+    }
 
     void prune(const double now)
     {
         const double min_t = now - k_max_age_sec;
-        while (!buf_.empty() && buf_.front().t_local < min_t)
-            buf_.pop_front();
+        while (size() > 0 && at(0).t_local < min_t)
+            ++head_;
     }
 };
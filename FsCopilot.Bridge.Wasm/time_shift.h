@@ -1,30 +1,168 @@
 ﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 
+// Maps a peer's millisecond clock to local seconds. Every packet gives local_now - client_time,
+// which is the clock offset plus that packet's network delay. Delay is never negative, so the
+// smallest value in each bucket of client time is the best look at the offset. A line fitted
+// through the bucket minima of a sliding window gives the offset and the skew between the two
+// clocks, delay spikes don't move it.
 struct time_shift
 {
-    bool   init      = false;
-    double offset_ms = 0.0; // localMs - clientMs
+    static constexpr size_t k_buckets    = 32;   // sliding window, in buckets
+    static constexpr double k_bucket_sec = 1.0;  // client time per bucket
+    static constexpr size_t k_min_fit    = 4;    // settled buckets needed before skew is estimated
+    static constexpr double k_max_skew   = 1e-3; // 1000 ppm, anything beyond is noise
+    static constexpr double k_reset_sec  = 5.0;  // packets off the fit by more than this are outliers,
+    static constexpr size_t k_reset_run  = 20;   // and this many in a row mean the peer clock restarted
 
-    double to_local_ms(const double local_now_sec, const uint32_t client_ms, const double smoothing = 0.01)
+    double to_local_sec(const double local_now_sec, const uint32_t client_ms)
     {
-        const double local_ms = local_now_sec * 1000.0;
+        const double client_sec = unwrap(client_ms);
+        observe(client_sec, local_now_sec - client_sec);
+        return client_sec + offset_at(client_sec);
+    }
+
+    double to_local_ms(const double local_now_sec, const uint32_t client_ms)
+    {
+        return to_local_sec(local_now_sec, client_ms) * 1000.0;
+    }
+
+    // local - client, seconds, at the newest client time
+    double offset_sec() const
+    {
+        return offset_;
+    }
+
+    // local seconds gained per client second
+    double skew() const
+    {
+        return skew_;
+    }
+
+  private:
+    struct bucket
+    {
+        int64_t id;
+        double  client_sec; // client time of the smallest delay
+        double  delay_sec;  // local - client, smallest in the bucket
+    };
 
-        if (!init)
+    bucket   buckets_[k_buckets]{};
+    size_t   count_    = 0; // buckets filled, newest at (count_ - 1) % k_buckets
+    size_t   outliers_ = 0;
+    bool     init_     = false;
+    uint32_t last_raw_ = 0;
+    int64_t  ext_ms_   = 0; // client_ms with the 32-bit rollovers added back
+    double   ref_sec_  = 0; // client time the fit is relative to
+    double   offset_   = 0; // fit value at ref_sec_
+    double   skew_     = 0;
+
+    // time_ms wraps every ~49.7 days, follow it by the signed difference to the previous packet,
+    // that also keeps reordered packets in place.
+    double unwrap(const uint32_t raw)
+    {
+        if (!init_)
         {
-            offset_ms = local_ms - static_cast<double>(client_ms);
-            init      = true;
+            ext_ms_ = raw;
+            init_   = true;
         }
         else
+            ext_ms_ += static_cast<int32_t>(raw - last_raw_);
+        last_raw_ = raw;
+        return static_cast<double>(ext_ms_) / 1000.0;
+    }
+
+    double offset_at(const double client_sec) const
+    {
+        return offset_ + skew_ * (client_sec - ref_sec_);
+    }
+
+    void observe(const double client_sec, const double delay_sec)
+    {
+        const auto id = static_cast<int64_t>(client_sec / k_bucket_sec);
+
+        if (count_ > 0 && std::abs(delay_sec - offset_at(client_sec)) > k_reset_sec)
         {
-            const double desired = local_ms - static_cast<double>(client_ms);
-            offset_ms += (desired - offset_ms) * smoothing;
+            if (++outliers_ < k_reset_run)
+                return;
+            count_ = 0;
         }
+        outliers_ = 0;
+
+        if (count_ > 0)
+        {
+            // a late packet may still belong to a bucket in the window
+            for (size_t k = 0; k < std::min(count_, k_buckets); ++k)
+            {
+                bucket& b = buckets_[(count_ - 1 - k) % k_buckets];
+                if (b.id == id)
+                {
+                    if (delay_sec < b.delay_sec)
+                    {
+                        b.client_sec = client_sec;
+                        b.delay_sec  = delay_sec;
+                        fit();
+                    }
+                    return;
+                }
+                if (b.id < id)
+                    break;
+            }
 
-        return static_cast<double>(client_ms) + offset_ms;
+            // a bucket we have no packet for, or older than the window
+            if (id < buckets_[(count_ - 1) % k_buckets].id)
+                return;
+        }
+
+        buckets_[count_ % k_buckets] = {id, client_sec, delay_sec};
+        ++count_;
+        fit();
     }
 
-    double to_local_sec(const double local_now_sec, const uint32_t client_ms, const double smoothing = 0.01)
+    void fit()
     {
-        return to_local_ms(local_now_sec, client_ms, smoothing) / 1000.0;
+        const size_t  n      = std::min(count_, k_buckets);
+        const bucket& newest = buckets_[(count_ - 1) % k_buckets];
+        ref_sec_             = newest.client_sec;
+
+        if (n <= k_min_fit)
+        {
+            offset_ = newest.delay_sec;
+            for (size_t i = 0; i < n; ++i)
+                offset_ = std::min(offset_, buckets_[i].delay_sec);
+            skew_ = 0.0;
+            return;
+        }
+
+        // the newest bucket is still filling, its minimum is not settled yet.
+        const size_t skip = (count_ - 1) % k_buckets;
+        const double m    = static_cast<double>(n - 1);
+
+        double sx = 0, sy = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i == skip)
+                continue;
+            sx += buckets_[i].client_sec - ref_sec_;
+            sy += buckets_[i].delay_sec;
+        }
+        const double mx = sx / m;
+        const double my = sy / m;
+
+        double sxx = 0, sxy = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i == skip)
+                continue;
+            const double dx = buckets_[i].client_sec - ref_sec_ - mx;
+            sxx += dx * dx;
+            sxy += dx * (buckets_[i].delay_sec - my);
+        }
+
+        skew_   = sxx > 1e-9 ? std::clamp(sxy / sxx, -k_max_skew, k_max_skew) : 0.0;
+        offset_ = my - skew_ * mx;
     }
-};
\ No newline at end of file
+};
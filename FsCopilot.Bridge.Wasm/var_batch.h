@@ -0,0 +1,194 @@
+﻿#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+namespace fsc::protocol
+{
+// Packs the variables changed in one poll into a var_batch frame. 0/1 values are collected
+// into rec_bits bitsets, whole numbers are narrowed to the smallest integer that holds them and
+// the rest go out as f32 when that is lossless, f64 otherwise.
+class var_batch_writer
+{
+  public:
+    static constexpr size_t k_max_bits = 255;
+
+    void reset()
+    {
+        used_   = 0;
+        count_  = 0;
+        n_bits_ = 0;
+    }
+
+    bool empty() const
+    {
+        return count_ == 0 && n_bits_ == 0;
+    }
+
+    // Appends one value, with the name record in front of it when `name` is set.
+    // Returns false when the frame has no room left, the caller retries on the next poll.
+    bool add(const uint16_t handle, const char* name, const double value)
+    {
+        const size_t name_len  = name != nullptr ? std::strlen(name) : 0;
+        const size_t name_size = name != nullptr ? 4 + name_len : 0;
+        if (name_len > 0xFF)
+            return false;
+
+        const bool       is_bit     = value == 0.0 || value == 1.0;
+        const var_record tag        = is_bit ? rec_bits : classify(value);
+        const size_t     value_size = is_bit ? 0 : 3 + payload_size(tag);
+
+        if (name_size + value_size > free_space(is_bit ? n_bits_ + 1 : n_bits_))
+            return false;
+        if (is_bit && n_bits_ == k_max_bits)
+            return false;
+
+        if (name != nullptr)
+        {
+            put_u8(rec_name);
+            put_u16(handle);
+            put_u8(static_cast<uint8_t>(name_len));
+            put(name, name_len);
+            ++count_;
+        }
+
+        if (is_bit)
+        {
+            bit_handles_[n_bits_] = handle;
+            bit_values_[n_bits_]  = value != 0.0;
+            ++n_bits_;
+            return true;
+        }
+
+        put_u8(tag);
+        put_u16(handle);
+        switch (tag)
+        {
+        case rec_i8:
+            put_u8(static_cast<uint8_t>(static_cast<int8_t>(value)));
+            break;
+        case rec_i16:
+        {
+            const int16_t v = static_cast<int16_t>(value);
+            put(&v, sizeof(v));
+            break;
+        }
+        case rec_i32:
+        {
+            const int32_t v = static_cast<int32_t>(value);
+            put(&v, sizeof(v));
+            break;
+        }
+        case rec_f32:
+        {
+            const float v = static_cast<float>(value);
+            put(&v, sizeof(v));
+            break;
+        }
+        default:
+            put(&value, sizeof(value));
+            break;
+        }
+        ++count_;
+        return true;
+    }
+
+    // Writes out the pending bitset and returns the finished frame.
+    const var_batch& finish(const uint32_t seq)
+    {
+        if (n_bits_ > 0)
+        {
+            put_u8(rec_bits);
+            put_u8(static_cast<uint8_t>(n_bits_));
+            for (size_t i = 0; i < n_bits_; ++i)
+                put_u16(bit_handles_[i]);
+
+            for (size_t i = 0; i < n_bits_; i += 8)
+            {
+                uint8_t byte = 0;
+                for (size_t b = 0; b < 8 && i + b < n_bits_; ++b)
+                    byte |= static_cast<uint8_t>(bit_values_[i + b] << b);
+                put_u8(byte);
+            }
+            ++count_;
+            n_bits_ = 0;
+        }
+
+        frame_.seq   = seq;
+        frame_.count = count_;
+        frame_.size  = static_cast<uint16_t>(used_);
+        return frame_;
+    }
+
+  private:
+    var_batch frame_{};
+    size_t    used_   = 0;
+    uint16_t  count_  = 0;
+    size_t    n_bits_ = 0;
+    uint16_t  bit_handles_[k_max_bits]{};
+    bool      bit_values_[k_max_bits]{};
+
+    static var_record classify(const double v)
+    {
+        if (std::trunc(v) == v)
+        {
+            if (v >= INT8_MIN && v <= INT8_MAX)
+                return rec_i8;
+            if (v >= INT16_MIN && v <= INT16_MAX)
+                return rec_i16;
+            if (v >= INT32_MIN && v <= INT32_MAX)
+                return rec_i32;
+        }
+        // NaN and the infinities keep their meaning as f32, a finite value past FLT_MAX cannot be
+        // narrowed at all
+        if (!std::isfinite(v))
+            return rec_f32;
+        if (std::fabs(v) <= FLT_MAX && static_cast<double>(static_cast<float>(v)) == v)
+            return rec_f32;
+        return rec_f64;
+    }
+
+    static size_t payload_size(const var_record tag)
+    {
+        switch (tag)
+        {
+        case rec_i8:
+            return 1;
+        case rec_i16:
+            return 2;
+        case rec_i32:
+        case rec_f32:
+            return 4;
+        default:
+            return 8;
+        }
+    }
+
+    size_t free_space(const size_t n_bits) const
+    {
+        const size_t bits_size = n_bits == 0 ? 0 : 2 + n_bits * 2 + (n_bits + 7) / 8;
+        const size_t reserved  = used_ + bits_size;
+        return reserved >= sizeof(frame_.data) ? 0 : sizeof(frame_.data) - reserved;
+    }
+
+    void put(const void* src, const size_t n)
+    {
+        std::memcpy(frame_.data + used_, src, n);
+        used_ += n;
+    }
+
+    void put_u8(const uint8_t v)
+    {
+        frame_.data[used_++] = v;
+    }
+
+    void put_u16(const uint16_t v)
+    {
+        put(&v, sizeof(v));
+    }
+};
+} // namespace fsc::protocol
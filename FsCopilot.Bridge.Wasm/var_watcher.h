@@ -1,30 +1,70 @@
 ﻿#pragma once
 
-#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
 
-#include <MSFS/Legacy/gauges.h> // execute_calculator_code
+#include "calc_expr.h"
 
-typedef void (*var_update_callback)(
+// Returns false to leave the value pending, it is offered again on the next poll.
+typedef bool (*var_update_callback)(
+    uint32_t handle,
     const char* name,
     double value,
     void* user_data
 );
 
+// Watched variables are kept in dense parallel arrays indexed by slot, so poll() walks
+// contiguous memory. Every name and units pair gets a stable handle for the lifetime of the
+// watcher that survives unwatch/watch churn; slots are swap-removed and the handle -> slot table
+// is patched. The name index is only touched by watch() and unwatch(). The same name read in
+// other units is a separate watch with its own handle.
+//
+// Each watch belongs to a rate class: every frame, N Hz or background. Slower classes are
+// read round-robin with a per-frame share proportional to their rate, so a class of 600
+// variables at 2 Hz costs about 20 reads per frame at 60 fps instead of 600 reads every 30th frame.
+//
+// sleep() makes the watcher dormant when the desktop app goes quiet: poll() does nothing, but the
+// watches, their compiled expressions and last values stay, so after wake() only variables that
+// changed in between are reported. set_hash() identifies the watch set, the app sends the same
+// hash of its own set when it reconnects.
 class var_watcher
 {
 public:
-    struct watch_entry
+    typedef uint32_t handle;
+
+    static constexpr handle   invalid_handle = 0xFFFFFFFFu;
+    static constexpr uint32_t invalid_slot   = 0xFFFFFFFFu;
+
+    // rate values, anything in between is a rate in Hz
+    static constexpr uint8_t rate_every_frame   = 0;
+    static constexpr uint8_t rate_background    = 255;
+    static constexpr size_t  k_background_reads = 4; // per frame
+    static constexpr size_t  k_block            = 64; // slots polled between two more() checks, one dirty_ word
+
+    struct rate_class
     {
-        std::string wrapped_expr; // "(name, units)" or "(name)"
-        double      last_value;
-        bool        has_last;
+        uint8_t             rate;
+        std::vector<handle> members;
+        size_t              cursor;
+        double              credit; // fractional reads carried to the next frame
+        uint32_t            reads;  // reads scheduled by the last poll()
+    };
 
-        watch_entry() : wrapped_expr(), last_value(0.0), has_last(false) {}
-        explicit watch_entry(const std::string& expr)
-            : wrapped_expr(expr), last_value(0.0), has_last(false)
-        {
-        }
+    struct counters
+    {
+        uint32_t compiled; // expressions compiled by watch()
+        uint32_t shared;   // watch() calls served by an existing entry
+        uint32_t reads;    // evaluations done by the last poll() call
+        uint32_t changed;  // callbacks fired by the last poll() call
     };
 
     explicit var_watcher(double epsilon = 1e-6)
@@ -32,26 +72,163 @@ public:
     {
     }
 
-    bool watch(const char* name, const char* units)
+    // Returns the handle of the watched variable, or invalid_handle if it can't be compiled.
+    // Watching an already watched variable at a faster rate moves it to the faster class.
+    handle watch(const char* name, const char* units, const uint8_t rate = rate_every_frame)
     {
-        const std::string key(name);
+        if (fsc::calc::is_empty_cstr(name))
+            return invalid_handle;
 
-        if (vars_.find(key) != vars_.end())
-            return false;
+        handle h = find(name, units);
+        if (h != invalid_handle && slot_of_[h] != invalid_slot)
+        {
+            if (rank(rate) > rank(classes_[class_of_[h]].rate))
+            {
+                leave_class(h);
+                join_class(h, rate);
+            }
+            ++stats_.shared;
+            return h;
+        }
 
-        vars_[key] = watch_entry(wrap_expression(name, units));
-        return true;
+        fsc::calc::compiled_expr expr;
+        if (!fsc::calc::compile(name, units, expr))
+            return invalid_handle;
+
+        if (h == invalid_handle)
+            h = intern(name, units);
+
+        slot_of_[h] = static_cast<uint32_t>(handles_.size());
+        handles_.push_back(h);
+        exprs_.push_back(std::move(expr));
+        last_.push_back(0.0);
+        values_.push_back(0.0);
+        has_last_.push_back(0);
+        held_.push_back(0);
+        due_.push_back(0);
+        every_.push_back(0);
+        dirty_.resize(words(handles_.size()), 0);
+        join_class(h, rate);
+        set_hash_ += name_hash(name_of(h), units_of(h));
+
+        ++stats_.compiled;
+        return h;
     }
 
-    void unwatch(const char* name)
+    // Returns the handle of a name without watching it, so it can be addressed by handle.
+    handle resolve(const char* name, const char* units = "")
     {
-        vars_.erase(std::string(name));
+        if (fsc::calc::is_empty_cstr(name))
+            return invalid_handle;
+
+        const handle h = find(name, units);
+        return h != invalid_handle ? h : intern(name, units);
     }
 
+    void unwatch(const char* name, const char* units)
+    {
+        unwatch(find(name, units));
+    }
+
+    void unwatch(const handle h)
+    {
+        if (h >= slot_of_.size())
+            return;
+
+        const uint32_t slot = slot_of_[h];
+        if (slot == invalid_slot)
+            return;
+
+        // A slot the pass under way has already read is refilled from the last slot it read, and
+        // that one from the tail, so the tail stays ahead of the cursor and is still read.
+        const uint32_t tail = static_cast<uint32_t>(handles_.size() - 1);
+        uint32_t       hole = slot;
+        if (cursor_ > 0 && cursor_ < handles_.size() && slot < cursor_)
+        {
+            const uint32_t last_read = static_cast<uint32_t>(--cursor_);
+            move_slot(last_read, hole);
+            hole = last_read;
+        }
+        move_slot(tail, hole);
+
+        handles_.pop_back();
+        exprs_.pop_back();
+        last_.pop_back();
+        values_.pop_back();
+        has_last_.pop_back();
+        held_.pop_back();
+        due_.pop_back();
+        every_.pop_back();
+        dirty_.resize(words(handles_.size()));
+
+        leave_class(h);
+        slot_of_[h] = invalid_slot;
+        set_hash_ -= name_hash(name_of(h), units_of(h));
+    }
+
+    // Drops every watch. Handles stay assigned to their names, a later watch() of the same name returns the same handle.
     void clear()
     {
-        if (vars_.empty()) return;
-        vars_.clear();
+        if (handles_.empty()) return;
+
+        std::fill(slot_of_.begin(), slot_of_.end(), invalid_slot);
+        cursor_   = 0;
+        set_hash_ = 0;
+
+        handles_.clear();
+        exprs_.clear();
+        last_.clear();
+        values_.clear();
+        has_last_.clear();
+        held_.clear();
+        due_.clear();
+        every_.clear();
+        dirty_.clear();
+
+        for (auto& c : classes_)
+        {
+            c.members.clear();
+            c.cursor = 0;
+            c.credit = 0.0;
+        }
+    }
+
+    // Forgets the last values, so the next poll reports every watched variable.
+    void invalidate()
+    {
+        std::fill(has_last_.begin(), has_last_.end(), 0);
+    }
+
+    // Same for one watch.
+    void invalidate(const handle h)
+    {
+        if (h < slot_of_.size() && slot_of_[h] != invalid_slot)
+            has_last_[slot_of_[h]] = 0;
+    }
+
+    // Stops polling until wake(). A pass under way is dropped.
+    void sleep()
+    {
+        dormant_ = true;
+        cursor_  = 0;
+    }
+
+    void wake()
+    {
+        dormant_   = false;
+        last_poll_ = -1.0;
+    }
+
+    bool dormant() const
+    {
+        return dormant_;
+    }
+
+    // Order independent hash of the watched names, 0 for an empty set. Each name adds the
+    // finalized 64-bit FNV-1a hash of its bytes, see SimClient.WatchSetHash in the desktop app.
+    uint64_t set_hash() const
+    {
+        return set_hash_;
     }
 
     void set_epsilon(double epsilon)
@@ -59,81 +236,312 @@ public:
         epsilon_ = epsilon;
     }
 
-    void poll(var_update_callback cb, void* user_data)
+    const counters& stats() const
     {
-        if (vars_.empty() || cb == 0)
-            return;
+        return stats_;
+    }
+
+    const std::vector<rate_class>& rate_classes() const
+    {
+        return classes_;
+    }
+
+    size_t size() const
+    {
+        return handles_.size();
+    }
+
+    handle find(const char* name, const char* units) const
+    {
+        const auto it = index_.find(key(name, units));
+        return it == index_.end() ? invalid_handle : it->second;
+    }
+
+    bool is_watched(const char* name, const char* units) const
+    {
+        const handle h = find(name, units);
+        return h != invalid_handle && slot_of_[h] != invalid_slot;
+    }
+
+    const char* name_of(handle h) const
+    {
+        return h < name_at_.size() ? names_.data() + name_at_[h] : nullptr;
+    }
+
+    const char* units_of(handle h) const
+    {
+        const char* name = name_of(h);
+        return name != nullptr ? name + std::strlen(name) + 1 : nullptr;
+    }
+
+    void poll(const double now, var_update_callback cb, void* user_data)
+    {
+        (void)poll(now, cb, user_data, [] { return true; });
+    }
+
+    // Same, but stops when more() is false after a block of k_block slots. The next call carries on
+    // with the pass where this one stopped, a new pass is scheduled once the last block is done.
+    // Returns false while the pass is not complete.
+    template <typename More> bool poll(const double now, var_update_callback cb, void* user_data, More more)
+    {
+        stats_.reads   = 0;
+        stats_.changed = 0;
+        if (dormant_)
+            return true;
 
-        for (std::unordered_map<std::string, watch_entry>::iterator it = vars_.begin();
-             it != vars_.end();
-             ++it)
+        const size_t n = handles_.size();
+        if (cursor_ == 0 || cursor_ >= n)
         {
-            const std::string& name = it->first;
-            watch_entry& entry = it->second;
+            const double dt = last_poll_ < 0.0 ? 0.0 : std::min(std::max(now - last_poll_, 0.0), 0.25);
+            last_poll_      = now;
+            cursor_         = 0;
 
-            double new_value = read_calc_double(entry.wrapped_expr.c_str());
+            if (n == 0 || cb == 0)
+                return true;
+
+            schedule(dt);
+        }
 
-            if (!entry.has_last)
+        while (cursor_ < n)
+        {
+            const size_t begin = cursor_;
+            const size_t end   = std::min(n, begin + k_block);
+
+            // read phase, slots that are not due keep their last (or still undelivered) value
+            uint32_t reads = 0;
+            for (size_t i = begin; i < end; ++i)
             {
-                entry.last_value = new_value;
-                entry.has_last = true;
-                cb(name.c_str(), new_value, user_data);
-                continue;
+                if (every_[i] | due_[i] | !has_last_[i])
+                {
+                    values_[i] = fsc::calc::evaluate(exprs_[i]);
+                    ++reads;
+                }
+                else if (!held_[i])
+                {
+                    values_[i] = last_[i];
+                }
             }
+            stats_.reads += reads;
 
-            if (equals(entry.last_value, new_value))
-                continue;
+            // compare phase
+            detect_changes(last_.data() + begin, values_.data() + begin, has_last_.data() + begin, end - begin, epsilon_, dirty_.data() + begin / 64);
 
-            entry.last_value = new_value;
-            cb(name.c_str(), new_value, user_data);
+            // notify phase, callbacks must not watch/unwatch.
+            uint64_t bits = dirty_[begin / 64];
+            while (bits != 0)
+            {
+                const size_t i = begin + static_cast<size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                const handle h = handles_[i];
+                held_[i]       = !cb(h, name_of(h), values_[i], user_data);
+                if (held_[i])
+                    continue;
+
+                last_[i]     = values_[i];
+                has_last_[i] = 1;
+                ++stats_.changed;
+            }
+
+            cursor_ = end;
+            if (cursor_ < n && !more())
+                return false;
         }
+
+        cursor_ = 0;
+        return true;
     }
 
-private:
-    static bool is_empty_cstr(const char* s)
+    // slots the current poll pass has not reached yet
+    size_t pending() const
     {
-        return (s == 0) || (s[0] == '\0');
+        return cursor_ > 0 && cursor_ < handles_.size() ? handles_.size() - cursor_ : 0;
     }
 
-    static std::string wrap_expression(const char* name, const char* units)
+    // Sets bit i of dirty when cur[i] differs from last[i] by more than epsilon or has_last[i] is 0.
+    // Two NaNs compare equal, a NaN against a number is a change.
+    static void detect_changes(const double* last, const double* cur, const uint8_t* has_last, const size_t n, const double epsilon, uint64_t* dirty)
     {
-        std::string wrapped;
-        wrapped.push_back('(');
-        wrapped.append(name);
-
-        if (!is_empty_cstr(units))
+        for (size_t base = 0; base < n; base += 64)
         {
-            wrapped.append(", ");
-            wrapped.append(units);
+            const size_t end  = n - base < 64 ? n : base + 64;
+            uint64_t     bits = 0;
+            size_t       i    = base;
+
+#if defined(__wasm_simd128__)
+            const v128_t eps = wasm_f64x2_splat(epsilon);
+            for (; i + 2 <= end; i += 2)
+            {
+                const v128_t a        = wasm_v128_load(last + i);
+                const v128_t b        = wasm_v128_load(cur + i);
+                const v128_t close    = wasm_f64x2_le(wasm_f64x2_abs(wasm_f64x2_sub(b, a)), eps);
+                const v128_t both_nan = wasm_v128_and(wasm_f64x2_ne(a, a), wasm_f64x2_ne(b, b));
+                const uint32_t same   = wasm_i64x2_bitmask(wasm_v128_or(close, both_nan)) & (has_last[i] | (has_last[i + 1] << 1));
+                bits |= static_cast<uint64_t>(~same & 3u) << (i - base);
+            }
+#endif
+            for (; i < end; ++i)
+            {
+                const double a    = last[i];
+                const double b    = cur[i];
+                const bool   same = (std::fabs(b - a) <= epsilon) | ((a != a) & (b != b));
+                bits |= static_cast<uint64_t>(!(same & (has_last[i] != 0))) << (i - base);
+            }
+
+            dirty[base / 64] = bits;
         }
+    }
 
-        wrapped.push_back(')');
-        return wrapped;
+private:
+    static size_t words(const size_t n)
+    {
+        return (n + 63) / 64;
+    }
+
+    // index_ key, "name\0units"
+    static std::string key(const char* name, const char* units)
+    {
+        std::string k(name);
+        k.push_back('\0');
+        if (units != nullptr)
+            k.append(units);
+        return k;
+    }
+
+    handle intern(const char* name, const char* units)
+    {
+        const std::string k = key(name, units);
+        const handle      h = static_cast<handle>(name_at_.size());
+        name_at_.push_back(static_cast<uint32_t>(names_.size()));
+        names_.insert(names_.end(), k.c_str(), k.c_str() + k.size() + 1);
+        slot_of_.push_back(invalid_slot);
+        class_of_.push_back(0);
+        member_at_.push_back(0);
+        index_.emplace(k, h);
+        return h;
+    }
+
+    // finalized 64-bit FNV-1a of "name\0units", mirrored by WatchSetHash in Connection/SimClient.cs
+    static uint64_t name_hash(const char* name, const char* units)
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (; *name != '\0'; ++name)
+            h = (h ^ static_cast<uint8_t>(*name)) * 1099511628211ull;
+        h *= 1099511628211ull; // the '\0' between name and units
+        for (; *units != '\0'; ++units)
+            h = (h ^ static_cast<uint8_t>(*units)) * 1099511628211ull;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // every frame > faster Hz > slower Hz > background
+    static int rank(const uint8_t rate)
+    {
+        return rate == rate_every_frame ? 256 : rate == rate_background ? 0 : rate;
+    }
+
+    void join_class(const handle h, const uint8_t rate)
+    {
+        size_t c = 0;
+        while (c < classes_.size() && classes_[c].rate != rate)
+            ++c;
+        if (c == classes_.size())
+            classes_.push_back({rate, {}, 0, 0.0, 0});
+
+        class_of_[h]        = static_cast<uint8_t>(c);
+        member_at_[h]       = static_cast<uint32_t>(classes_[c].members.size());
+        every_[slot_of_[h]] = rate == rate_every_frame;
+        classes_[c].members.push_back(h);
     }
 
-    static double read_calc_double(const char* wrapped_expression)
+    // Moves slot from into slot to, whose watch is being removed, and repoints its handle.
+    void move_slot(const uint32_t from, const uint32_t to)
     {
-        double result = 0.0;
-        execute_calculator_code(wrapped_expression, &result, 0, 0);
-        return result;
+        if (from == to)
+            return;
+
+        handles_[to]  = handles_[from];
+        exprs_[to]    = std::move(exprs_[from]);
+        last_[to]     = last_[from];
+        values_[to]   = values_[from];
+        has_last_[to] = has_last_[from];
+        held_[to]     = held_[from];
+        due_[to]      = due_[from];
+        every_[to]    = every_[from];
+
+        slot_of_[handles_[to]] = to;
     }
 
-    static bool is_nan(double x)
+    void leave_class(const handle h)
     {
-        return x != x;
+        auto&          members = classes_[class_of_[h]].members;
+        const uint32_t at      = member_at_[h];
+
+        members[at]             = members.back();
+        member_at_[members[at]] = at;
+        members.pop_back();
     }
 
-    bool equals(double a, double b) const
+    // Marks the slots each class reads this frame, continuing round-robin where the last frame
+    // stopped. The every frame class is read through every_ and needs no marks.
+    void schedule(const double dt)
     {
-        if (is_nan(b))
-            return false;
+        std::fill(due_.begin(), due_.end(), 0);
+
+        for (auto& c : classes_)
+        {
+            const size_t m = c.members.size();
+            if (c.rate == rate_every_frame)
+            {
+                c.reads = static_cast<uint32_t>(m);
+                continue;
+            }
 
-        double d = b - a;
-        if (d < 0.0) d = -d;
-        return d <= epsilon_;
+            size_t k = std::min(m, k_background_reads);
+            if (c.rate != rate_background)
+            {
+                c.credit = std::min(c.credit + static_cast<double>(m) * c.rate * dt, static_cast<double>(m));
+                k        = static_cast<size_t>(c.credit);
+                c.credit -= static_cast<double>(k);
+            }
+
+            for (size_t j = 0; j < k; ++j)
+            {
+                if (c.cursor >= m)
+                    c.cursor = 0;
+                due_[slot_of_[c.members[c.cursor++]]] = 1;
+            }
+            c.reads = static_cast<uint32_t>(k);
+        }
     }
 
 private:
-    std::unordered_map<std::string, watch_entry> vars_;
-    double epsilon_;
-};
\ No newline at end of file
+    // per handle, side index used at watch/unwatch time only
+    std::unordered_map<std::string, handle> index_;
+    std::vector<char>                       names_;   // interned "name\0units\0" pairs
+    std::vector<uint32_t>                   name_at_; // handle -> offset in names_
+    std::vector<uint32_t>                   slot_of_; // handle -> slot, invalid_slot when not watched
+    std::vector<uint8_t>                    class_of_;  // handle -> index in classes_
+    std::vector<uint32_t>                   member_at_; // handle -> index in its class members
+    std::vector<rate_class>                 classes_;
+
+    // per slot, dense
+    std::vector<handle>                   handles_;
+    std::vector<fsc::calc::compiled_expr> exprs_;
+    std::vector<double>                   last_;
+    std::vector<double>                   values_;
+    std::vector<uint8_t>                  has_last_;
+    std::vector<uint8_t>                  held_; // changed value the callback did not take yet
+    std::vector<uint8_t>                  due_;   // read this frame
+    std::vector<uint8_t>                  every_; // member of the every frame class, always due
+    std::vector<uint64_t>                 dirty_;
+
+    double   epsilon_;
+    double   last_poll_ = -1.0;
+    size_t   cursor_    = 0; // first slot of the next block, 0 when no pass is under way
+    uint64_t set_hash_  = 0;
+    bool     dormant_   = false;
+    counters stats_ = {};
+};
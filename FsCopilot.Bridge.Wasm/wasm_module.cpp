@@ -1,31 +1,124 @@
 ﻿#include "wasm_module.h"
 #include "var_watcher.h"
+#include "var_batch.h"
+#include "motion_codec.h"
+#include "bus_frame.h"
+#include "frame_budget.h"
+#include "set_queue.h"
+#include "watch_list.h"
 #include <SimConnect.h>
+#include <algorithm>
 #include <chrono>
-#include <unordered_map>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <MSFS/MSFS.h>
 #include <MSFS/MSFS_CommBus.h>
 #include <MSFS/MSFS_WindowsTypes.h>
 #include <MSFS/Legacy/gauges.h>
+#ifdef FSC_HOST
+#include <fsc_host.h>
+#endif
 
 namespace
 {
-constexpr auto k_version = "1.1";
+constexpr auto k_version = "1.7";
+
+#ifdef FSC_HOST
+using module_clock = fsc::host::clock; // host tests move the time by hand
+
+const char* record_path()
+{
+    return fsc::host::record_path().c_str();
+}
+
+const char* replay_path()
+{
+    return fsc::host::replay_path().c_str();
+}
+#else
+using module_clock = std::chrono::steady_clock;
+
+const char* record_path()
+{
+    return k_record_path;
+}
+
+const char* replay_path()
+{
+    return k_replay_path;
+}
+#endif
+
+// first desktop version that reads FSC_VARIABLE_BATCH, older ones get one var_set per change.
+constexpr int k_batch_version = 102;
+// first desktop version that learns handles from FSC_WATCH_ACK, older ones get names in the batch.
+constexpr int k_handle_version = 103;
+// first desktop version that reads FSC_BUS_FRAME_OUT, older ones get one str_msg per gauge event.
+constexpr int k_bus_version = 106;
 
 enum : DWORD // NOLINT(performance-enum-size)
 {
     def_state        = 0xF000,
     def_clock        = 0xF001,
+    def_physics_set  = 0xF002,
+    def_aileron_set  = 0xF003,
+    def_elevator_set = 0xF004,
+    def_rudder_set   = 0xF005,
+    evt_ailerons_set = 0xF010,
+    evt_elevator_set = 0xF011,
+    evt_rudder_set   = 0xF012,
+    def_levers_set   = 0xF020, // first of one definition per channels<levers> row
     def_ready        = 0xF101,
+    def_hello        = 0xF102,
     def_control      = 0xF103,
+    def_stats        = 0xF104,
     def_comm_bus_out = 0xF501,
     def_comm_bus_in  = 0xF502,
     def_watch        = 0xF503,
     def_unwatch      = 0xF504,
     def_variable     = 0xF505,
     def_set          = 0xF506,
+    def_var_batch    = 0xF507,
+    def_watch_h      = 0xF508,
+    def_watch_ack    = 0xF509,
+    def_unwatch_h    = 0xF50A,
+    def_set_h        = 0xF50B,
+    def_bus_out      = 0xF50C,
+    def_bus_in       = 0xF50D,
+    def_watch_list   = 0xF50E,
+    def_snapshot     = 0xF50F,
+    def_snapshot_ack = 0xF510,
     def_physics      = 0xF901,
-    def_surfaces     = 0xF902
+    def_surfaces     = 0xF902,
+    def_motion       = 0xF903,
+    def_levers       = 0xF904
+};
+
+// client data requests, numbered densely so dispatch can index k_handlers with them
+enum request : DWORD // NOLINT(performance-enum-size)
+{
+    req_clock,
+    req_hello,
+    req_control,
+    req_physics,
+    req_surfaces,
+    req_motion,
+    req_levers,
+    req_comm_bus_in,
+    req_bus_in,
+    req_watch,
+    req_unwatch,
+    req_set,
+    req_watch_h,
+    req_unwatch_h,
+    req_set_h,
+    req_watch_list,
+    req_snapshot_ack,
+    req_count
 };
 
 struct freeze_state
@@ -39,20 +132,92 @@ struct freeze_state
 
 static_assert(sizeof(freeze_state) == 20);
 
-HANDLE                                h_sim = 0;
-std::chrono::steady_clock::time_point g_start;
-double                                g_last_seen           = 0;
-volatile bool                         has_standalone_update = false;
-bool                                  frz_by_me             = false;
-freeze_state                          frz;
-var_watcher                           watcher(1e-6);
+HANDLE                   h_sim = 0;
+module_clock::time_point g_start;
+double                   g_last_seen           = 0;
+volatile bool            has_standalone_update = false;
+bool                     frz_by_me             = false;
+freeze_state             frz;
+var_watcher              watcher(1e-6);
+int                      peer_version = 0;
+
+fsc::protocol::var_batch_writer batch;
+uint32_t                        batch_seq = 0;
+std::vector<uint8_t>            announced; // per watcher handle, name already sent in a batch
+fsc::protocol::var_acks         acks{};
+
+// The answer to a watch list: the value of every variable in it, collected by the poll pass that
+// starts after the list and sent in var_snapshot parts. Deltas of those variables wait until the
+// desktop app acks the snapshot, the other watches go on in the regular batches.
+enum class snapshot_state : uint8_t
+{
+    idle,
+    capturing,
+    sent
+};
+
+struct snapshot_job
+{
+    snapshot_state state        = snapshot_state::idle;
+    uint32_t       id           = 0;
+    uint32_t       part         = 0;
+    bool           pass_started = false; // the end of this pass completes the capture
+    double         sent_at      = 0;
 
-stream_buffer<fsc::protocol::physics>  phys_buf;
-stream_buffer<fsc::protocol::surfaces> ctrl_buf;
+    std::vector<uint8_t> listed;  // per watcher handle, in a watch list whose last part is still to come
+    std::vector<uint8_t> members; // per watcher handle, in this snapshot
+};
 
-std::unordered_map<uint64_t, time_shift> t_shifts;
+snapshot_job                    snapshot;
+fsc::protocol::var_batch_writer snapshot_batch;
+fsc::protocol::var_snapshot     snapshot_frame{};
 
-void apply_physics(const fsc::protocol::physics& p)
+// buffer for a struct streamed per channels<T>
+template <typename T> using channel_buffer = stream_buffer<T, fsc::interp::linear, k_stream_capacity, k_max_age_ms>;
+
+// One playout pipeline per remote session, samples from different timelines never share a buffer.
+struct session_state
+{
+    time_shift    clock;
+    playout_delay delay{k_delay_sec};
+
+    stream_buffer<fsc::protocol::physics, physics_interp, k_stream_capacity, k_max_age_ms>        phys;
+    stream_buffer<fsc::protocol::surfaces, fsc::interp::linear, k_stream_capacity, k_max_age_ms> ctrl;
+    channel_buffer<fsc::protocol::levers>                                                         levers;
+
+    double started      = -1; // local time of the first physics sample
+    double last_physics = -1;
+};
+
+frame_stats<k_stats> stats;
+log_ring<k_log_level> logger;
+
+session_table<session_state, k_max_sessions> sessions;
+uint64_t                                     active_session = 0; // session being rendered, see select_session()
+uint64_t                                     fade_session   = 0; // session rendered before the last switch
+double                                       fade_start     = 0;
+bool                                         fading         = false;
+fsc::protocol::physics                       fade_from_p{}; // last state of the fading session, held on frames it has no sample for
+fsc::protocol::surfaces                      fade_from_c{};
+bool                                         fade_has_p     = false;
+bool                                         fade_has_c     = false;
+double                                       g_last_stats   = 0;
+
+// the position/attitude/velocity block of protocol::physics, in def_physics_set order.
+constexpr DWORD k_physics_set_size = offsetof(fsc::protocol::physics, session_id);
+static_assert(k_physics_set_size == 13 * sizeof(double));
+
+bool  physics_binary   = k_physics_binary;
+DWORD physics_probe_id = 0; // send id of the first binary write, an exception for it means the sim rejects them
+
+void apply_physics_binary(const fsc::protocol::physics& p)
+{
+    (void)SimConnect_SetDataOnSimObject(h_sim, def_physics_set, SIMCONNECT_OBJECT_ID_USER, 0, 0, k_physics_set_size, const_cast<fsc::protocol::physics*>(&p));
+    if (physics_probe_id == 0)
+        (void)SimConnect_GetLastSentPacketID(h_sim, &physics_probe_id);
+}
+
+void apply_physics_calc(const fsc::protocol::physics& p)
 {
     char cmd[1024];
     (void)snprintf(cmd, sizeof(cmd),
@@ -77,23 +242,138 @@ void apply_physics(const fsc::protocol::physics& p)
     execute_calculator_code(cmd, nullptr, nullptr, nullptr);
 }
 
-void apply_control(const fsc::protocol::surfaces& c)
+void apply_physics(const fsc::protocol::physics& p)
+{
+    const auto timed = stats.time(fsc::protocol::timer_apply_physics);
+    if (physics_binary)
+        apply_physics_binary(p);
+    else
+        apply_physics_calc(p);
+}
+
+// Last surface positions written to the sim. An axis is written again only when it moved past the
+// deadband, all of them every k_surface_refresh_sec so the sim can't drift away from us.
+struct surface_output
+{
+    int32_t  last[3]      = {};
+    bool     valid        = false;
+    double   last_refresh = 0;
+    uint32_t written      = 0; // frames with at least one axis written
+    uint32_t skipped      = 0; // frames with nothing to write
+    uint32_t axes         = 0; // axes written
+};
+
+// Values of a streamed struct last written to the sim, in channels<T> order. A channel is written
+// only when its value changed, NaN marks one that is unknown or left to the aircraft.
+template <typename T> struct channel_output
 {
+    static constexpr size_t count = fsc::interp::channel_lanes<T>::count;
+
+    double   values[count];
+    uint32_t written = 0; // channel writes
+
+    channel_output()
+    {
+        invalidate();
+    }
+
+    // every channel is written again on the next frame
+    void invalidate()
+    {
+        for (auto& v : values)
+            v = std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+// Registers the client data area of channels<T> and one sim data definition per channel, set_def
+// for the first row of the table, set_def + i for row i.
+template <typename T> void register_channels(const DWORD def, const request req, const DWORD set_def)
+{
+    (void)SimConnect_MapClientDataNameToID(h_sim, fsc::interp::channels<T>::area, def);
+    (void)SimConnect_CreateClientData(h_sim, def, sizeof(T), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def, 0, sizeof(T), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def, req, def, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    DWORD d = set_def;
+    for (const auto& c : fsc::interp::channels<T>::table)
+        (void)SimConnect_AddToDataDefinition(h_sim, d++, c.simvar, c.units, SIMCONNECT_DATATYPE_FLOAT64);
+}
+
+// Writes the channels that changed since the last frame, each on its own definition so a moving
+// throttle does not write the gear handle with it.
+template <typename T> void apply_channels(const T& value, const DWORD set_def, channel_output<T>& out)
+{
+    constexpr auto& table = fsc::interp::channels<T>::table;
+
+    for (size_t i = 0; i < std::size(table); ++i)
+    {
+        double v;
+        std::memcpy(&v, reinterpret_cast<const char*>(&value) + table[i].offset, sizeof(double));
+        if (std::isnan(v) || v == out.values[i])
+            continue;
+
+        out.values[i] = v;
+        ++out.written;
+        (void)SimConnect_SetDataOnSimObject(h_sim, set_def + static_cast<DWORD>(i), SIMCONNECT_OBJECT_ID_USER, 0, 0, sizeof(double), &out.values[i]);
+    }
+}
+
+channel_output<fsc::protocol::levers> levers_out;
+
+constexpr DWORD k_surface_defs[3]   = {def_aileron_set, def_elevator_set, def_rudder_set};
+constexpr DWORD k_surface_events[3] = {evt_ailerons_set, evt_elevator_set, evt_rudder_set};
+
+surface_output                surf;
+fsc::protocol::motion_decoder motion;
+fsc::protocol::bus_writer     bus_out;
+fsc::protocol::bus_reader     bus_in;
+set_queue<k_max_queued_sets>  sets;
+frame_budget                  budget(k_frame_budget_us);
+
+// watch and unwatch messages waiting for the tick, each entry is [handler][message]
+fsc::protocol::message_queue<k_registration_queue_size> registrations;
+
+flight_recorder recorder;
+flight_replay   replay;
+bool            replaying = false; // the live stream is ignored from the start of a replay on
+
+// recording time to play up to, `now` counts from module_init like the recording does
+double replay_time(const double now)
+{
+    return replay.start() + now * k_replay_speed;
+}
+
+void apply_control(const fsc::protocol::surfaces& c, const double now)
+{
+    const auto timed = stats.time(fsc::protocol::timer_apply_control);
+
     // correct usage depends on aircraft. we use both
-    char cmd[256];
-    (void)snprintf(cmd, sizeof(cmd),
-                   "%d (>A:AILERON POSITION, Position 16k) "
-                   "%d (>A:ELEVATOR POSITION, Position 16k) "
-                   "%d (>A:RUDDER POSITION, Position 16k)",
-                   c.ail_pos, c.elev_pos, c.rud_pos);
-    execute_calculator_code(cmd, nullptr, nullptr, nullptr);
+    int32_t    axes[3] = {c.ail_pos, c.elev_pos, c.rud_pos};
+    const bool refresh = !surf.valid || now - surf.last_refresh >= k_surface_refresh_sec;
+    bool       wrote   = false;
 
-    (void)snprintf(cmd, sizeof(cmd),
-                   "%d (>K:AXIS_AILERONS_SET) "
-                   "%d (>K:AXIS_ELEVATOR_SET) "
-                   "%d (>K:AXIS_RUDDER_SET)",
-                   -c.ail_pos, -c.elev_pos, -c.rud_pos);
-    execute_calculator_code(cmd, nullptr, nullptr, nullptr);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!refresh && std::abs(axes[i] - surf.last[i]) <= k_surface_deadband)
+            continue;
+
+        (void)SimConnect_SetDataOnSimObject(h_sim, k_surface_defs[i], SIMCONNECT_OBJECT_ID_USER, 0, 0, sizeof(int32_t), &axes[i]);
+        (void)SimConnect_TransmitClientEvent(h_sim, SIMCONNECT_OBJECT_ID_USER, k_surface_events[i], static_cast<DWORD>(-axes[i]), SIMCONNECT_GROUP_PRIORITY_HIGHEST, SIMCONNECT_EVENT_FLAG_GROUPID_IS_PRIORITY);
+        surf.last[i] = axes[i];
+        ++surf.axes;
+        wrote = true;
+    }
+
+    if (refresh)
+    {
+        surf.valid        = true;
+        surf.last_refresh = now;
+    }
+
+    if (wrote)
+        ++surf.written;
+    else
+        ++surf.skipped;
 }
 
 void apply_control(const fsc::protocol::control control)
@@ -117,7 +397,7 @@ void apply_control(const fsc::protocol::control control)
                                 "1 (>K:FREEZE_ATTITUDE_SET)",
                                 nullptr, nullptr, nullptr);
         frz_by_me = true;
-        (void)fprintf(stdout, "Freeze engaged");
+        logger.info("Freeze engaged");
     }
     else if (control.state == 1 && sim_frozen)
     {
@@ -125,9 +405,43 @@ void apply_control(const fsc::protocol::control control)
                                 "0 (>K:FREEZE_ALTITUDE_SET) "
                                 "0 (>K:FREEZE_ATTITUDE_SET)",
                                 nullptr, nullptr, nullptr);
-        frz_by_me = false;
-        (void)fprintf(stdout, "Freeze released");
+        frz_by_me        = false;
+        surf.valid       = false;
+        levers_out.invalidate();
+        logger.info("Freeze released");
+    }
+}
+
+// The newest session that is still sending and has something to play is rendered, so a peer
+// that reconnects takes over from its old session while both are live. The session it replaces
+// fades out over k_crossfade_sec. Without a live candidate the current session keeps playing.
+void select_session(const double now)
+{
+    uint64_t best         = 0;
+    double   best_started = -1;
+    sessions.for_each([&](const uint64_t id, const session_state& session) {
+        if (now - session.last_physics > k_session_live_sec || session.phys.size() < 2)
+            return;
+        if (session.started > best_started)
+        {
+            best         = id;
+            best_started = session.started;
+        }
+    });
+
+    if (best_started < 0 || best == active_session)
+        return;
+
+    fading = sessions.find(active_session) != nullptr;
+    if (fading)
+    {
+        fade_session = active_session;
+        fade_start   = now;
+        fade_has_p   = false;
+        fade_has_c   = false;
     }
+    active_session = best;
+    logger.info("Playing session %llx", static_cast<unsigned long long>(best));
 }
 
 void interpolate(const double now)
@@ -135,22 +449,73 @@ void interpolate(const double now)
     if (!frz_by_me)
         return;
 
-    const double render_t = now - k_delay_sec;
+    const auto timed = stats.time(fsc::protocol::timer_interpolate);
+    select_session(now);
 
-    // Physics
-    fsc::protocol::physics p{};
-    if (phys_buf.interpolate(render_t, p, fsc::interp::physics))
-        apply_physics(p);
+    session_state* session = sessions.find(active_session);
+    if (session == nullptr)
+        return;
 
-    // Control
+    const double            render_t = now - session->delay.advance(now);
+    fsc::protocol::physics  p{};
     fsc::protocol::surfaces c{};
-    if (ctrl_buf.interpolate(render_t, c, fsc::interp::control))
-        apply_control(c);
+    const bool              has_p = session->phys.interpolate(render_t, p);
+    const bool              has_c = session->ctrl.interpolate(render_t, c);
+
+    if (session->delay.on_render(render_t))
+        stats.count(fsc::protocol::counter_underruns);
+    stats.offset(session->clock.offset_sec());
+
+    // blend from the previous session towards this one
+    if (fading)
+    {
+        session_state* old = sessions.find(fade_session);
+        const double   w   = (now - fade_start) / k_crossfade_sec;
+        if (old == nullptr || w >= 1.0)
+            fading = false;
+        else
+        {
+            const double            old_t = now - old->delay.advance(now);
+            const double            k     = w * w * (3.0 - 2.0 * w);
+            fsc::protocol::physics  from_p{};
+            fsc::protocol::surfaces from_c{};
+            if (old->phys.interpolate(old_t, from_p))
+            {
+                fade_from_p = from_p;
+                fade_has_p  = true;
+            }
+            if (old->ctrl.interpolate(old_t, from_c))
+            {
+                fade_from_c = from_c;
+                fade_has_c  = true;
+            }
+            if (has_p && fade_has_p)
+                fsc::interp::physics(fade_from_p, p, k, p);
+            if (has_c && fade_has_c)
+                fsc::interp::control(fade_from_c, c, k, c);
+        }
+    }
+
+    if (has_p)
+        apply_physics(p);
+    if (has_c)
+        apply_control(c, now);
+
+    fsc::protocol::levers l{};
+    if (session->levers.interpolate(render_t, l))
+        apply_channels(l, def_levers_set, levers_out);
 }
 
 void receive_gauge_msg(const char* json, unsigned int size, void* /*ctx*/)
 {
-    // const size_t len = std::strlen(json);
+    const size_t len = strnlen(json, size);
+    if (peer_version >= k_bus_version)
+    {
+        if (!bus_out.push(json, len))
+            logger.warn("Bus queue full, dropped %s", json);
+        return;
+    }
+
     if (size > sizeof(fsc::protocol::str_msg::msg))
         return;
 
@@ -158,115 +523,647 @@ void receive_gauge_msg(const char* json, unsigned int size, void* /*ctx*/)
     std::memcpy(msg.msg, json, size);
 
     (void)SimConnect_SetClientData(h_sim, def_comm_bus_out, def_comm_bus_out, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(fsc::protocol::str_msg), &msg);
-    (void)fprintf(stdout, "Send %s", json);
+    logger.debug("Send %s", json);
 }
 
-void var_update(const char* name, const double value, void* /*user*/)
+int parse_version(const char* v)
 {
-    (void)fprintf(stdout, "%s -> %f", name, value);
-    fsc::protocol::var_set msg = {};
-    strncpy(msg.name, name, sizeof(msg.name) - 1);
-    msg.value = value;
-    (void)SimConnect_SetClientData(h_sim, def_variable, def_variable, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(fsc::protocol::var_set), &msg);
+    char*      end   = nullptr;
+    const long major = std::strtol(v, &end, 10);
+    const long minor = *end == '.' ? std::strtol(end + 1, nullptr, 10) : 0;
+    return static_cast<int>(major * 100 + minor);
 }
 
-void CALLBACK dispatch(SIMCONNECT_RECV* p_data, DWORD /*cb_data*/, void* /*p_context*/)
+// "1.7 <watch set hash>", 0 when the app sent no hash because it holds no values yet
+uint64_t parse_watch_hash(const char* v)
 {
-    if (!p_data)
+    const char* space = std::strchr(v, ' ');
+    return space ? std::strtoull(space + 1, nullptr, 16) : 0;
+}
+
+bool var_update(const uint32_t handle, const char* name, const double value, void* /*user*/)
+{
+    logger.debug("%s -> %f", name, value);
+
+    if (peer_version < k_batch_version || handle > UINT16_MAX)
+    {
+        fsc::protocol::var_set msg = {};
+        strncpy(msg.name, name, sizeof(msg.name) - 1);
+        msg.value = value;
+        (void)SimConnect_SetClientData(h_sim, def_variable, def_variable, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(fsc::protocol::var_set), &msg);
+        return true;
+    }
+
+    if (handle >= announced.size())
+        announced.resize(handle + 1, 0);
+
+    const bool with_name = peer_version < k_handle_version && !announced[handle];
+    if (!batch.add(static_cast<uint16_t>(handle), with_name ? name : nullptr, value))
+        return false;
+
+    announced[handle] = 1;
+    return true;
+}
+
+bool budget_left()
+{
+    return budget.left();
+}
+
+void send_snapshot(const bool last)
+{
+    snapshot_frame.id    = snapshot.id;
+    snapshot_frame.last  = last;
+    snapshot_frame.batch = snapshot_batch.finish(++snapshot.part);
+    (void)SimConnect_SetClientData(h_sim, def_snapshot, def_snapshot, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(snapshot_frame), &snapshot_frame);
+    snapshot_batch.reset();
+}
+
+// var_update_callback while a snapshot is captured, a full part goes out and the next one starts
+bool snapshot_update(const uint32_t handle, const char* name, const double value, void* user)
+{
+    if (handle > UINT16_MAX)
+        return var_update(handle, name, value, user);
+    if (snapshot_batch.add(static_cast<uint16_t>(handle), nullptr, value))
+        return true;
+
+    send_snapshot(false);
+    return snapshot_batch.add(static_cast<uint16_t>(handle), nullptr, value);
+}
+
+// var_update_callback of every poll, the variables of a snapshot go to it and their deltas are held
+// until it is acked
+bool poll_update(const uint32_t handle, const char* name, const double value, void* user)
+{
+    if (snapshot.state == snapshot_state::idle || handle >= snapshot.members.size() || !snapshot.members[handle])
+        return var_update(handle, name, value, user);
+    return snapshot.state == snapshot_state::capturing && snapshot_update(handle, name, value, user);
+}
+
+// the variables of the lists received so far join the snapshot, a snapshot still under way starts over
+void start_snapshot(const uint32_t id)
+{
+    snapshot.state        = snapshot_state::capturing;
+    snapshot.id           = id;
+    snapshot.part         = 0;
+    snapshot.pass_started = false;
+    snapshot_batch.reset();
+
+    if (snapshot.members.size() < snapshot.listed.size())
+        snapshot.members.resize(snapshot.listed.size(), 0);
+    for (uint32_t h = 0; h < snapshot.members.size(); ++h)
+    {
+        snapshot.members[h] |= h < snapshot.listed.size() && snapshot.listed[h];
+        if (snapshot.members[h])
+            watcher.invalidate(h);
+    }
+    snapshot.listed.clear();
+}
+
+// held deltas of the snapshot variables are offered again by the next poll
+void end_snapshot()
+{
+    snapshot.state = snapshot_state::idle;
+    snapshot.members.clear();
+}
+
+void poll_variables(const double now)
+{
+    const auto timed = stats.time(fsc::protocol::timer_poll);
+    if (watcher.dormant())
         return;
 
-    const auto tp  = std::chrono::steady_clock::now();
-    const auto now = std::chrono::duration<double>(tp - g_start).count();
+    if (snapshot.state == snapshot_state::sent && now - snapshot.sent_at >= k_snapshot_ack_sec)
+    {
+        logger.warn("Snapshot %u not acknowledged, sending deltas", snapshot.id);
+        end_snapshot();
+    }
 
-    if (p_data->dwID == SIMCONNECT_RECV_ID_SIMOBJECT_DATA)
+    // a capture is complete at the end of a pass that started after the list
+    const bool capturing = snapshot.state == snapshot_state::capturing;
+    snapshot.pass_started |= capturing && watcher.pending() == 0;
+
+    batch.reset();
+    const bool done = watcher.poll(now, &poll_update, nullptr, budget_left);
+    stats.count(fsc::protocol::counter_vars_polled, watcher.stats().reads);
+    stats.count(fsc::protocol::counter_vars_changed, watcher.stats().changed);
+    if (!batch.empty())
     {
-        const auto* d = reinterpret_cast<SIMCONNECT_RECV_SIMOBJECT_DATA*>(p_data);
-        if (d->dwRequestID == def_state)
-        {
-            const auto* freeze = reinterpret_cast<const freeze_state*>(&d->dwData);
-            frz                = *freeze;
-        }
+        const auto& frame = batch.finish(++batch_seq);
+        (void)SimConnect_SetClientData(h_sim, def_var_batch, def_var_batch, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(frame), const_cast<fsc::protocol::var_batch*>(&frame));
     }
 
-    if (p_data->dwID == SIMCONNECT_RECV_ID_CLIENT_DATA)
+    if (!capturing || !done || !snapshot.pass_started)
+        return;
+
+    send_snapshot(true);
+    snapshot.state   = snapshot_state::sent;
+    snapshot.sent_at = now;
+    logger.info("Snapshot %u sent in %u parts", snapshot.id, snapshot.part);
+}
+
+// one coalesced bus transfer per frame each way, the rest waits for the next frame
+void flush_bus()
+{
+    if (const auto* frame = bus_out.next())
+        (void)SimConnect_SetClientData(h_sim, def_bus_out, def_bus_out, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(*frame), const_cast<fsc::protocol::bus_frame*>(frame));
+}
+
+// received bus messages go to the gauges as long as the frame budget lasts
+void forward_bus()
+{
+    bus_in.drain(
+        [](const char* msg, const size_t size) {
+            stats.count(fsc::protocol::counter_bus_in);
+            fsCommBusCall("FSC_CLIENT_EVENT", msg, static_cast<unsigned int>(size + 1), FsCommBusBroadcast_JS);
+        },
+        budget_left);
+}
+
+void flush_acks()
+{
+    if (acks.count == 0)
+        return;
+
+    (void)SimConnect_SetClientData(h_sim, def_watch_ack, def_watch_ack, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(acks), &acks);
+    acks.count = 0;
+}
+
+void queue_ack(const uint32_t tag, const uint32_t handle)
+{
+    if (acks.count == std::size(acks.acks))
+        flush_acks();
+
+    acks.acks[acks.count++] = {tag, handle};
+}
+
+// runs the writes queued since the last tick, see set_queue.h
+template <typename More> void flush_sets(More more)
+{
+    if (sets.empty())
+        return;
+
+    const auto timed = stats.time(fsc::protocol::timer_set);
+    sets.flush(
+        [](const char* program) {
+            logger.debug("%s", program);
+            return execute_calculator_code(program, nullptr, nullptr, nullptr) != 0;
+        },
+        more);
+}
+
+using handler_fn = void (*)(const void* data, double now);
+
+// runs the oldest queued registration
+void run_registration(const double now)
+{
+    size_t      size  = 0;
+    const char* entry = registrations.front(size);
+
+    handler_fn fn = nullptr;
+    alignas(8) char msg[sizeof(fsc::protocol::var_watch_list)];
+    std::memcpy(&fn, entry, sizeof(fn));
+    std::memcpy(msg, entry + sizeof(fn), std::min(size - sizeof(fn), sizeof(msg)));
+    registrations.pop();
+    fn(msg, now);
+}
+
+template <typename More> void run_registrations(const double now, More more)
+{
+    if (registrations.empty())
+        return;
+
+    do
+        run_registration(now);
+    while (!registrations.empty() && more());
+}
+
+// forgets every watch and the registrations still queued, the desktop app watches again after its hello
+void drop_watches()
+{
+    watcher.clear();
+    while (!registrations.empty())
+        registrations.pop();
+    announced.clear();
+    end_snapshot();
+    snapshot.listed.clear();
+}
+
+void set_variable(const char* name, const double value)
+{
+    stats.count(fsc::protocol::counter_set);
+    if (sets.push(name, value))
+        return;
+
+    // one program is enough to make room
+    flush_sets([] { return false; });
+    (void)sets.push(name, value);
+}
+
+void log_stats(const double now)
+{
+    if (now - g_last_stats < k_stats_interval_sec)
+        return;
+    g_last_stats = now;
+
+    if (surf.written + surf.skipped > 0)
+        logger.info("Surfaces written %u, skipped %u, axes %u", surf.written, surf.skipped, surf.axes);
+
+    if (levers_out.written > 0)
+        logger.info("Lever channels written %u", levers_out.written);
+
+    if (bus_in.stats().messages + bus_in.stats().dropped + bus_out.dropped() > 0)
+        logger.info("Bus received %u, lost frames %u, dropped %u, send dropped %u", bus_in.stats().messages, bus_in.stats().lost, bus_in.stats().dropped, bus_out.dropped());
+
+    if (sets.stats().queued + sets.stats().rejected > 0)
+        logger.info("Sets queued %u, collapsed %u, rejected %u, failed %u, calculator calls %u", sets.stats().queued, sets.stats().collapsed, sets.stats().rejected, sets.stats().failed, sets.stats().programs);
+
+    if (budget.stats().overruns > 0)
+        logger.info("Frame budget %.0f us, overruns %u of %u frames, carried %u", k_frame_budget_us, budget.stats().overruns, budget.stats().frames, budget.stats().carried);
+
+
+    if (motion.stats().frames > 0)
+        logger.info("Motion frames %u, lost %u, dropped %u", motion.stats().frames, motion.stats().lost, motion.stats().dropped);
+
+    sessions.for_each([](const uint64_t id, const session_state& session) {
+        const auto s = session.delay.snapshot();
+        logger.info("Playout %llx delay %.0f ms (target %.0f), gap %.0f ms, jitter %.0f ms, underruns %u, samples %u, skew %.0f ppm", static_cast<unsigned long long>(id), s.delay_sec * 1000.0, s.target_sec * 1000.0, s.gap_sec * 1000.0,
+                    s.jitter_sec * 1000.0, s.underruns, s.samples, session.clock.skew() * 1e6);
+    });
+}
+
+void receive_physics(const fsc::protocol::physics& physics, const double now)
+{
+    stats.count(fsc::protocol::counter_physics);
+
+    auto&        session = sessions.touch(physics.session_id, now);
+    const double t_local = session.clock.to_local_sec(now, physics.time_ms);
+    session.phys.push(t_local, physics);
+    session.delay.on_arrival(now, t_local);
+    if (session.started < 0)
+        session.started = now;
+    session.last_physics = now;
+}
+
+void receive_surfaces(const fsc::protocol::surfaces& ctrl, const double now)
+{
+    stats.count(fsc::protocol::counter_surfaces);
+
+    auto&        session = sessions.touch(ctrl.session_id, now);
+    const double t_local = session.clock.to_local_sec(now, ctrl.time_ms);
+    session.ctrl.push(t_local, ctrl);
+}
+
+void drain_log(const size_t lines)
+{
+    logger.drain(lines, [](log_level /*level*/, const char* line) { (void)fprintf(stdout, "%s", line); });
+}
+
+void tick(double now);
+
+// If MSFS2024 Update_StandAlone is active, we don't want double-ticking.
+// MSFS2020 fallback tick: we use our clock packets as "per-frame" pulse
+void on_clock(const void* /*data*/, const double now)
+{
+    if (!has_standalone_update)
+        tick(now);
+}
+
+void on_hello(const void* data, double /*now*/)
+{
+    // the desktop app (re)connected. It binds names again, but when it still holds the values of
+    // the same watch set only the variables that changed since are sent. Any other set, one of an
+    // earlier app session or aircraft profile, is dropped.
+    const auto* msg  = static_cast<const fsc::protocol::str_msg*>(data);
+    const auto  hash = parse_watch_hash(msg->msg);
+    peer_version     = parse_version(msg->msg);
+    end_snapshot();
+    snapshot.listed.clear();
+
+    if (hash != 0 && hash == watcher.set_hash())
     {
-        const auto* cd = reinterpret_cast<SIMCONNECT_RECV_CLIENT_DATA*>(p_data);
+        logger.info("Hello %s, watch set unchanged, sending changes only", msg->msg);
+        return;
+    }
+    const size_t dropped = watcher.size();
+    drop_watches();
+    logger.info("Hello %s, %u watches dropped", msg->msg, static_cast<unsigned>(dropped));
+}
 
-        // If MSFS2024 Update_StandAlone is active, we don't want double-ticking.
-        // BUT we still keep SimConnect alive and continue handling messages above.
-        // MSFS2020 fallback tick: we use our clock packets as "per-frame" pulse
-        if (!has_standalone_update && cd->dwRequestID == def_clock)
-        {
-            interpolate(now);
-            watcher.poll(&var_update, nullptr);
-            if (frz.fsc_control != 0 && now - g_last_seen > 1)
-            {
-                execute_calculator_code("0 (>L:FSC_CONTROL) "
-                                        "0 (>K:FREEZE_LATITUDE_LONGITUDE_SET) "
-                                        "0 (>K:FREEZE_ALTITUDE_SET) "
-                                        "0 (>K:FREEZE_ATTITUDE_SET)",
-                                        nullptr, nullptr, nullptr);
-                watcher.clear();
-            }
-        }
+void on_control(const void* data, const double now)
+{
+    stats.count(fsc::protocol::counter_control);
+    apply_control(*static_cast<const fsc::protocol::control*>(data));
+    g_last_seen = now;
 
-        if (cd->dwRequestID == def_control)
-        {
-            const auto* ctrl = reinterpret_cast<const fsc::protocol::control*>(&cd->dwData);
-            apply_control(*ctrl);
-            g_last_seen = now;
-        }
+    if (watcher.dormant())
+    {
+        watcher.wake();
+        logger.info("Control back, %u watches resumed", static_cast<unsigned>(watcher.size()));
+    }
+}
 
-        if (cd->dwRequestID == def_physics)
-        {
-            const auto*  physics = reinterpret_cast<const fsc::protocol::physics*>(&cd->dwData);
-            const double t_local = t_shifts[physics->session_id].to_local_sec(now, physics->time_ms);
-            phys_buf.push(t_local, *physics);
-        }
+void on_physics(const void* data, const double now)
+{
+    receive_physics(*static_cast<const fsc::protocol::physics*>(data), now);
+}
 
-        if (cd->dwRequestID == def_surfaces)
-        {
-            const auto*  ctrl    = reinterpret_cast<const fsc::protocol::surfaces*>(&cd->dwData);
-            const double t_local = t_shifts[ctrl->session_id].to_local_sec(now, ctrl->time_ms);
-            ctrl_buf.push(t_local, *ctrl);
-        }
+void on_surfaces(const void* data, const double now)
+{
+    receive_surfaces(*static_cast<const fsc::protocol::surfaces*>(data), now);
+}
 
-        if (cd->dwRequestID == def_comm_bus_in)
-        {
-            const auto* msg = reinterpret_cast<const fsc::protocol::str_msg*>(&cd->dwData);
-            (void)fprintf(stdout, "Receive %s", msg->msg);
-            fsCommBusCall("FSC_CLIENT_EVENT", msg->msg, sizeof(msg->msg), FsCommBusBroadcast_JS);
-        }
+void on_motion(const void* data, const double now)
+{
+    const auto* msg = static_cast<const fsc::protocol::motion*>(data);
+    stats.count(fsc::protocol::counter_motion);
+
+    fsc::protocol::physics  p{};
+    fsc::protocol::surfaces c{};
+    switch (motion.decode(msg->data, std::min<size_t>(msg->size, sizeof(msg->data)), p, c))
+    {
+    case fsc::protocol::motion_physics:
+        receive_physics(p, now);
+        break;
+    case fsc::protocol::motion_surfaces:
+        receive_surfaces(c, now);
+        break;
+    default:
+        break;
+    }
+}
+
+// a struct streamed per channels<T>, into the session buffer `Buffer`
+template <typename T, channel_buffer<T> session_state::*Buffer> void on_channels(const void* data, const double now)
+{
+    const auto* msg     = static_cast<const T*>(data);
+    auto&       session = sessions.touch(msg->session_id, now);
+    (session.*Buffer).push(session.clock.to_local_sec(now, msg->time_ms), *msg);
+}
+
+void on_comm_bus_in(const void* data, double /*now*/)
+{
+    const auto* msg = static_cast<const fsc::protocol::str_msg*>(data);
+    stats.count(fsc::protocol::counter_bus_in);
+    logger.debug("Receive %s", msg->msg);
+    fsCommBusCall("FSC_CLIENT_EVENT", msg->msg, static_cast<unsigned int>(strnlen(msg->msg, sizeof(msg->msg) - 1) + 1), FsCommBusBroadcast_JS);
+}
+
+void on_bus_in(const void* data, double /*now*/)
+{
+    bus_in.read(*static_cast<const fsc::protocol::bus_frame*>(data));
+}
+
+void on_watch(const void* data, double /*now*/)
+{
+    const auto* msg = static_cast<const fsc::protocol::var_set*>(data);
+    if (!watcher.is_watched(msg->name, msg->units) && watcher.watch(msg->name, msg->units) != var_watcher::invalid_handle)
+        logger.info("Watch %s, %s", msg->name, msg->units);
+}
+
+void on_unwatch(const void* data, double /*now*/)
+{
+    const auto* msg = static_cast<const fsc::protocol::var_set*>(data);
+    watcher.unwatch(msg->name, msg->units);
+    logger.info("Unwatch %s", msg->name);
+}
+
+void on_set(const void* data, double /*now*/)
+{
+    const auto* msg = static_cast<const fsc::protocol::var_set*>(data);
+    set_variable(msg->name, msg->value);
+}
+
+var_watcher::handle watch_request(const fsc::protocol::var_watch& msg)
+{
+    const auto h = msg.flags & fsc::protocol::watch_poll ? watcher.watch(msg.name, msg.units, msg.rate) : watcher.resolve(msg.name, msg.units);
+    queue_ack(msg.tag, h);
+    return h;
+}
+
+void on_watch_h(const void* data, double /*now*/)
+{
+    watch_request(*static_cast<const fsc::protocol::var_watch*>(data));
+}
+
+// Only the watches a list creates join its snapshot. One the bridge already holds, from a resend
+// after a lost ack or a rebind after a hello with the same watch set, gets its handle acked again
+// and its value keeps flowing as deltas.
+void on_watch_list(const void* data, double /*now*/)
+{
+    const auto*  list = static_cast<const fsc::protocol::var_watch_list*>(data);
+    const size_t n    = fsc::protocol::read_watch_list(*list, [](const fsc::protocol::var_watch& w) {
+        const bool poll    = w.flags & fsc::protocol::watch_poll;
+        const bool existed = poll && watcher.is_watched(w.name, w.units);
+        const auto h       = watch_request(w);
+        if (h == var_watcher::invalid_handle || !poll || existed)
+            return;
+        if (h >= snapshot.listed.size())
+            snapshot.listed.resize(h + 1, 0);
+        snapshot.listed[h] = 1;
+    });
+    if (n < list->count)
+        logger.warn("Watch list %u cut after %u of %u records", list->id, static_cast<unsigned>(n), static_cast<unsigned>(list->count));
+    if (!list->last)
+        return;
+
+    if (std::find(snapshot.listed.begin(), snapshot.listed.end(), 1) == snapshot.listed.end())
+    {
+        logger.info("Watch list %u done, %u watched, nothing new", list->id, static_cast<unsigned>(watcher.size()));
+        return;
+    }
+    start_snapshot(list->id);
+    logger.info("Watch list %u done, %u watched, capturing snapshot", list->id, static_cast<unsigned>(watcher.size()));
+}
+
+void on_snapshot_ack(const void* data, double /*now*/)
+{
+    const auto* msg = static_cast<const fsc::protocol::var_snapshot_ack*>(data);
+    if (snapshot.state == snapshot_state::sent && msg->id == snapshot.id)
+        end_snapshot();
+}
+
+void on_unwatch_h(const void* data, double /*now*/)
+{
+    watcher.unwatch(static_cast<const fsc::protocol::var_handle*>(data)->handle);
+}
+
+void on_set_h(const void* data, double /*now*/)
+{
+    const auto* msg  = static_cast<const fsc::protocol::var_value*>(data);
+    const char* name = watcher.name_of(msg->handle);
+    if (name != nullptr)
+        set_variable(name, msg->value);
+}
+
+// Watch and unwatch messages are queued for the tick, in arrival order, and run by Fn there.
+template <handler_fn Fn, typename Msg> void on_deferred(const void* data, const double now)
+{
+    static_assert(sizeof(Msg) <= sizeof(fsc::protocol::var_watch_list));
+
+    char             entry[sizeof(handler_fn) + sizeof(Msg)];
+    const handler_fn fn = Fn;
+    std::memcpy(entry, &fn, sizeof(fn));
+    std::memcpy(entry + sizeof(fn), data, sizeof(Msg));
+    while (!registrations.push(entry, sizeof(entry)))
+        run_registration(now);
+}
+
+struct client_handler
+{
+    DWORD  def;      // client data area, the id a recording stores
+    size_t recorded; // payload bytes that go to the flight recording, 0 for none
+    void (*fn)(const void* data, double now);
+};
+
+// indexed by request
+constexpr client_handler k_handlers[] = {
+    {def_clock, 0, on_clock},
+    {def_hello, 0, on_hello},
+    {def_control, sizeof(fsc::protocol::control), on_control},
+    {def_physics, sizeof(fsc::protocol::physics), on_physics},
+    {def_surfaces, sizeof(fsc::protocol::surfaces), on_surfaces},
+    {def_motion, sizeof(fsc::protocol::motion), on_motion},
+    {def_levers, sizeof(fsc::protocol::levers), on_channels<fsc::protocol::levers, &session_state::levers>},
+    {def_comm_bus_in, sizeof(fsc::protocol::str_msg), on_comm_bus_in},
+    {def_bus_in, sizeof(fsc::protocol::bus_frame), on_bus_in},
+    {def_watch, 0, on_deferred<on_watch, fsc::protocol::var_set>},
+    {def_unwatch, 0, on_deferred<on_unwatch, fsc::protocol::var_set>},
+    {def_set, sizeof(fsc::protocol::var_set), on_set},
+    {def_watch_h, 0, on_deferred<on_watch_h, fsc::protocol::var_watch>},
+    {def_unwatch_h, 0, on_deferred<on_unwatch_h, fsc::protocol::var_handle>},
+    {def_set_h, sizeof(fsc::protocol::var_value), on_set_h},
+    {def_watch_list, 0, on_deferred<on_watch_list, fsc::protocol::var_watch_list>},
+    {def_snapshot_ack, 0, on_snapshot_ack},
+};
+
+static_assert(std::size(k_handlers) == req_count);
+
+void replay_until(const double until)
+{
+    if (!replay.active())
+        return;
+
+    replay.play(until, [](const uint32_t def, const double t, const void* data, size_t /*size*/) {
+        for (const auto& h : k_handlers)
+            if (h.def == def && h.recorded != 0)
+                h.fn(data, t);
+    });
+    if (!replay.active())
+        logger.info("Replay finished");
+}
 
-        if (cd->dwRequestID == def_watch)
+// deferred items the last tick left for the next one
+uint32_t carried()
+{
+    return static_cast<uint32_t>(watcher.pending() + sets.size() + registrations.size() + bus_in.pending());
+}
+
+void tick(double now)
+{
+    budget.begin();
+    if (replaying)
+    {
+        now = replay_time(now);
+        replay_until(now);
+    }
+
+    interpolate(now);
+    log_stats(now);
+
+    // deferred work in priority order, each queue takes at least one item and then goes on while
+    // the frame budget lasts
+    poll_variables(now);
+    flush_sets(budget_left);
+    run_registrations(now, budget_left);
+    forward_bus();
+
+    const uint32_t left = carried();
+    budget.end(left);
+    stats.count(fsc::protocol::counter_overruns, left > 0);
+    stats.count(fsc::protocol::counter_deferred, left);
+
+    flush_bus();
+    flush_acks();
+    recorder.flush(now);
+    drain_log(k_log_lines_per_frame);
+    stats.publish(now, [](const fsc::protocol::bridge_stats& frame) {
+        (void)SimConnect_SetClientData(h_sim, def_stats, def_stats, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(frame), const_cast<fsc::protocol::bridge_stats*>(&frame));
+    });
+    if (frz.fsc_control != 0 && now - g_last_seen > 1)
+    {
+        execute_calculator_code("0 (>L:FSC_CONTROL) "
+                                "0 (>K:FREEZE_LATITUDE_LONGITUDE_SET) "
+                                "0 (>K:FREEZE_ALTITUDE_SET) "
+                                "0 (>K:FREEZE_ATTITUDE_SET)",
+                                nullptr, nullptr, nullptr);
+
+        // a short gap keeps the watches for the reconnect
+        if (!watcher.dormant())
         {
-            const auto* msg = reinterpret_cast<const fsc::protocol::var_set*>(&cd->dwData);
-            if (watcher.watch(msg->name, msg->units))
-                (void)fprintf(stdout, "Watch %s, %s", msg->name, msg->units);
+            watcher.sleep();
+            end_snapshot();
+            logger.info("Control lost, %u watches dormant", static_cast<unsigned>(watcher.size()));
         }
+    }
+
+    // a long one drops them as before. Checked on its own, the write above clears L:FSC_CONTROL.
+    if (watcher.dormant() && watcher.size() > 0 && now - g_last_seen > k_dormant_sec)
+    {
+        drop_watches();
+        logger.info("Control lost for %.0f s, watches dropped", k_dormant_sec);
+    }
+}
 
-        if (cd->dwRequestID == def_unwatch)
+void CALLBACK dispatch(SIMCONNECT_RECV* p_data, DWORD /*cb_data*/, void* /*p_context*/)
+{
+    if (!p_data)
+        return;
+
+    const auto timed = stats.time(fsc::protocol::timer_dispatch);
+    const auto tp    = module_clock::now();
+    const auto now   = std::chrono::duration<double>(tp - g_start).count();
+
+    if (p_data->dwID == SIMCONNECT_RECV_ID_EXCEPTION)
+    {
+        const auto* ex = reinterpret_cast<SIMCONNECT_RECV_EXCEPTION*>(p_data);
+        if (physics_binary && physics_probe_id != 0 && ex->dwSendID == physics_probe_id)
         {
-            const auto* msg = reinterpret_cast<const fsc::protocol::var_set*>(&cd->dwData);
-            watcher.unwatch(msg->name);
-            (void)fprintf(stdout, "Unwatch %s", msg->name);
+            physics_binary = false;
+            logger.warn("Physics write rejected (exception %lu), using calculator code", static_cast<unsigned long>(ex->dwException));
         }
+    }
 
-        if (cd->dwRequestID == def_set)
+    if (p_data->dwID == SIMCONNECT_RECV_ID_SIMOBJECT_DATA)
+    {
+        const auto* d = reinterpret_cast<SIMCONNECT_RECV_SIMOBJECT_DATA*>(p_data);
+        if (d->dwRequestID == def_state)
         {
-            const auto* msg = reinterpret_cast<const fsc::protocol::var_set*>(&cd->dwData);
-            char        cmd[128];
-            (void)snprintf(cmd, sizeof(cmd), "%.15g (>%s)", msg->value, msg->name);
-            execute_calculator_code(cmd, nullptr, nullptr, nullptr);
-            (void)fprintf(stdout, cmd);
+            const auto* freeze = reinterpret_cast<const freeze_state*>(&d->dwData);
+            frz                = *freeze;
         }
     }
+
+    if (p_data->dwID == SIMCONNECT_RECV_ID_CLIENT_DATA)
+    {
+        const auto* cd = reinterpret_cast<SIMCONNECT_RECV_CLIENT_DATA*>(p_data);
+        if (cd->dwRequestID >= req_count)
+            return;
+
+        const client_handler& h = k_handlers[cd->dwRequestID];
+        if (h.recorded != 0 && replaying)
+            return;
+        if (h.recorded != 0)
+            recorder.record(h.def, now, &cd->dwData, h.recorded);
+
+        h.fn(&cd->dwData, now);
+    }
 }
 } // namespace
 
 extern "C" MSFS_CALLBACK void module_init(void)
 {
-    g_start = std::chrono::steady_clock::now();
+    g_start = module_clock::now();
 
     if (FAILED(SimConnect_Open(&h_sim, "FsCopilot Bridge", nullptr, 0, 0, 0)))
         return;
@@ -279,34 +1176,80 @@ extern "C" MSFS_CALLBACK void module_init(void)
     (void)SimConnect_AddToDataDefinition(h_sim, def_state, "L:FSC_CONTROL", "Number", SIMCONNECT_DATATYPE_INT32);
     (void)SimConnect_RequestDataOnSimObject(h_sim, def_state, def_state, SIMCONNECT_OBJECT_ID_USER, SIMCONNECT_PERIOD_SIM_FRAME, SIMCONNECT_DATA_REQUEST_FLAG_CHANGED, 0, 0, 0);
 
+    // physics write, same order as protocol::physics
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE LATITUDE", "Radians", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE LONGITUDE", "Radians", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE ALTITUDE", "Feet", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE PITCH DEGREES", "Degrees", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE BANK DEGREES", "Degrees", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE HEADING DEGREES GYRO", "Degrees", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "PLANE HEADING DEGREES TRUE", "Degrees", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "VERTICAL SPEED", "Feet per second", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "G FORCE", "Gforce", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "VELOCITY BODY Y", "Feet per second", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "VELOCITY BODY Z", "Feet per second", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "VELOCITY WORLD X", "Feet per second", SIMCONNECT_DATATYPE_FLOAT64);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_physics_set, "VELOCITY WORLD Z", "Feet per second", SIMCONNECT_DATATYPE_FLOAT64);
+
+    // surfaces write, one definition and one axis event per surface
+    (void)SimConnect_AddToDataDefinition(h_sim, def_aileron_set, "AILERON POSITION", "Position 16k", SIMCONNECT_DATATYPE_INT32);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_elevator_set, "ELEVATOR POSITION", "Position 16k", SIMCONNECT_DATATYPE_INT32);
+    (void)SimConnect_AddToDataDefinition(h_sim, def_rudder_set, "RUDDER POSITION", "Position 16k", SIMCONNECT_DATATYPE_INT32);
+    (void)SimConnect_MapClientEventToSimEvent(h_sim, evt_ailerons_set, "AXIS_AILERONS_SET");
+    (void)SimConnect_MapClientEventToSimEvent(h_sim, evt_elevator_set, "AXIS_ELEVATOR_SET");
+    (void)SimConnect_MapClientEventToSimEvent(h_sim, evt_rudder_set, "AXIS_RUDDER_SET");
+
+    // streamed channel structs, see channel_table.h
+    register_channels<fsc::protocol::levers>(def_levers, req_levers, def_levers_set);
+
     // clock. This is required to drive interpolation in MSFS 2020, where Update_StandAlone is not available.
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_CLOCK", def_clock);
     (void)SimConnect_CreateClientData(h_sim, def_clock, 4, 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_clock, 0, 4, 0.0f, -1);
-    (void)SimConnect_RequestClientData(h_sim, def_clock, def_clock, def_clock, SIMCONNECT_CLIENT_DATA_PERIOD_VISUAL_FRAME, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_clock, req_clock, def_clock, SIMCONNECT_CLIENT_DATA_PERIOD_VISUAL_FRAME, 0, 0, 0, 0);
 
     // ready
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_READY", def_ready);
     (void)SimConnect_CreateClientData(h_sim, def_ready, sizeof(fsc::protocol::str_msg), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_ready, 0, sizeof(fsc::protocol::str_msg), 0, 0);
 
+    // hello, the desktop app announces its version here
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_HELLO", def_hello);
+    (void)SimConnect_CreateClientData(h_sim, def_hello, sizeof(fsc::protocol::str_msg), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_hello, 0, sizeof(fsc::protocol::str_msg), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_hello, req_hello, def_hello, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
     // control
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_CONTROL", def_control);
     (void)SimConnect_CreateClientData(h_sim, def_control, sizeof(fsc::protocol::control), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_control, 0, sizeof(fsc::protocol::control), 0, 0);
-    (void)SimConnect_RequestClientData(h_sim, def_control, def_control, def_control, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_control, req_control, def_control, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    // stats
+    if constexpr (k_stats)
+    {
+        (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_STATS", def_stats);
+        (void)SimConnect_CreateClientData(h_sim, def_stats, sizeof(fsc::protocol::bridge_stats), 0);
+        (void)SimConnect_AddToClientDataDefinition(h_sim, def_stats, 0, sizeof(fsc::protocol::bridge_stats), 0, 0);
+    }
 
     // physics
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_PHYSICS", def_physics);
     (void)SimConnect_CreateClientData(h_sim, def_physics, sizeof(fsc::protocol::physics), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_physics, 0, sizeof(fsc::protocol::physics), 0.0f, -1);
-    (void)SimConnect_RequestClientData(h_sim, def_physics, def_physics, def_physics, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_physics, req_physics, def_physics, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
 
     // surfaces
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_SURFACES", def_surfaces);
     (void)SimConnect_CreateClientData(h_sim, def_surfaces, sizeof(fsc::protocol::surfaces), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_surfaces, 0, sizeof(fsc::protocol::surfaces), 0.0f, -1);
-    (void)SimConnect_RequestClientData(h_sim, def_surfaces, def_surfaces, def_surfaces, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_surfaces, req_surfaces, def_surfaces, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    // physics and surfaces, quantized
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_MOTION", def_motion);
+    (void)SimConnect_CreateClientData(h_sim, def_motion, sizeof(fsc::protocol::motion), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_motion, 0, sizeof(fsc::protocol::motion), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_motion, req_motion, def_motion, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
 
     // bus
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_BUS_OUT", def_comm_bus_out);
@@ -315,31 +1258,86 @@ extern "C" MSFS_CALLBACK void module_init(void)
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_BUS_IN", def_comm_bus_in);
     (void)SimConnect_CreateClientData(h_sim, def_comm_bus_in, sizeof(fsc::protocol::str_msg), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_comm_bus_in, 0, sizeof(fsc::protocol::str_msg), 0, 0);
-    (void)SimConnect_RequestClientData(h_sim, def_comm_bus_in, def_comm_bus_in, def_comm_bus_in, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_comm_bus_in, req_comm_bus_in, def_comm_bus_in, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_BUS_FRAME_OUT", def_bus_out);
+    (void)SimConnect_CreateClientData(h_sim, def_bus_out, sizeof(fsc::protocol::bus_frame), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_bus_out, 0, sizeof(fsc::protocol::bus_frame), 0, 0);
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_BUS_FRAME_IN", def_bus_in);
+    (void)SimConnect_CreateClientData(h_sim, def_bus_in, sizeof(fsc::protocol::bus_frame), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_bus_in, 0, sizeof(fsc::protocol::bus_frame), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_bus_in, req_bus_in, def_bus_in, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
     fsCommBusRegister("FSC_GAUGE_EVENT", receive_gauge_msg, nullptr);
 
     // watch
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_WATCH", def_watch);
     (void)SimConnect_CreateClientData(h_sim, def_watch, sizeof(fsc::protocol::var_set), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_watch, 0, sizeof(fsc::protocol::var_set), 0, 0);
-    (void)SimConnect_RequestClientData(h_sim, def_watch, def_watch, def_watch, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_watch, req_watch, def_watch, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
 
     // unwatch
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_UNWATCH", def_unwatch);
     (void)SimConnect_CreateClientData(h_sim, def_unwatch, sizeof(fsc::protocol::var_set), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_unwatch, 0, sizeof(fsc::protocol::var_set), 0, 0);
-    (void)SimConnect_RequestClientData(h_sim, def_unwatch, def_unwatch, def_unwatch, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_unwatch, req_unwatch, def_unwatch, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
 
     // watch demon
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_VARIABLE", def_variable);
     (void)SimConnect_CreateClientData(h_sim, def_variable, sizeof(fsc::protocol::var_set), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_variable, 0, sizeof(fsc::protocol::var_set), 0, 0);
 
+    // watch demon, batched
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_VARIABLE_BATCH", def_var_batch);
+    (void)SimConnect_CreateClientData(h_sim, def_var_batch, sizeof(fsc::protocol::var_batch), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_var_batch, 0, sizeof(fsc::protocol::var_batch), 0, 0);
+
     // set
     (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_SET", def_set);
     (void)SimConnect_CreateClientData(h_sim, def_set, sizeof(fsc::protocol::var_set), 0);
     (void)SimConnect_AddToClientDataDefinition(h_sim, def_set, 0, sizeof(fsc::protocol::var_set), 0, 0);
-    (void)SimConnect_RequestClientData(h_sim, def_set, def_set, def_set, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_set, req_set, def_set, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    // handle based watch, unwatch and set
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_WATCH_H", def_watch_h);
+    (void)SimConnect_CreateClientData(h_sim, def_watch_h, sizeof(fsc::protocol::var_watch), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_watch_h, 0, sizeof(fsc::protocol::var_watch), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_watch_h, req_watch_h, def_watch_h, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_WATCH_ACK", def_watch_ack);
+    (void)SimConnect_CreateClientData(h_sim, def_watch_ack, sizeof(fsc::protocol::var_acks), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_watch_ack, 0, sizeof(fsc::protocol::var_acks), 0, 0);
+
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_UNWATCH_H", def_unwatch_h);
+    (void)SimConnect_CreateClientData(h_sim, def_unwatch_h, sizeof(fsc::protocol::var_handle), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_unwatch_h, 0, sizeof(fsc::protocol::var_handle), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_unwatch_h, req_unwatch_h, def_unwatch_h, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_SET_H", def_set_h);
+    (void)SimConnect_CreateClientData(h_sim, def_set_h, sizeof(fsc::protocol::var_value), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_set_h, 0, sizeof(fsc::protocol::var_value), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_set_h, req_set_h, def_set_h, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    // bulk watch and the snapshot that answers it
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_WATCH_LIST", def_watch_list);
+    (void)SimConnect_CreateClientData(h_sim, def_watch_list, sizeof(fsc::protocol::var_watch_list), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_watch_list, 0, sizeof(fsc::protocol::var_watch_list), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_watch_list, req_watch_list, def_watch_list, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_VARIABLE_SNAPSHOT", def_snapshot);
+    (void)SimConnect_CreateClientData(h_sim, def_snapshot, sizeof(fsc::protocol::var_snapshot), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_snapshot, 0, sizeof(fsc::protocol::var_snapshot), 0, 0);
+
+    (void)SimConnect_MapClientDataNameToID(h_sim, "FSC_SNAPSHOT_ACK", def_snapshot_ack);
+    (void)SimConnect_CreateClientData(h_sim, def_snapshot_ack, sizeof(fsc::protocol::var_snapshot_ack), 0);
+    (void)SimConnect_AddToClientDataDefinition(h_sim, def_snapshot_ack, 0, sizeof(fsc::protocol::var_snapshot_ack), 0, 0);
+    (void)SimConnect_RequestClientData(h_sim, def_snapshot_ack, req_snapshot_ack, def_snapshot_ack, SIMCONNECT_CLIENT_DATA_PERIOD_ON_SET, 0, 0, 0, 0);
+
+    if (record_path()[0] != '\0' && recorder.open(record_path()))
+        logger.info("Recording to %s", record_path());
+    if (replay_path()[0] != '\0' && replay.open(replay_path()))
+    {
+        replaying = true;
+        logger.info("Replaying %s at %.1fx", replay_path(), k_replay_speed);
+    }
 
     (void)SimConnect_CallDispatch(h_sim, dispatch, nullptr);
 
@@ -347,35 +1345,28 @@ extern "C" MSFS_CALLBACK void module_init(void)
     strncpy(msg.msg, k_version, sizeof(msg.msg) - 1);
     (void)SimConnect_SetClientData(h_sim, def_ready, def_ready, SIMCONNECT_CLIENT_DATA_SET_FLAG_DEFAULT, 0, sizeof(msg), &msg);
 
-    (void)fprintf(stdout, "Initialized");
+    logger.info("Initialized");
 }
 
 extern "C" MSFS_CALLBACK void module_deinit(void)
 {
     if (h_sim != 0)
         (void)SimConnect_Close(h_sim);
+    recorder.close();
+    replay.close();
     fsCommBusUnregisterOneEvent("FSC_GAUGE_EVENT", receive_gauge_msg, nullptr);
     h_sim = 0;
-    (void)fprintf(stdout, "Deinitialized");
+    logger.info("Deinitialized");
+    drain_log(SIZE_MAX);
 }
 
 // MSFS2024 standalone update hook
 // ReSharper disable once CppInconsistentNaming
-extern "C" MSFS_CALLBACK void Update_StandAlone(float d_time)
+extern "C" MSFS_CALLBACK void Update_StandAlone(float /*d_time*/)
 {
-    const auto tp  = std::chrono::steady_clock::now();
+    const auto tp  = module_clock::now();
     const auto now = std::chrono::duration<double>(tp - g_start).count();
     // now += static_cast<double>(d_time);
     has_standalone_update = true;
-    interpolate(now);
-    watcher.poll(&var_update, nullptr);
-    if (frz.fsc_control != 0 && now - g_last_seen > 1)
-    {
-        execute_calculator_code("0 (>L:FSC_CONTROL) "
-                                "0 (>K:FREEZE_LATITUDE_LONGITUDE_SET) "
-                                "0 (>K:FREEZE_ALTITUDE_SET) "
-                                "0 (>K:FREEZE_ATTITUDE_SET)",
-                                nullptr, nullptr, nullptr);
-        watcher.clear();
-    }
+    tick(now);
 }
@@ -3,10 +3,64 @@
 #include <cstdio>
 
 #include "protocol.h"
+#include "flight_recorder.h"
+#include "frame_stats.h"
 #include "interpolators.h"
+#include "log_ring.h"
+#include "playout_delay.h"
+#include "session_table.h"
 #include "stream_buffer.h"
 #include "time_shift.h"
 
-constexpr double k_delay_sec        = 0.4;
-constexpr double k_max_age_sec      = 3.0;
-constexpr double k_offset_smoothing = 0.01;
\ No newline at end of file
+// physics interpolation policy, fsc::interp::linear needs k_delay_sec = 0.4 to hide the corners
+// at each sample, hermite follows the packet velocities and gets away with less.
+using physics_interp = fsc::interp::hermite;
+
+// physics goes to the sim through a SimConnect data definition, false forces the calculator code
+// path. The bridge also falls back on its own when the sim rejects the binary write.
+constexpr bool k_physics_binary = true;
+
+// surfaces are Position 16k, an axis that moved less than this is not written again.
+constexpr int32_t k_surface_deadband    = 16;
+constexpr double  k_surface_refresh_sec = 0.5;
+
+// render delay until a session has enough arrivals for playout_delay to tune it.
+constexpr double   k_delay_sec          = 0.3;
+constexpr double   k_stats_interval_sec = 10.0;
+constexpr uint32_t k_max_age_ms         = 3000;
+constexpr size_t   k_stream_capacity    = 32; // samples are >= 0.2 s apart, 3 s of history fits with room for pending ones
+constexpr size_t   k_max_sessions       = 8;
+constexpr size_t   k_max_queued_sets    = 128; // variable writes per tick before an early flush
+
+// time a tick may spend, interpolation always runs and the deferred queues (polls, sets, watch
+// registrations, bus messages) stop when it is spent, what is left carries over to the next tick.
+constexpr double k_frame_budget_us         = 1500.0;
+constexpr size_t k_registration_queue_size = 128 * 1024; // bytes, about 600 watch messages or 30 watch lists
+
+// deltas after a snapshot wait for the desktop app to ack it, at most this long.
+constexpr double k_snapshot_ack_sec = 2.0;
+
+// without control packets the watcher goes dormant and keeps its watches for a reconnect, after
+// this long they are dropped.
+constexpr double k_dormant_sec = 60.0;
+
+// a session counts as live for this long after its last physics sample. A switch between sessions
+// blends from the old one to the new one over k_crossfade_sec.
+constexpr double k_session_live_sec = 1.0;
+constexpr double k_crossfade_sec    = 0.5;
+
+// messages below k_log_level compile out (log_ring.h). The rest are formatted and written to the
+// console outside the frame work, at most k_log_lines_per_frame lines a tick.
+constexpr log_level k_log_level           = log_info;
+constexpr size_t    k_log_lines_per_frame = 4;
+
+// hot path timings and counters on FSC_STATS (frame_stats.h) for the develop view, false compiles
+// them out. The cost is two clock reads per timed scope.
+constexpr bool k_stats = true;
+
+// flight stream recording (flight_recorder.h), an empty path turns it off. A replay feeds the
+// recording through the receive path at k_replay_speed instead of the live stream, it is meant
+// for debug builds.
+constexpr auto   k_record_path  = "";
+constexpr auto   k_replay_path  = "";
+constexpr double k_replay_speed = 1.0;
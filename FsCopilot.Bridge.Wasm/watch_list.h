@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "protocol.h"
+
+namespace fsc::protocol
+{
+// Calls fn(const var_watch&) for each record of a watch list, as written by the desktop app
+// (Connection/SimClient.cs). Names and units longer than var_watch holds are cut. Returns the
+// records read, a truncated record ends the list.
+template <typename Fn> size_t read_watch_list(const var_watch_list& list, Fn fn)
+{
+    const size_t end = sizeof(list.data);
+    size_t       pos = 0;
+    size_t       n   = 0;
+
+    auto text = [&](char* out, const size_t size) {
+        if (pos >= end)
+            return false;
+        const size_t len = list.data[pos++];
+        if (len > end - pos)
+            return false;
+        const size_t kept = len < size - 1 ? len : size - 1;
+        std::memcpy(out, list.data + pos, kept);
+        out[kept] = '\0';
+        pos += len;
+        return true;
+    };
+
+    for (; n < list.count; ++n)
+    {
+        var_watch w{};
+        if (end - pos < sizeof(w.tag) + 2)
+            break;
+        std::memcpy(&w.tag, list.data + pos, sizeof(w.tag));
+        w.flags = list.data[pos + 4];
+        w.rate  = list.data[pos + 5];
+        pos += sizeof(w.tag) + 2;
+
+        if (!text(w.name, sizeof(w.name)) || !text(w.units, sizeof(w.units)))
+            break;
+        fn(w);
+    }
+    return n;
+}
+} // namespace fsc::protocol
@@ -0,0 +1,39 @@
+﻿namespace FsCopilot.Connection;
+
+/// <summary>
+/// One publish interval of the bridge hot path timings and counters, read from FSC_STATS
+/// (frame_stats.h). Only bridges built with k_stats (the default) publish them.
+/// </summary>
+public sealed record BridgeStats(uint Seq, uint IntervalMs, double OffsetSec, BridgeStats.Histogram[] Timers, uint[] Counters)
+{
+    // protocol::k_stats_timers, k_stats_counters and k_stats_buckets in protocol.h, StatsMsg is laid
+    // out from these
+    public const int TimerCount = 6;
+    public const int CounterCount = 11;
+    public const int BucketCount = 16;
+
+    // protocol::stats_timer and protocol::stats_counter order
+    public static readonly string[] TimerNames =
+        ["dispatch", "interpolate", "poll", "apply_physics", "apply_control", "set"];
+    public static readonly string[] CounterNames =
+        ["physics", "surfaces", "motion", "control", "set", "bus_in", "underruns", "vars_polled", "vars_changed", "overruns", "deferred"];
+
+    /// <param name="Buckets">Bucket 0 counts calls under 512 ns, bucket i under 512 &lt;&lt; i ns.</param>
+    public sealed record Histogram(ulong TotalNs, uint Count, uint MaxNs, uint[] Buckets)
+    {
+        public double MeanUs => Count == 0 ? 0 : TotalNs / 1000.0 / Count;
+
+        /// <summary>Upper bound of the bucket that holds quantile <paramref name="q"/>, in microseconds.</summary>
+        public double QuantileUs(double q)
+        {
+            var rank = (ulong)Math.Ceiling(q * Count);
+            ulong seen = 0;
+            for (var i = 0; i < Buckets.Length - 1; i++)
+            {
+                seen += Buckets[i];
+                if (seen >= rank) return Math.Min(512L << i, MaxNs) / 1000.0;
+            }
+            return MaxNs / 1000.0;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+﻿namespace FsCopilot.Connection;
+
+using System.Buffers.Binary;
+
+/// <summary>
+/// Comm bus messages in FSC_BUS_FRAME_IN / FSC_BUS_FRAME_OUT transfers (bus_frame.h). Each record
+/// is a u16 size, a flags byte and that many bytes. Messages queued between two transfers share
+/// one, a message that does not fit is split into chunks marked first/last.
+/// </summary>
+internal static class BusFrames
+{
+    public const int DataSize = 4090;
+    public const byte First = 1;
+    public const byte Last = 2;
+    public const int RecordHeader = 3;
+    public const int MaxMessage = 8 * 1024;
+}
+
+internal sealed class BusFrameWriter
+{
+    private readonly Queue<byte[]> _queue = new();
+    private readonly Lock _lock = new();
+    private int _sent;
+    private uint _seq;
+
+    public void Add(string msg)
+    {
+        var bytes = Encoding.UTF8.GetBytes(msg);
+        if (bytes.Length > BusFrames.MaxMessage)
+        {
+            Log.Warning("[SimConnect] Bus message too large ({Size} bytes), dropped", bytes.Length);
+            return;
+        }
+        lock (_lock) _queue.Enqueue(bytes);
+    }
+
+    /// <summary>Fills one transfer from the queue, false when nothing is queued.</summary>
+    public bool TryNext(byte[] data, out uint seq, out ushort size)
+    {
+        lock (_lock)
+        {
+            seq = 0;
+            size = 0;
+            if (_queue.Count == 0) return false;
+
+            var used = 0;
+            while (_queue.Count > 0 && BusFrames.DataSize - used > BusFrames.RecordHeader)
+            {
+                var msg = _queue.Peek();
+                var left = msg.Length - _sent;
+                var chunk = Math.Min(left, BusFrames.DataSize - used - BusFrames.RecordHeader);
+
+                var flags = (byte)((_sent == 0 ? BusFrames.First : 0) | (chunk == left ? BusFrames.Last : 0));
+                BinaryPrimitives.WriteUInt16LittleEndian(data.AsSpan(used), (ushort)chunk);
+                data[used + 2] = flags;
+                msg.AsSpan(_sent, chunk).CopyTo(data.AsSpan(used + BusFrames.RecordHeader));
+                used += BusFrames.RecordHeader + chunk;
+
+                if (chunk == left)
+                {
+                    _queue.Dequeue();
+                    _sent = 0;
+                }
+                else _sent += chunk;
+            }
+
+            data.AsSpan(used).Clear();
+            seq = ++_seq;
+            size = (ushort)used;
+            return true;
+        }
+    }
+}
+
+internal sealed class BusFrameReader
+{
+    private readonly Subject<string> _messages = new();
+    private readonly Lock _lock = new();
+    private readonly byte[] _message = new byte[BusFrames.MaxMessage];
+    private int _size;
+    private bool _open;
+    private uint? _lastSeq;
+
+    public IObservable<string> Messages => _messages;
+
+    public void Reset()
+    {
+        lock (_lock)
+        {
+            _open = false;
+            _lastSeq = null;
+        }
+    }
+
+    public void Read(uint seq, ReadOnlySpan<byte> data)
+    {
+        lock (_lock) ReadLocked(seq, data);
+    }
+
+    private void ReadLocked(uint seq, ReadOnlySpan<byte> data)
+    {
+        if (_lastSeq is { } last && seq != unchecked(last + 1))
+        {
+            Log.Warning("[SimConnect] Bus frame gap: {Last} -> {Seq}", last, seq);
+            _open = false;
+        }
+        _lastSeq = seq;
+
+        var pos = 0;
+        while (pos + BusFrames.RecordHeader <= data.Length)
+        {
+            var n = BinaryPrimitives.ReadUInt16LittleEndian(data[pos..]);
+            var flags = data[pos + 2];
+            pos += BusFrames.RecordHeader;
+            if (n > data.Length - pos)
+            {
+                Log.Warning("[SimConnect] Malformed bus frame {Seq}", seq);
+                return;
+            }
+
+            if ((flags & BusFrames.First) != 0)
+            {
+                _size = 0;
+                _open = true;
+            }
+            if (_open && _size + n <= _message.Length)
+            {
+                data.Slice(pos, n).CopyTo(_message.AsSpan(_size));
+                _size += n;
+            }
+            else _open = false;
+            pos += n;
+
+            if ((flags & BusFrames.Last) == 0 || !_open) continue;
+            _open = false;
+            _messages.OnNext(Encoding.UTF8.GetString(_message, 0, _size));
+        }
+    }
+}
\ No newline at end of file
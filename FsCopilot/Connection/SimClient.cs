@@ -1,5 +1,6 @@
 namespace FsCopilot.Connection;
 
+using System.Buffers.Binary;
 using System.Reflection;
 using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
@@ -8,7 +9,7 @@ using Microsoft.FlightSimulator.SimConnect;
 
 public class SimClient : IDisposable
 {
-    private const string WasmVersion = "1.1";
+    private const string WasmVersion = "1.7";
     
     private static readonly object DefaultHValue = 1;
     
@@ -22,11 +23,29 @@ public class SimClient : IDisposable
     private readonly IObservable<string> _hEvents;
     private readonly IObservable<bool> _conflict;
     private readonly BehaviorSubject<BehaviorControl> _control = new(BehaviorControl.Master);
-    private readonly DEF _commBusDefId;
     private readonly DEF _varWatchDefId;
     private readonly DEF _watchDefId;
     private readonly DEF _unwatchDefId;
     private readonly DEF _setDefId;
+    private readonly DEF _setHandleDefId;
+    private readonly DEF _motionDefId;
+    private readonly DEF _busFrameDefId;
+    private readonly DEF _watchListDefId;
+    private readonly DEF _snapshotAckDefId;
+    private readonly IObservable<(string Name, double Value)> _variables;
+    private readonly VarBatchReader _batchReader = new();
+    private readonly BusFrameWriter _busWriter = new();
+    private readonly BusFrameReader _busReader = new();
+    private readonly ConcurrentDictionary<string, uint> _varTags = new();
+    private readonly ConcurrentDictionary<uint, string> _tagVars = new();
+    private readonly ConcurrentDictionary<string, uint> _varHandles = new();
+    private uint _varTag;
+    private uint _watchListId;
+    private readonly Subject<VarWatchMsg> _watchRequests = new();
+    private readonly ConcurrentDictionary<string, VarWatchMsg> _watched = new();
+    // watches the bridge has not acked since the last hello, with the tick count they last went out at
+    private readonly ConcurrentDictionary<string, long> _unacked = new();
+    private volatile bool _hasValues;
 
     public IObservable<bool> Connected => _consumer.Connected.ObserveOn(TaskPoolScheduler.Default);
     public IObservable<string> Aircraft => _consumer.Aircraft.ObserveOn(TaskPoolScheduler.Default);
@@ -34,6 +53,7 @@ public class SimClient : IDisposable
     public IObservable<bool> WasmReady;
     public IObservable<bool> WasmVersionMismatch;
     public IObservable<Interact> Interactions { get; }
+    public IObservable<BridgeStats> Stats { get; }
     // public IObservable<SimConfig> Config { get; }
 
     public SimClient(string appName)
@@ -42,13 +62,23 @@ public class SimClient : IDisposable
         _producer = new(appName);
         
         var readyDefId = RegisterClientStruct<StrMsg>("FSC_READY", producer: false);
+        var helloDefId = RegisterClientStruct<StrMsg>("FSC_HELLO", producer: true);
         var commBusDefId = RegisterClientStruct<StrMsg>("FSC_BUS_OUT", producer: false);
         var controlDefId = RegisterClientStruct<ControlMsg>("FSC_CONTROL", producer: true);
-        _commBusDefId = RegisterClientStruct<StrMsg>("FSC_BUS_IN", producer: true);
-        _watchDefId = RegisterClientStruct<VarSetMsg>("FSC_WATCH", producer: true);
-        _unwatchDefId = RegisterClientStruct<VarSetMsg>("FSC_UNWATCH", producer: true);
+        var busFrameOutDefId = RegisterClientStruct<BusFrameMsg>("FSC_BUS_FRAME_OUT", producer: false);
+        _busFrameDefId = RegisterClientStruct<BusFrameMsg>("FSC_BUS_FRAME_IN", producer: true);
         _varWatchDefId = RegisterClientStruct<VarSetMsg>("FSC_VARIABLE", producer: false);
+        var varBatchDefId = RegisterClientStruct<VarBatchMsg>("FSC_VARIABLE_BATCH", producer: false);
         _setDefId = RegisterClientStruct<VarSetMsg>("FSC_SET", producer: true);
+        _watchDefId = RegisterClientStruct<VarWatchMsg>("FSC_WATCH_H", producer: true);
+        var watchAckDefId = RegisterClientStruct<VarAcksMsg>("FSC_WATCH_ACK", producer: false);
+        _unwatchDefId = RegisterClientStruct<VarHandleMsg>("FSC_UNWATCH_H", producer: true);
+        _setHandleDefId = RegisterClientStruct<VarValueMsg>("FSC_SET_H", producer: true);
+        _motionDefId = RegisterClientStruct<MotionMsg>("FSC_MOTION", producer: true);
+        var statsDefId = RegisterClientStruct<StatsMsg>("FSC_STATS", producer: false);
+        _watchListDefId = RegisterClientStruct<VarWatchListMsg>("FSC_WATCH_LIST", producer: true);
+        var snapshotDefId = RegisterClientStruct<VarSnapshotMsg>("FSC_VARIABLE_SNAPSHOT", producer: false);
+        _snapshotAckDefId = RegisterClientStruct<SnapshotAckMsg>("FSC_SNAPSHOT_ACK", producer: true);
 
         var wasmVersion = new Subject<string>();
         _consumer.SimClientData
@@ -63,6 +93,30 @@ public class SimClient : IDisposable
             .Where(v => !string.IsNullOrWhiteSpace(v))
             .Select(v => !v.Equals(WasmVersion));
 
+        // announce ourselves once per sim connection, the bridge picks the variable transport from it.
+        // Once we hold values the hello carries the hash of our watch set, a bridge that kept the same
+        // set only sends what changed. Handles are bound again by sending the whole set as one watch list,
+        // the bridge acks the watches it still holds without a snapshot.
+        _consumer.Connected
+            .Where(connected => connected)
+            .Select(_ => wasmVersion.Where(v => !string.IsNullOrWhiteSpace(v)).Take(1))
+            .Switch()
+            .Subscribe(_ => _producer.Post(sim =>
+            {
+                _batchReader.Reset();
+                _busReader.Reset();
+                _varHandles.Clear();
+                foreach (var name in _watched.Keys) _unacked[name] = 0;
+                var hash = _hasValues ? WatchSetHash(_watched.Values) : 0;
+                sim.SetClientData(helloDefId, helloDefId,
+                    SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new StrMsg { Msg = hash == 0 ? WasmVersion : $"{WasmVersion} {hash:x16}" });
+                ResendWatches(sim);
+            }));
+
+        // a list the bridge missed, because it was not up yet or the message was lost, goes out again
+        Observable.Interval(TimeSpan.FromMilliseconds(1000))
+            .Subscribe(_ => _producer.Post(ResendWatches));
+
         Observable.Interval(TimeSpan.FromMilliseconds(200))
             .WithLatestFrom(_control, (_, control) => control)
             .Subscribe(control => _producer.Post(sim => sim.SetClientData(controlDefId, controlDefId,
@@ -76,15 +130,101 @@ public class SimClient : IDisposable
             commBusDefId, commBusDefId, commBusDefId, 
             SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
        
+        _consumer.Configure(sim => sim.RequestClientData(
+            busFrameOutDefId, busFrameOutDefId, busFrameOutDefId, 
+            SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == busFrameOutDefId && e.dwData is { Length: > 0 })
+            .Select(e => (BusFrameMsg)e.dwData[0])
+            .Subscribe(msg => _busReader.Read(msg.Seq, msg.Data.AsSpan(0, Math.Min((int)msg.Size, msg.Data.Length))));
+       
         _consumer.Configure(sim => sim.RequestClientData(
             _varWatchDefId, _varWatchDefId, _varWatchDefId, 
             SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        _consumer.Configure(sim => sim.RequestClientData(
+            varBatchDefId, varBatchDefId, varBatchDefId, 
+            SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        var singleVars = _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == _varWatchDefId && e.dwData is { Length: > 0 })
+            .Select(e => (VarSetMsg)e.dwData[0])
+            .Select(msg => (msg.Name, msg.Value));
+
+        _consumer.Configure(sim => sim.RequestClientData(
+            watchAckDefId, watchAckDefId, watchAckDefId, 
+            SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == watchAckDefId && e.dwData is { Length: > 0 })
+            .Select(e => (VarAcksMsg)e.dwData[0])
+            .Subscribe(msg =>
+            {
+                for (var i = 0; i < Math.Min((int)msg.Count, msg.Acks.Length); i++)
+                {
+                    var ack = msg.Acks[i];
+                    if (!_tagVars.TryGetValue(ack.Tag, out var name)) continue;
+                    _unacked.TryRemove(name, out _);
+                    if (ack.Handle == uint.MaxValue) continue;
+                    _varHandles[name] = ack.Handle;
+                    if (ack.Handle <= ushort.MaxValue) _batchReader.Bind((ushort)ack.Handle, name);
+                }
+            });
+
+        _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == varBatchDefId && e.dwData is { Length: > 0 })
+            .Select(e => (VarBatchMsg)e.dwData[0])
+            .Subscribe(msg =>
+            {
+                _hasValues = true;
+                _batchReader.Read(msg.Seq, msg.Count, msg.Data.AsSpan(0, Math.Min((int)msg.Size, msg.Data.Length)));
+            });
+
+        // watches asked for close together go out as one list, the bridge answers with a snapshot of
+        // their values and holds their deltas until we acknowledge the last part
+        _watchRequests
+            .Buffer(TimeSpan.FromMilliseconds(100))
+            .Where(watches => watches.Count > 0)
+            .Subscribe(watches => _producer.Post(sim => SendWatchList(sim, watches)));
+
+        _consumer.Configure(sim => sim.RequestClientData(
+            snapshotDefId, snapshotDefId, snapshotDefId, 
+            SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == snapshotDefId && e.dwData is { Length: > 0 })
+            .Select(e => (VarSnapshotMsg)e.dwData[0])
+            .Subscribe(msg =>
+            {
+                _hasValues = true;
+                _batchReader.ReadSnapshot(msg.Count, msg.Data.AsSpan(0, Math.Min((int)msg.Size, msg.Data.Length)));
+                if (msg.Last == 0) return;
+                Log.Debug("[SimConnect] Variable snapshot {Id} received in {Parts} parts", msg.Id, msg.Seq);
+                _producer.Post(sim => sim.SetClientData(_snapshotAckDefId, _snapshotAckDefId,
+                    SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new SnapshotAckMsg { Id = msg.Id }));
+            });
+
+        _consumer.Configure(sim => sim.RequestClientData(
+            statsDefId, statsDefId, statsDefId, 
+            SIMCONNECT_CLIENT_DATA_PERIOD.ON_SET, SIMCONNECT_CLIENT_DATA_REQUEST_FLAG.DEFAULT, 0, 0, 0), _ => {});
+
+        Stats = _consumer.SimClientData
+            .Where(e => (DEF)e.dwDefineID == statsDefId && e.dwData is { Length: > 0 })
+            .Select(e => ((StatsMsg)e.dwData[0]).ToStats())
+            .ObserveOn(TaskPoolScheduler.Default)
+            .Publish().RefCount();
+
+        _variables = singleVars.Merge(_batchReader.Values)
+            .ObserveOn(TaskPoolScheduler.Default)
+            .Publish().RefCount();
  
         var socketMessages = _consumer.SimClientData
             .ObserveOn(TaskPoolScheduler.Default)
             .Where(e => (DEF)e.dwDefineID == commBusDefId)
             .Select(e => (StrMsg)e.dwData[0])
             .Select(msg => msg.Msg)
+            .Merge(_busReader.Messages.ObserveOn(TaskPoolScheduler.Default))
             .Do(json => Log.Verbose("[SimConnect] RECV: {json}", json))
             .Select(json => JsonDocument.Parse(json).RootElement)
             .Replay(0).RefCount();
@@ -192,6 +332,13 @@ public class SimClient : IDisposable
     //     _producer.Post(sim => sim.SetClientData(_commBusDefId, _commBusDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new CommBusMsg { Msg = msg }));
     // }
 
+    public void SetMotion(byte[] data)
+    {
+        var msg = new MotionMsg { Size = (byte)data.Length, Data = new byte[255] };
+        data.CopyTo(msg.Data, 0);
+        _producer.Post(sim => sim.SetClientData(_motionDefId, _motionDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, msg));
+    }
+
     public void SetControl(BehaviorControl value) => _control.OnNext(value);
 
     public void Set(Interact interact)
@@ -203,7 +350,98 @@ public class SimClient : IDisposable
             writer.WriteString("id", interact.Id);
             writer.WriteString("value", interact.Value);
         });
-        _producer.Post(sim => sim.SetClientData(_commBusDefId, _commBusDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new StrMsg { Msg = msg }));
+        _busWriter.Add(msg);
+        _producer.Post(FlushBus);
+    }
+
+    // sends everything queued so far, messages added while earlier posts were pending go out together
+    private void FlushBus(SimConnect sim)
+    {
+        var data = new byte[BusFrames.DataSize];
+        while (_busWriter.TryNext(data, out var seq, out var size))
+        {
+            sim.SetClientData(_busFrameDefId, _busFrameDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0,
+                new BusFrameMsg { Seq = seq, Size = size, Data = data });
+            data = new byte[BusFrames.DataSize];
+        }
+    }
+    
+    // the unacked watches that went out more than a second ago, all in one list
+    private void ResendWatches(SimConnect sim)
+    {
+        var due = Environment.TickCount64 - 1000;
+        var watches = _watched
+            .Where(e => _unacked.TryGetValue(e.Key, out var sent) && sent <= due)
+            .Select(e => e.Value)
+            .ToList();
+        if (watches.Count > 0) SendWatchList(sim, watches);
+    }
+
+    // packs the watches into FSC_WATCH_LIST parts (watch_list.h), all under one list id
+    private void SendWatchList(SimConnect sim, IList<VarWatchMsg> watches)
+    {
+        var id = Interlocked.Increment(ref _watchListId);
+        var now = Environment.TickCount64;
+        foreach (var w in watches)
+            if (_unacked.TryGetValue(w.Name, out var sent)) _unacked.TryUpdate(w.Name, now, sent);
+
+        var data = new byte[WatchListDataSize];
+        var size = 0;
+        ushort count = 0;
+
+        foreach (var w in watches)
+        {
+            var name = Encoding.ASCII.GetBytes(w.Name);
+            var units = Encoding.ASCII.GetBytes(w.Units);
+            var length = 4 + 2 + 1 + Math.Min(name.Length, 127) + 1 + Math.Min(units.Length, 63);
+            if (size + length > data.Length)
+            {
+                Send(last: false);
+                data = new byte[WatchListDataSize];
+                size = 0;
+                count = 0;
+            }
+
+            BinaryPrimitives.WriteUInt32LittleEndian(data.AsSpan(size), w.Tag);
+            data[size + 4] = w.Flags;
+            data[size + 5] = w.Rate;
+            size += 6;
+            size += WriteText(data.AsSpan(size), name, 127);
+            size += WriteText(data.AsSpan(size), units, 63);
+            count++;
+        }
+        Send(last: true);
+
+        void Send(bool last) => sim.SetClientData(_watchListDefId, _watchListDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0,
+            new VarWatchListMsg { Id = id, Count = count, Last = (byte)(last ? 1 : 0), Data = data });
+
+        static int WriteText(Span<byte> dest, byte[] text, int max)
+        {
+            var length = Math.Min(text.Length, max);
+            dest[0] = (byte)length;
+            text.AsSpan(0, length).CopyTo(dest[1..]);
+            return 1 + length;
+        }
+    }
+    
+    // same as var_watcher::set_hash in the bridge: the sum of the finalized 64-bit FNV-1a hashes of "name\0units"
+    private static ulong WatchSetHash(IEnumerable<VarWatchMsg> watches)
+    {
+        ulong sum = 0;
+        foreach (var watch in watches)
+        {
+            var h = 14695981039346656037UL;
+            foreach (var b in Encoding.ASCII.GetBytes(watch.Name[..Math.Min(watch.Name.Length, 127)]))
+                h = (h ^ b) * 1099511628211UL;
+            h *= 1099511628211UL;
+            foreach (var b in Encoding.ASCII.GetBytes(watch.Units[..Math.Min(watch.Units.Length, 63)]))
+                h = (h ^ b) * 1099511628211UL;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDUL;
+            h ^= h >> 33;
+            sum += h;
+        }
+        return sum;
     }
     
     public void Set(string eventName, object value) =>
@@ -303,9 +541,26 @@ public class SimClient : IDisposable
             writer.WritePrimitive("value", value);
         });
         // _producer.Post(sim => sim.SetClientData(_commBusDefId, _commBusDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new CommBusMsg { Msg = msg }));
-        _producer.Post(sim => sim.SetClientData(_setDefId, _setDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarSetMsg { Name = name, Value = Convert.ToDouble(value) }));
+        var doubleValue = Convert.ToDouble(value);
+        if (_varHandles.TryGetValue(name, out var handle))
+        {
+            _producer.Post(sim => sim.SetClientData(_setHandleDefId, _setHandleDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarValueMsg { Handle = handle, Value = doubleValue }));
+            return;
+        }
+
+        // first set of this name, send it by name and ask the bridge for a handle for the next ones
+        _producer.Post(sim => sim.SetClientData(_setDefId, _setDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarSetMsg { Name = name, Value = doubleValue }));
+        _producer.Post(sim => sim.SetClientData(_watchDefId, _watchDefId, SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, 
+            new VarWatchMsg { Tag = VarTag(name), Flags = WatchResolve, Name = name, Units = string.Empty }));
     }
 
+    private uint VarTag(string name) => _varTags.GetOrAdd(name, key =>
+    {
+        var tag = Interlocked.Increment(ref _varTag);
+        _tagVars[tag] = key;
+        return tag;
+    });
+
     public IObservable<T> Stream<T>() where T : struct
     {
         var key = typeof(T).FullName!;
@@ -356,11 +611,12 @@ public class SimClient : IDisposable
         }).Replay(1).RefCount());
     }
 
-    public IObservable<object> Stream(string name, string sUnits)
+    /// <param name="rate">Poll rate of bridge watched variables: 0 every frame, 1-254 Hz, 255 background.</param>
+    public IObservable<object> Stream(string name, string sUnits, byte rate = 0)
     {
         if (name.StartsWith("L:")) return SimVar(name, string.IsNullOrWhiteSpace(sUnits) ? "number" : sUnits, SIMCONNECT_DATATYPE.FLOAT32);
-        if (name.StartsWith("B:")) return ClientVar(name, string.IsNullOrWhiteSpace(sUnits) ? "number" : sUnits);
-        if (name.StartsWith("Z:")) return ClientVar(name, string.IsNullOrWhiteSpace(sUnits) ? "number" : sUnits);
+        if (name.StartsWith("B:")) return ClientVar(name, string.IsNullOrWhiteSpace(sUnits) ? "number" : sUnits, rate);
+        if (name.StartsWith("Z:")) return ClientVar(name, string.IsNullOrWhiteSpace(sUnits) ? "number" : sUnits, rate);
         if (name.StartsWith("A:")) return SimVar(name[2..], sUnits);
         if (name.StartsWith("H:")) return HVar(name);
         // if (datumName.StartsWith("K:")) return KEvent(datumName[2..], sUnits);
@@ -438,31 +694,29 @@ public class SimClient : IDisposable
             }
         }).Replay(1).RefCount());
 
-    private IObservable<object> ClientVar(string datumName, string sUnits) => 
+    private IObservable<object> ClientVar(string datumName, string sUnits, byte rate) => 
         (IObservable<object>)_streams.GetOrAdd(datumName, key => Observable.Create<object>(observer =>
         {
-            var sub = _consumer.SimClientData
-                .ObserveOn(TaskPoolScheduler.Default)
-                .Where(e => (DEF)e.dwDefineID == _varWatchDefId && e.dwData is { Length: > 0 })
-                .Select(e => (VarSetMsg)e.dwData[0])
+            var sub = _variables
                 .Where(e => e.Name.Equals(datumName, StringComparison.InvariantCultureIgnoreCase))
                 .Subscribe(e => observer.OnNext(e.Value),
                     observer.OnError,
                     observer.OnCompleted);
 
-            var watch = Observable.Interval(TimeSpan.FromMilliseconds(1000))
-                .StartWith(0)
-                // _wasmReady
-                // .Where(ready => ready)
-                .Subscribe(_ => _producer.Post(sim => sim.SetClientData(_watchDefId, _watchDefId,
-                    SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarSetMsg { Name = datumName, Units = sUnits })));
+            // goes out in the next watch list, ResendWatches repeats it until the bridge acks it
+            var watchMsg = new VarWatchMsg { Tag = VarTag(datumName), Flags = WatchPoll, Rate = rate, Name = datumName, Units = sUnits };
+            _watched[datumName] = watchMsg;
+            _unacked[datumName] = Environment.TickCount64;
+            _watchRequests.OnNext(watchMsg);
  
             return () =>
             {
-                watch.Dispose();
                 sub.Dispose();
+                _watched.TryRemove(datumName, out _);
+                _unacked.TryRemove(datumName, out _);
+                if (!_varHandles.TryGetValue(datumName, out var handle)) return;
                 _producer.Post(sim => sim.SetClientData(_unwatchDefId, _unwatchDefId,
-                    SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarSetMsg { Name = datumName }));
+                    SIMCONNECT_CLIENT_DATA_SET_FLAG.DEFAULT, 0, new VarHandleMsg { Handle = handle }));
             };
         }).Replay(1).RefCount());
     
@@ -554,4 +808,139 @@ public class SimClient : IDisposable
         public string Units;
         public double Value;
     }
+    
+    private const byte WatchResolve = 0;
+    private const byte WatchPoll = 1;
+
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi, Pack = 1)]
+    private struct VarWatchMsg
+    {
+        public uint Tag;
+        public byte Flags;
+        public byte Rate;
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 128)]
+        public string Name;
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 64)]
+        public string Units;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarAck
+    {
+        public uint Tag;
+        public uint Handle;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarAcksMsg
+    {
+        public uint Count;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 127)]
+        public VarAck[] Acks;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarHandleMsg
+    {
+        public uint Handle;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarValueMsg
+    {
+        public uint Handle;
+        public double Value;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarBatchMsg
+    {
+        public uint Seq;
+        public ushort Count;
+        public ushort Size;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4088)]
+        public byte[] Data;
+    }
+
+    private const int WatchListDataSize = 4088;
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarWatchListMsg
+    {
+        public uint Id;
+        public ushort Count;
+        public byte Last;
+        public byte Reserved;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = WatchListDataSize)]
+        public byte[] Data;
+    }
+
+    // var_batch with the snapshot id in front, Seq numbers the parts from 1
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct VarSnapshotMsg
+    {
+        public uint Id;
+        public byte Last;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 3)]
+        public byte[] Reserved;
+        public uint Seq;
+        public ushort Count;
+        public ushort Size;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4088)]
+        public byte[] Data;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct SnapshotAckMsg
+    {
+        public uint Id;
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct MotionMsg
+    {
+        public byte Size;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 255)]
+        public byte[] Data;
+    }
+
+    private const int StatsHistogramSize = 8 + 4 + 4 + BridgeStats.BucketCount * 4;
+
+    // protocol::bridge_stats, 540 bytes
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct StatsMsg
+    {
+        public uint Seq;
+        public uint IntervalMs;
+        public double OffsetSec;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = BridgeStats.TimerCount * StatsHistogramSize)]
+        public byte[] Timers;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = BridgeStats.CounterCount)]
+        public uint[] Counters;
+
+        public BridgeStats ToStats()
+        {
+            var timers = new BridgeStats.Histogram[Timers.Length / StatsHistogramSize];
+            for (var i = 0; i < timers.Length; i++)
+            {
+                var h = Timers.AsSpan(i * StatsHistogramSize, StatsHistogramSize);
+                var buckets = new uint[BridgeStats.BucketCount];
+                for (var b = 0; b < buckets.Length; b++) buckets[b] = BinaryPrimitives.ReadUInt32LittleEndian(h[(16 + b * 4)..]);
+                timers[i] = new(BinaryPrimitives.ReadUInt64LittleEndian(h),
+                    BinaryPrimitives.ReadUInt32LittleEndian(h[8..]),
+                    BinaryPrimitives.ReadUInt32LittleEndian(h[12..]),
+                    buckets);
+            }
+            return new(Seq, IntervalMs, OffsetSec, timers, Counters);
+        }
+    }
+
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    private struct BusFrameMsg
+    {
+        public uint Seq;
+        public ushort Size;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = BusFrames.DataSize)]
+        public byte[] Data;
+    }
 }
\ No newline at end of file
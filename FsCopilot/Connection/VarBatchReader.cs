@@ -0,0 +1,128 @@
+namespace FsCopilot.Connection;
+
+using System.Buffers.Binary;
+
+/// <summary>
+/// Decodes FSC_VARIABLE_BATCH frames and FSC_VARIABLE_SNAPSHOT parts sent by the bridge. Handles are bound to names either by
+/// name records in the batch (1.2 bridges) or by watch acknowledgements, so the reader keeps the
+/// handle table for the bridge session. Values for handles that are not bound yet are held back
+/// until the binding arrives.
+/// </summary>
+internal sealed class VarBatchReader
+{
+    private const byte RecName = 1;
+    private const byte RecBits = 2;
+    private const byte RecI8 = 3;
+    private const byte RecI16 = 4;
+    private const byte RecI32 = 5;
+    private const byte RecF32 = 6;
+    private const byte RecF64 = 7;
+
+    private readonly Dictionary<ushort, string> _names = new();
+    private readonly Dictionary<ushort, double> _pending = new();
+    private readonly Subject<(string Name, double Value)> _values = new();
+    private readonly Lock _lock = new();
+    private uint? _lastSeq;
+
+    public IObservable<(string Name, double Value)> Values => _values;
+
+    public void Reset()
+    {
+        lock (_lock)
+        {
+            _names.Clear();
+            _pending.Clear();
+            _lastSeq = null;
+        }
+    }
+
+    public void Bind(ushort handle, string name)
+    {
+        lock (_lock)
+        {
+            _names[handle] = name;
+            if (_pending.Remove(handle, out var value)) _values.OnNext((name, value));
+        }
+    }
+
+    public void Read(uint seq, ushort count, ReadOnlySpan<byte> data)
+    {
+        lock (_lock)
+        {
+            if (_lastSeq is { } last && seq != unchecked(last + 1))
+                Log.Warning("[SimConnect] Variable batch gap: {Last} -> {Seq}", last, seq);
+            _lastSeq = seq;
+            ReadRecords(count, data);
+        }
+    }
+
+    /// <summary>Reads one FSC_VARIABLE_SNAPSHOT part, batch records outside the batch sequence.</summary>
+    public void ReadSnapshot(ushort count, ReadOnlySpan<byte> data)
+    {
+        lock (_lock) ReadRecords(count, data);
+    }
+
+    private void ReadRecords(ushort count, ReadOnlySpan<byte> data)
+    {
+        var pos = 0;
+        for (var r = 0; r < count && pos < data.Length; r++)
+        {
+            var tag = data[pos++];
+            if (tag == RecBits)
+            {
+                int n = data[pos++];
+                var bits = data.Slice(pos + n * 2);
+                for (var i = 0; i < n; i++)
+                {
+                    var handle = BinaryPrimitives.ReadUInt16LittleEndian(data[(pos + i * 2)..]);
+                    var value = (bits[i / 8] >> (i % 8)) & 1;
+                    Emit(handle, value);
+                }
+                pos += n * 2 + (n + 7) / 8;
+                continue;
+            }
+
+            var h = BinaryPrimitives.ReadUInt16LittleEndian(data[pos..]);
+            pos += 2;
+            switch (tag)
+            {
+                case RecName:
+                    int len = data[pos++];
+                    _names[h] = Encoding.ASCII.GetString(data.Slice(pos, len));
+                    pos += len;
+                    break;
+                case RecI8:
+                    Emit(h, (sbyte)data[pos]);
+                    pos += 1;
+                    break;
+                case RecI16:
+                    Emit(h, BinaryPrimitives.ReadInt16LittleEndian(data[pos..]));
+                    pos += 2;
+                    break;
+                case RecI32:
+                    Emit(h, BinaryPrimitives.ReadInt32LittleEndian(data[pos..]));
+                    pos += 4;
+                    break;
+                case RecF32:
+                    Emit(h, BinaryPrimitives.ReadSingleLittleEndian(data[pos..]));
+                    pos += 4;
+                    break;
+                case RecF64:
+                    Emit(h, BinaryPrimitives.ReadDoubleLittleEndian(data[pos..]));
+                    pos += 8;
+                    break;
+                default:
+                    Log.Warning("[SimConnect] Unknown variable record {Tag}", tag);
+                    return;
+            }
+        }
+
+        return;
+
+        void Emit(ushort handle, double value)
+        {
+            if (_names.TryGetValue(handle, out var name)) _values.OnNext((name, value));
+            else _pending[handle] = value;
+        }
+    }
+}
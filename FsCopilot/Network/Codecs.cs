@@ -15,10 +15,18 @@ internal interface IPacketCodecAdapter
 
 internal sealed class Codecs
 {
+    /// <summary>
+    /// Version of the peer protocol. The type hashes in <see cref="Schema"/> catch layout changes
+    /// of packets, bump this for changes they can't see, such as the bytes inside a Motion frame
+    /// (motion_codec.h). Releases before 2 sent raw Physics/Surfaces packets and had no version.
+    /// </summary>
+    public const int Protocol = 2;
+
     private readonly List<IPacketCodecAdapter> _byId = [];
     private readonly Dictionary<Type, byte> _idByType = new();
     
-    public string Schema { get; private set; } = string.Empty;
+    /// <summary>Sent in the connection handshake, peers with a different schema are refused.</summary>
+    public string Schema { get; private set; } = $"v{Protocol}:";
 
     public Codecs Add<TPacket, TCodec>()
         where TCodec : IPacketCodec<TPacket>, new()
@@ -18,6 +18,8 @@ public sealed class HybridNetwork : INetwork, IDisposable
 
     public IObservable<ICollection<Peer>> Peers { get; }
 
+    public IObservable<string> Mismatched => Observable.Merge(_p2p.Mismatched, _relay.Mismatched);
+
     public HybridNetwork(string host, string peerId, string name)
     {
         _peerId = peerId;
@@ -3,6 +3,9 @@ namespace FsCopilot.Network;
 public interface INetwork
 {
     IObservable<ICollection<Peer>> Peers { get; }
+
+    /// <summary>Peers refused because they run another protocol version, by peer id.</summary>
+    IObservable<string> Mismatched { get; }
     
     Task<ConnectionResult> Connect(string target, CancellationToken ct);
 
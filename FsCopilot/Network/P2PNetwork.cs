@@ -18,6 +18,7 @@ public sealed class P2PNetwork : INetwork, IDisposable
     private readonly EventBasedNetListener _netListener = new();
     private readonly ConcurrentDictionary<Type, object> _streams = new();
     private readonly Subject<Unit> _publish = new();
+    private readonly Subject<string> _mismatched = new();
     private readonly Codecs _codecs = new Codecs()
             .Add<PeerTags, PeerTags.Codec>();
     
@@ -34,6 +35,8 @@ public sealed class P2PNetwork : INetwork, IDisposable
 
     public IObservable<ICollection<Peer>> Peers { get; }
 
+    public IObservable<string> Mismatched => _mismatched.ObserveOn(TaskPoolScheduler.Default);
+
     public P2PNetwork(string host, string peerId, string name, bool autoConnect = true)
     {
         _host = host;
@@ -86,6 +89,7 @@ public sealed class P2PNetwork : INetwork, IDisposable
         _cts.Cancel();
         _net.Stop();
         _publish.OnCompleted();
+        _mismatched.OnCompleted();
 
         foreach (var subj in _streams.Values)
         {
@@ -199,7 +203,9 @@ public sealed class P2PNetwork : INetwork, IDisposable
         var schema = parts[2];
         if (!_codecs.Schema.Equals(schema))
         {
+            Log.Warning("[Peer2Peer] REJ {PeerId} runs another protocol version", targetPeer);
             request.Reject(NetDataWriter.FromString(_peerId)); 
+            _mismatched.OnNext(targetPeer);
             return;
         }
 
@@ -246,7 +252,8 @@ public sealed class P2PNetwork : INetwork, IDisposable
             if (_connectWaiters.TryGetValue(peerId, out var tcs))
                 tcs.TrySetResult(ConnectionResult.Rejected);
 
-            Log.Debug("[Peer2Peer] REJ {PeerId} {Reason}", peerId, "VERSION_MISMATCH");
+            Log.Warning("[Peer2Peer] REJ {PeerId} {Reason}", peerId, "VERSION_MISMATCH");
+            _mismatched.OnNext(peerId);
             return;
         }
 
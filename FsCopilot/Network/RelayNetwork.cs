@@ -37,6 +37,7 @@ public sealed class RelayNetwork : INetwork, IDisposable
     private readonly bool _autoConnect;
 
     private readonly Subject<Unit> _publish = new();
+    private readonly Subject<string> _mismatched = new();
     private readonly ConcurrentDictionary<string, Peer> _peers = new(StringComparer.Ordinal);
     private readonly ConcurrentDictionary<Type, object> _streams = new();
     private readonly ConcurrentDictionary<string, TaskCompletionSource<ConnectionResult>> _connectWaiters = new(StringComparer.Ordinal);
@@ -51,6 +52,8 @@ public sealed class RelayNetwork : INetwork, IDisposable
 
     public IObservable<ICollection<Peer>> Peers { get; }
 
+    public IObservable<string> Mismatched => _mismatched.ObserveOn(TaskPoolScheduler.Default);
+
     public RelayNetwork(string host, string peerId, string name, bool autoConnect = true)
     {
         _host = host;
@@ -100,6 +103,7 @@ public sealed class RelayNetwork : INetwork, IDisposable
         try { _net.Stop(); } catch { /* ignore */ }
 
         _publish.OnCompleted();
+        _mismatched.OnCompleted();
 
         foreach (var subj in _streams.Values)
         {
@@ -421,6 +425,8 @@ public sealed class RelayNetwork : INetwork, IDisposable
         var result = code == "SCHEMA_MISMATCH" ? ConnectionResult.Rejected : ConnectionResult.Failed;
         if (_connectWaiters.TryGetValue(otherPeerId, out var tcs))
             tcs.TrySetResult(result);
+        if (result == ConnectionResult.Rejected)
+            _mismatched.OnNext(otherPeerId);
     }
 
     private void OnPeerTags(PeerTags tags)
@@ -13,6 +13,8 @@ public class Coordinator : IDisposable
     private readonly CompositeDisposable _d = new();
     private CompositeDisposable _cSubs = new();
     private readonly BehaviorSubject<bool?> _configured = new(null);
+    private readonly Stopwatch _clock = Stopwatch.StartNew();
+    private readonly ulong _sessionId;
     public IObservable<bool?> Configured => _configured;
 
     public Coordinator(SimClient sim, INetwork net, MasterSwitch masterSwitch)
@@ -20,33 +22,42 @@ public class Coordinator : IDisposable
         _net = net;
         _masterSwitch = masterSwitch;
         _sim = sim;
-        var sw = Stopwatch.StartNew();
         
         Span<byte> sessionBytes = stackalloc byte[8];
         RandomNumberGenerator.Fill(sessionBytes);
-        var sessionId = BitConverter.ToUInt64(sessionBytes);
+        _sessionId = BitConverter.ToUInt64(sessionBytes);
         
         net.RegisterPacket<Update, Update.Codec>();
         net.RegisterPacket<Interact, InteractCodec>();
 
         _sim.Register<Physics>();
         _sim.Register<Surfaces>();
-        _net.RegisterPacket<Physics, Physics.Codec>();
-        _net.RegisterPacket<Surfaces, Surfaces.Codec>();
+        _sim.Register<Levers>();
+        _net.RegisterPacket<Motion, Motion.Codec>();
+        _net.RegisterPacket<Levers, Levers.Codec>();
+        var motion = new MotionEncoder();
         
         _d.Add(sim.Aircraft.Subscribe(Load));
         
-        _d.Add(sim.Aircraft.Take(1).Subscribe(_ => AddLink((ref Physics physics) =>
+        _d.Add(sim.Aircraft.Take(1).Subscribe(_ => AddLink(_d, (ref Physics physics) =>
         {
-            physics.SessionId = sessionId;
-            physics.TimeMs = (uint)sw.ElapsedMilliseconds;
-        })));
+            physics.SessionId = _sessionId;
+            physics.TimeMs = (uint)_clock.ElapsedMilliseconds;
+        }, motion.Encode)));
         
-        _d.Add(sim.Aircraft.Take(1).Subscribe(_ => AddLink((ref Surfaces surfaces) =>
+        _d.Add(sim.Aircraft.Take(1).Subscribe(_ => AddLink(_d, (ref Surfaces surfaces) =>
         {
-            surfaces.SessionId = sessionId;
-            surfaces.TimeMs = (uint)sw.ElapsedMilliseconds;
-        })));
+            surfaces.SessionId = _sessionId;
+            surfaces.TimeMs = (uint)_clock.ElapsedMilliseconds;
+        }, motion.Encode)));
+
+        _d.Add(_net.Stream<Motion>()
+            .Where(_ => !_masterSwitch.IsMaster)
+            .Subscribe(update =>
+            {
+                try { _sim.SetMotion(update.Data); }
+                catch (Exception e) { Log.Error(e, "[Coordinator] Error processing packet {Packet}", nameof(Motion)); }
+            }, ex => { Log.Fatal(ex, "[Coordinator] Error while processing a message from client"); }));
 
         _d.Add(_sim.Interactions
             .Subscribe(interact => _net.SendAll(interact)));
@@ -74,28 +85,42 @@ public class Coordinator : IDisposable
         }
         _configured.OnNext(true);
 
+        if (definitions.Levers != LeverChannels.None) AddLevers(definitions.Levers);
         foreach (var def in definitions) AddLink(def);
     }
+
+    // Only the channels the profile lists are sent, and only those are written on this side, whatever
+    // the master sends.
+    private void AddLevers(LeverChannels channels)
+    {
+        AddLink(_cSubs, (ref Levers levers) =>
+        {
+            levers = levers.Only(channels);
+            levers.SessionId = _sessionId;
+            levers.TimeMs = (uint)_clock.ElapsedMilliseconds;
+        }, levers => levers);
+
+        _cSubs.Add(_net.Stream<Levers>()
+            .Where(_ => !_masterSwitch.IsMaster)
+            .Subscribe(levers =>
+            {
+                try { _sim.Set(levers.Only(channels)); }
+                catch (Exception e) { Log.Error(e, "[Coordinator] Error processing packet {Packet}", nameof(Levers)); }
+            }, ex => { Log.Fatal(ex, "[Coordinator] Error while processing a message from client"); }));
+    }
     
-    private void AddLink<TPacket>(RefAction<TPacket> modify)
+    private void AddLink<TPacket, TSend>(CompositeDisposable subs, RefAction<TPacket> modify, Func<TPacket, TSend> encode)
         where TPacket : unmanaged
+        where TSend : notnull
     {
-        _d.Add(_sim.Stream<TPacket>()
+        subs.Add(_sim.Stream<TPacket>()
             .Where(_ => _masterSwitch.IsMaster)
             .Subscribe(update =>
             {
                 modify(ref update);
-                try { _net.SendAll(update, true); }
+                try { _net.SendAll(encode(update), true); }
                 catch (Exception e) { Log.Error(e, "[Coordinator] Error while sending packet {Packet}", typeof(TPacket).Name); }
             }, ex => { Log.Fatal(ex, "[Coordinator] Error while processing a message from sim"); }));
-
-        _d.Add(_net.Stream<TPacket>()
-            .Where(_ => !_masterSwitch.IsMaster)
-            .Subscribe(update =>
-            {
-                try { _sim.Set(update); }
-                catch (Exception e) { Log.Error(e, "[Coordinator] Error processing packet {Packet}", typeof(TPacket).Name); }
-            }, ex => { Log.Fatal(ex, "[Coordinator] Error while processing a message from client"); }));
     }
 
     private void AddLink(Definition def)
@@ -104,7 +129,7 @@ public class Coordinator : IDisposable
         object? currentValue = null;
         var getVar = def.Get;
         
-        _cSubs.Add(_sim.Stream(getVar, def.Units)
+        _cSubs.Add(_sim.Stream(getVar, def.Units, def.Rate)
             .Do(value => currentValue = value)
             .Where(_ => !master || _masterSwitch.IsMaster)
             .Delay(getVar[0] == 'H' ? TimeSpan.FromMilliseconds(500) : TimeSpan.Zero)
@@ -26,10 +26,16 @@ public class Definitions : IReadOnlyCollection<Definition>
 
     public string[] Ignore { get; }
 
-    private Definitions(Definition[] links, string[] ignore)
+    /// <summary>
+    /// Lever channels streamed for this aircraft, none unless the profile lists them.
+    /// </summary>
+    public LeverChannels Levers { get; }
+
+    private Definitions(Definition[] links, string[] ignore, LeverChannels levers)
     {
         _links = links;
         Ignore = ignore;
+        Levers = levers;
     }
 
     [DynamicDependency(DynamicallyAccessedMemberTypes.PublicProperties | DynamicallyAccessedMemberTypes.NonPublicConstructors, typeof(Config))]
@@ -64,11 +70,12 @@ public class Definitions : IReadOnlyCollection<Definition>
         
         var master = (cfg.Master ?? [])
             .Where(m => !string.IsNullOrWhiteSpace(m.Get))
-            .Select(m => new Definition(false, m.Get, m.Set, m.Skp)).ToArray();
+            .Select(m => new Definition(false, m.Get, m.Set, m.Skp, m.Rate)).ToArray();
         var shared = (cfg.Shared ?? [])
             .Where(m => !string.IsNullOrWhiteSpace(m.Get))
-            .Select(m => new Definition(true, m.Get, m.Set, m.Skp)).ToArray();
+            .Select(m => new Definition(true, m.Get, m.Set, m.Skp, m.Rate)).ToArray();
         var ignore = (cfg.Ignore ?? []).Where(i => !string.IsNullOrWhiteSpace(i)).Select(i => i.Trim()).ToArray();
+        var levers = ParseLevers(path, cfg.Levers ?? []);
         node = new(path, (cfg.Include ?? [])
             .Select(i =>
             {
@@ -77,27 +84,43 @@ public class Definitions : IReadOnlyCollection<Definition>
             })
             .Where(def => def.loaded)
             .Select(def => def.child)
-            .ToArray(), master, shared, ignore);
+            .ToArray(), master, shared, ignore, levers);
         return true;
     }
 
+    private static LeverChannels ParseLevers(string path, string[] names)
+    {
+        var channels = LeverChannels.None;
+        foreach (var name in names.Where(n => !string.IsNullOrWhiteSpace(n)))
+        {
+            if (Enum.TryParse<LeverChannels>(name.Trim(), true, out var channel))
+                channels |= channel;
+            else
+                Log.Warning("[Definitions] Unknown lever channel {Channel} in {Module}", name, path);
+        }
+        return channels;
+    }
+
     public static Definitions Load(string name)
     {
-        if (!TryLoadTree($"{name}.yaml", out var node)) return new([], []);
+        if (!TryLoadTree($"{name}.yaml", out var node)) return new([], [], LeverChannels.None);
         var master = new List<Definition>();
         var shared = new List<Definition>();
         var ignore = new List<string>();
-        Collect(node, master, shared, ignore);
+        var levers = LeverChannels.None;
+        Collect(node, master, shared, ignore, ref levers);
         var simVars = master.Concat(shared).ToArray();
-        return new(simVars, ignore.ToArray());
+        return new(simVars, ignore.ToArray(), levers);
     }
 
-    private static void Collect(DefinitionNode node, List<Definition> master, List<Definition> shared, List<string> ignore)
+    private static void Collect(DefinitionNode node, List<Definition> master, List<Definition> shared, List<string> ignore,
+        ref LeverChannels levers)
     {
-        foreach (var child in node.Include) Collect(child, master, shared, ignore);
+        foreach (var child in node.Include) Collect(child, master, shared, ignore, ref levers);
         master.AddRange(node.Master);
         shared.AddRange(node.Shared);
         ignore.AddRange(node.Ignore);
+        levers |= node.Levers;
     }
 
     [DynamicallyAccessedMembers(DynamicallyAccessedMemberTypes.PublicProperties 
@@ -112,6 +135,8 @@ public class Definitions : IReadOnlyCollection<Definition>
         public Link[]? Master { get; set; } = [];
         [YamlMember(Alias = "ignore")]
         public string[]? Ignore { get; set; } = [];
+        [YamlMember(Alias = "levers")]
+        public string[]? Levers { get; set; } = [];
 
         [DynamicallyAccessedMembers(DynamicallyAccessedMemberTypes.PublicProperties)]
         public class Link
@@ -122,6 +147,8 @@ public class Definitions : IReadOnlyCollection<Definition>
             public string? Set { get; set; }
             [YamlMember(Alias = "skp")]
             public string? Skp { get; set; }
+            [YamlMember(Alias = "rate")]
+            public string? Rate { get; set; }
         }
     }
 
@@ -137,9 +164,10 @@ public record DefinitionNode(
     DefinitionNode[] Include,
     Definition[] Master,
     Definition[] Shared,
-    string[] Ignore)
+    string[] Ignore,
+    LeverChannels Levers)
 {
-    public static readonly DefinitionNode Empty = new(string.Empty, [], [], [], []);
+    public static readonly DefinitionNode Empty = new(string.Empty, [], [], [], [], LeverChannels.None);
 }
 
 public class Definition
@@ -149,8 +177,12 @@ public class Definition
     public string Get { get; init; }
     public string Units { get; init; }
     public string? Skip { get; init; }
+    /// <summary>
+    /// Bridge poll rate: 0 every frame, 1-254 Hz, 255 background round-robin.
+    /// </summary>
+    public byte Rate { get; init; }
 
-    public Definition(bool shared, string get, string? set, string? skp)
+    public Definition(bool shared, string get, string? set, string? skp, string? rate = null)
     {
         Shared = shared;
         var parts = get.Split(',');
@@ -158,8 +190,18 @@ public class Definition
         Get = parts[0].Trim();
         _set = set?.Trim();
         Skip = skp?.Trim();
+        Rate = ParseRate(rate?.Trim());
     }
 
+    private static byte ParseRate(string? rate) => rate switch
+    {
+        null or "" or "frame" => 0,
+        "background" => 255,
+        _ => double.TryParse(rate, NumberStyles.Float, CultureInfo.InvariantCulture, out var hz)
+            ? (byte)Math.Clamp(Math.Round(hz), 1, 254)
+            : (byte)0
+    };
+
     public string Set(object value, object current, 
         out object value0, out object? value1, out object? value2, out object? value3, out object? value4)
     {
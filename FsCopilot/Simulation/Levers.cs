@@ -0,0 +1,115 @@
+namespace FsCopilot.Simulation;
+
+using System.Runtime.InteropServices;
+using Connection;
+using Network;
+
+/// <summary>
+/// Lever and handle positions, streamed to the bridge as FSC_LEVERS and interpolated there like
+/// <see cref="Physics"/>. Field order and units must match protocol::levers and channels&lt;levers&gt;
+/// in channel_table.h.
+/// </summary>
+[StructLayout(LayoutKind.Sequential, Pack = 1)]
+public struct Levers
+{
+    [SimVar("GENERAL ENG THROTTLE LEVER POSITION:1", "Percent", 1)] public double Throttle1;
+    [SimVar("GENERAL ENG THROTTLE LEVER POSITION:2", "Percent", 2)] public double Throttle2;
+    [SimVar("GENERAL ENG THROTTLE LEVER POSITION:3", "Percent", 3)] public double Throttle3;
+    [SimVar("GENERAL ENG THROTTLE LEVER POSITION:4", "Percent", 4)] public double Throttle4;
+    [SimVar("GENERAL ENG MIXTURE LEVER POSITION:1", "Percent", 5)] public double Mixture1;
+    [SimVar("GENERAL ENG MIXTURE LEVER POSITION:2", "Percent", 6)] public double Mixture2;
+    [SimVar("GENERAL ENG MIXTURE LEVER POSITION:3", "Percent", 7)] public double Mixture3;
+    [SimVar("GENERAL ENG MIXTURE LEVER POSITION:4", "Percent", 8)] public double Mixture4;
+    [SimVar("GENERAL ENG PROPELLER LEVER POSITION:1", "Percent", 9)] public double Propeller1;
+    [SimVar("GENERAL ENG PROPELLER LEVER POSITION:2", "Percent", 10)] public double Propeller2;
+    [SimVar("GENERAL ENG PROPELLER LEVER POSITION:3", "Percent", 11)] public double Propeller3;
+    [SimVar("GENERAL ENG PROPELLER LEVER POSITION:4", "Percent", 12)] public double Propeller4;
+    [SimVar("SPOILERS HANDLE POSITION", "Percent", 13)] public double Spoilers;
+    [SimVar("ELEVATOR TRIM POSITION", "Radians", 14)] public double ElevatorTrim;
+    [SimVar("FLAPS HANDLE INDEX", "Number", 15)] public double FlapsIndex;
+    [SimVar("GEAR HANDLE POSITION", "Bool", 16)] public double GearHandle;
+    public ulong SessionId;
+    public uint TimeMs;
+
+    /// <summary>
+    /// The same levers with the channels outside <paramref name="channels"/> set to NaN, which the
+    /// bridge never writes.
+    /// </summary>
+    public Levers Only(LeverChannels channels)
+    {
+        var l = this;
+        if (!channels.HasFlag(LeverChannels.Throttle)) l.Throttle1 = l.Throttle2 = l.Throttle3 = l.Throttle4 = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Mixture)) l.Mixture1 = l.Mixture2 = l.Mixture3 = l.Mixture4 = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Propeller)) l.Propeller1 = l.Propeller2 = l.Propeller3 = l.Propeller4 = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Spoilers)) l.Spoilers = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Trim)) l.ElevatorTrim = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Flaps)) l.FlapsIndex = double.NaN;
+        if (!channels.HasFlag(LeverChannels.Gear)) l.GearHandle = double.NaN;
+        return l;
+    }
+
+    public class Codec : IPacketCodec<Levers>
+    {
+        public void Encode(Levers packet, BinaryWriter bw)
+        {
+            bw.Write(packet.Throttle1);
+            bw.Write(packet.Throttle2);
+            bw.Write(packet.Throttle3);
+            bw.Write(packet.Throttle4);
+            bw.Write(packet.Mixture1);
+            bw.Write(packet.Mixture2);
+            bw.Write(packet.Mixture3);
+            bw.Write(packet.Mixture4);
+            bw.Write(packet.Propeller1);
+            bw.Write(packet.Propeller2);
+            bw.Write(packet.Propeller3);
+            bw.Write(packet.Propeller4);
+            bw.Write(packet.Spoilers);
+            bw.Write(packet.ElevatorTrim);
+            bw.Write(packet.FlapsIndex);
+            bw.Write(packet.GearHandle);
+            bw.Write(packet.SessionId);
+            bw.Write(packet.TimeMs);
+        }
+
+        public Levers Decode(BinaryReader br) => new()
+        {
+            Throttle1 = br.ReadDouble(),
+            Throttle2 = br.ReadDouble(),
+            Throttle3 = br.ReadDouble(),
+            Throttle4 = br.ReadDouble(),
+            Mixture1 = br.ReadDouble(),
+            Mixture2 = br.ReadDouble(),
+            Mixture3 = br.ReadDouble(),
+            Mixture4 = br.ReadDouble(),
+            Propeller1 = br.ReadDouble(),
+            Propeller2 = br.ReadDouble(),
+            Propeller3 = br.ReadDouble(),
+            Propeller4 = br.ReadDouble(),
+            Spoilers = br.ReadDouble(),
+            ElevatorTrim = br.ReadDouble(),
+            FlapsIndex = br.ReadDouble(),
+            GearHandle = br.ReadDouble(),
+            SessionId = br.ReadUInt64(),
+            TimeMs = br.ReadUInt32()
+        };
+    }
+}
+
+/// <summary>
+/// Groups of <see cref="Levers"/> channels an aircraft profile streams, listed under <c>levers:</c>
+/// in its definitions. Aircraft with their own lever logic leave them out and link their variables
+/// instead.
+/// </summary>
+[Flags]
+public enum LeverChannels
+{
+    None = 0,
+    Throttle = 1 << 0,
+    Mixture = 1 << 1,
+    Propeller = 1 << 2,
+    Spoilers = 1 << 3,
+    Trim = 1 << 4,
+    Flaps = 1 << 5,
+    Gear = 1 << 6
+}
@@ -0,0 +1,136 @@
+namespace FsCopilot.Simulation;
+
+using System.Buffers.Binary;
+using Network;
+
+/// <summary>
+/// One quantized <see cref="Physics"/> or <see cref="Surfaces"/> frame. Peers forward the bytes to
+/// the bridge as they are, the bridge decodes them (motion_codec.h).
+/// </summary>
+public sealed record Motion(byte[] Data)
+{
+    public const int MaxSize = 255;
+
+    public class Codec : IPacketCodec<Motion>
+    {
+        public void Encode(Motion packet, BinaryWriter bw)
+        {
+            bw.Write((byte)packet.Data.Length);
+            bw.Write(packet.Data);
+        }
+
+        public Motion Decode(BinaryReader br) => new(br.ReadBytes(br.ReadByte()));
+    }
+}
+
+/// <summary>
+/// Quantizes physics to millimetres, 0.001° and 1/256 ft/s and sends a keyframe every second,
+/// with deltas against that keyframe in between. The format is described in motion_codec.h.
+/// </summary>
+public sealed class MotionEncoder
+{
+    private const byte KindPhysics = 1;
+    private const byte KindSurfaces = 2;
+    private const byte Key = 0x80;
+    private const uint KeyIntervalMs = 1000;
+
+    // in Physics field order, must match k_physics_scale in motion_codec.h
+    private static readonly double[] PhysicsScale =
+        [1e10, 1e10, 304.8, 1000, 1000, 1000, 1000, 256, 1000, 256, 256, 256, 256];
+
+    private readonly KeyState _physics = new(PhysicsScale.Length);
+    private readonly KeyState _surfaces = new(3);
+
+    public Motion Encode(Physics p)
+    {
+        Span<long> q =
+        [
+            Quantize(p.Lat, 0), Quantize(p.Lon, 1), Quantize(p.AltFeet, 2),
+            Quantize(p.Pitch, 3), Quantize(p.Bank, 4), Quantize(p.HdgDegGyro, 5), Quantize(p.HdgDegTrue, 6),
+            Quantize(p.VerticalSpeed, 7), Quantize(p.GForce, 8), Quantize(p.VBodyY, 9), Quantize(p.VBodyZ, 10),
+            Quantize(p.Vx, 11), Quantize(p.Vz, 12)
+        ];
+        lock (_physics) return Encode(_physics, KindPhysics, p.SessionId, p.TimeMs, q);
+    }
+
+    public Motion Encode(Surfaces s)
+    {
+        Span<long> q = [s.AilPos, s.ElevPos, s.RudPos];
+        lock (_surfaces) return Encode(_surfaces, KindSurfaces, s.SessionId, s.TimeMs, q);
+    }
+
+    private static long Quantize(double value, int field) =>
+        double.IsFinite(value) ? (long)Math.Round(value * PhysicsScale[field]) : 0;
+
+    private static Motion Encode(KeyState st, byte kind, ulong sessionId, uint timeMs, ReadOnlySpan<long> q)
+    {
+        Span<byte> buf = stackalloc byte[Motion.MaxSize];
+        var pos = 0;
+
+        var seq = st.Seq++;
+        var key = !st.HasKey || st.SessionId != sessionId || unchecked(timeMs - st.TimeMs) >= KeyIntervalMs;
+
+        buf[pos++] = (byte)(kind | (key ? Key : 0));
+        BinaryPrimitives.WriteUInt16LittleEndian(buf[pos..], seq);
+        pos += 2;
+
+        if (key)
+        {
+            BinaryPrimitives.WriteUInt64LittleEndian(buf[pos..], sessionId);
+            pos += 8;
+            BinaryPrimitives.WriteUInt32LittleEndian(buf[pos..], timeMs);
+            pos += 4;
+            foreach (var v in q) pos += WriteZigZag(buf[pos..], v);
+
+            st.HasKey = true;
+            st.KeySeq = seq;
+            st.SessionId = sessionId;
+            st.TimeMs = timeMs;
+            q.CopyTo(st.Values);
+        }
+        else
+        {
+            BinaryPrimitives.WriteUInt16LittleEndian(buf[pos..], st.KeySeq);
+            pos += 2;
+            pos += WriteVarInt(buf[pos..], unchecked(timeMs - st.TimeMs));
+
+            var maskPos = pos;
+            pos += 2;
+            ushort mask = 0;
+            for (var i = 0; i < q.Length; i++)
+            {
+                var d = q[i] - st.Values[i];
+                if (d == 0) continue;
+                mask |= (ushort)(1 << i);
+                pos += WriteZigZag(buf[pos..], d);
+            }
+            BinaryPrimitives.WriteUInt16LittleEndian(buf[maskPos..], mask);
+        }
+
+        return new(buf[..pos].ToArray());
+    }
+
+    private static int WriteZigZag(Span<byte> dst, long v) => WriteVarInt(dst, (ulong)((v << 1) ^ (v >> 63)));
+
+    private static int WriteVarInt(Span<byte> dst, ulong v)
+    {
+        var n = 0;
+        while (v >= 0x80)
+        {
+            dst[n++] = (byte)(v | 0x80);
+            v >>= 7;
+        }
+        dst[n++] = (byte)v;
+        return n;
+    }
+
+    private sealed class KeyState(int fields)
+    {
+        public readonly long[] Values = new long[fields];
+        public bool HasKey;
+        public ushort Seq;
+        public ushort KeySeq;
+        public ulong SessionId;
+        public uint TimeMs;
+    }
+}
\ No newline at end of file
@@ -25,6 +25,7 @@ public class DevelopViewModel : ReactiveObject, IDisposable
     private readonly SerialDisposable _playing = new();
     
     private string _loaded = string.Empty;
+    private string _stats = string.Empty;
     private bool _isPlaying;
     private bool _isRecording;
     
@@ -34,6 +35,12 @@ public class DevelopViewModel : ReactiveObject, IDisposable
         set => this.RaiseAndSetIfChanged(ref _loaded, value);
     }
 
+    public string Stats
+    {
+        get => _stats;
+        set => this.RaiseAndSetIfChanged(ref _stats, value);
+    }
+
     public bool IsPlaying
     {
         get => _isPlaying;
@@ -68,6 +75,12 @@ public class DevelopViewModel : ReactiveObject, IDisposable
 
         ReloadCommand = ReactiveCommand.Create(() => _reload.OnNext(Unit.Default));
 
+        sim.Stats
+            .Select(FormatStats)
+            .ObserveOn(RxApp.MainThreadScheduler)
+            .Subscribe(text => Stats = text)
+            .DisposeWith(_d);
+
         sim.Register<Physics>();
         sim.Register<Surfaces>();
         Trace? trace = null;
@@ -143,6 +156,25 @@ public class DevelopViewModel : ReactiveObject, IDisposable
         _playing.Dispose();
     }
 
+    private static string FormatStats(BridgeStats stats)
+    {
+        var text = new StringBuilder();
+        for (var i = 0; i < Math.Min(stats.Timers.Length, BridgeStats.TimerNames.Length); i++)
+        {
+            var h = stats.Timers[i];
+            if (h.Count == 0) continue;
+            text.AppendLine(string.Create(CultureInfo.InvariantCulture,
+                $"{BridgeStats.TimerNames[i]}: {h.Count} calls, mean {h.MeanUs:F1} µs, p99 {h.QuantileUs(0.99):F1} µs, max {h.MaxNs / 1000.0:F1} µs"));
+        }
+
+        var counters = Enumerable.Range(0, Math.Min(stats.Counters.Length, BridgeStats.CounterNames.Length))
+            .Where(i => stats.Counters[i] > 0)
+            .Select(i => $"{BridgeStats.CounterNames[i]} {stats.Counters[i]}");
+        text.Append(string.Create(CultureInfo.InvariantCulture, $"offset {stats.OffsetSec * 1000:F0} ms"));
+        foreach (var counter in counters) text.Append($", {counter}");
+        return text.ToString();
+    }
+
     private IDisposable PopulateTreeAndAttach(SimClient sim, string path)
     {
         Nodes.Clear();
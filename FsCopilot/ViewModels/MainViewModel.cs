@@ -171,6 +171,15 @@ public class MainViewModel : ReactiveObject, IDisposable
             })
             .DisposeWith(_d);
         
+        net.Mismatched
+            .ObserveOn(RxApp.MainThreadScheduler)
+            .Subscribe(_ =>
+            {
+                Errors |= ViewErrors.Rejected;
+                _ = Task.Delay(TimeSpan.FromSeconds(5)).ContinueWith(_ => Errors &= ~ViewErrors.Rejected);
+            })
+            .DisposeWith(_d);
+        
         masterSwitch.Master
             .Sample(TimeSpan.FromMilliseconds(250))
             .Select(isMaster => !isMaster)